@@ -0,0 +1,592 @@
+// bench/mapgen_bench.cpp
+// 生成流水线基准：各阶段单独计时（各噪声类型、域扭曲、水力/热侵蚀、平滑、地形分类、河流、湖泊、统计），
+// 各预设整图生成的分阶段耗时（取自MapData::profile）以及各导出函数，结果以JSON输出，便于版本间对比
+//
+// 用法：mapgen_bench [--sizes 128,512,2048,8192] [--threads 1,2,4] [--presets all|CONTINENT,ALPINE]
+//                    [--sections stages,pipeline,exporters] [--reps 3] [--export-max 2048] [--out file]
+#include "MapGeneratorInternal.h"
+#include "NoiseGenerator.h"
+#include "NoiseKernels.h"
+#include "ParallelUtils.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MG_VERSION
+    #define MG_VERSION "unknown"
+#endif
+
+using namespace MapGenerator;
+using namespace MapGenerator::internal;
+
+namespace {
+
+// 与生成引擎一致的河流源点密度
+constexpr float kRiverDensity = 0.0005f;
+
+struct Options {
+    std::vector<uint32_t> sizes = {128, 512, 2048, 8192};
+    std::vector<uint32_t> threads;
+    std::vector<MapConfig::Preset> presets;
+    bool runStages = true;
+    bool runPipeline = true;
+    bool runExporters = true;
+    int reps = 3;
+    uint32_t exportMax = 2048;
+    std::string outPath;
+};
+
+struct PresetInfo {
+    MapConfig::Preset preset;
+    const char* name;
+};
+
+const PresetInfo kPresets[] = {
+    {MapConfig::Preset::CUSTOM, "CUSTOM"},
+    {MapConfig::Preset::ISLANDS, "ISLANDS"},
+    {MapConfig::Preset::MOUNTAINS, "MOUNTAINS"},
+    {MapConfig::Preset::PLAINS, "PLAINS"},
+    {MapConfig::Preset::CONTINENT, "CONTINENT"},
+    {MapConfig::Preset::ARCHIPELAGO, "ARCHIPELAGO"},
+    {MapConfig::Preset::SWAMP_LAKES, "SWAMP_LAKES"},
+    {MapConfig::Preset::DESERT_CANYONS, "DESERT_CANYONS"},
+    {MapConfig::Preset::ALPINE, "ALPINE"},
+};
+
+const char* presetName(MapConfig::Preset preset) {
+    for (const auto& info : kPresets) {
+        if (info.preset == preset) return info.name;
+    }
+    return "UNKNOWN";
+}
+
+const char* kStageNames[] = {
+    "noise", "erosion", "smoothing", "terrain", "rivers", "lakes", "encode", "statistics"
+};
+static_assert(sizeof(kStageNames) / sizeof(kStageNames[0]) ==
+              static_cast<size_t>(GenerationStage::COUNT), "stage names out of sync");
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<uint32_t> parseUintList(const std::string& text) {
+    std::vector<uint32_t> values;
+    for (const auto& item : splitList(text)) {
+        long value = std::atol(item.c_str());
+        if (value > 0) values.push_back(static_cast<uint32_t>(value));
+    }
+    return values;
+}
+
+// 默认线程数：1、2、4…直到硬件线程数，并包含硬件线程数本身
+std::vector<uint32_t> defaultThreadCounts() {
+    uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<uint32_t> counts;
+    for (uint32_t t = 1; t < hardware; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(hardware);
+    return counts;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : std::string(); };
+
+        if (arg == "--sizes") {
+            options.sizes = parseUintList(next());
+        } else if (arg == "--threads") {
+            options.threads = parseUintList(next());
+        } else if (arg == "--presets") {
+            std::string list = next();
+            if (list != "all") {
+                for (const auto& name : splitList(list)) {
+                    auto it = std::find_if(std::begin(kPresets), std::end(kPresets),
+                        [&](const PresetInfo& info) { return name == info.name; });
+                    if (it == std::end(kPresets)) {
+                        std::cerr << "unknown preset: " << name << "\n";
+                        return false;
+                    }
+                    options.presets.push_back(it->preset);
+                }
+            }
+        } else if (arg == "--sections") {
+            auto sections = splitList(next());
+            auto has = [&](const char* name) {
+                return std::find(sections.begin(), sections.end(), name) != sections.end();
+            };
+            options.runStages = has("stages");
+            options.runPipeline = has("pipeline");
+            options.runExporters = has("exporters");
+        } else if (arg == "--reps") {
+            options.reps = std::max(1, std::atoi(next().c_str()));
+        } else if (arg == "--export-max") {
+            options.exportMax = static_cast<uint32_t>(std::atol(next().c_str()));
+        } else if (arg == "--out") {
+            options.outPath = next();
+        } else {
+            std::cerr << "unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (options.threads.empty()) {
+        options.threads = defaultThreadCounts();
+    }
+    if (options.presets.empty()) {
+        for (const auto& info : kPresets) options.presets.push_back(info.preset);
+    }
+    return !options.sizes.empty();
+}
+
+// 最小的流式JSON写出：自动处理逗号，键和字符串不含需转义的字符
+class JsonWriter {
+public:
+    explicit JsonWriter(std::ostream& out) : m_out(out) {}
+
+    void beginObject() { separator(); m_out << "{"; m_first.push_back(true); }
+    void endObject() { m_first.pop_back(); m_out << "}"; }
+    void beginArray() { separator(); m_out << "["; m_first.push_back(true); }
+    void endArray() { m_first.pop_back(); m_out << "]"; }
+
+    void key(const char* name) {
+        separator();
+        m_out << "\"" << name << "\":";
+        m_afterKey = true;
+    }
+
+    void value(const std::string& text) { separator(); m_out << "\"" << text << "\""; }
+    void value(const char* text) { value(std::string(text)); }
+    void value(bool flag) { separator(); m_out << (flag ? "true" : "false"); }
+    void value(double number) {
+        separator();
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.4f", number);
+        m_out << buffer;
+    }
+    template<typename T>
+    void value(T number) { separator(); m_out << number; }
+
+    template<typename T>
+    void field(const char* name, T v) { key(name); value(v); }
+
+private:
+    void separator() {
+        if (m_afterKey) {
+            m_afterKey = false;
+            return;
+        }
+        if (!m_first.empty()) {
+            if (!m_first.back()) m_out << ",";
+            m_first.back() = false;
+        }
+    }
+
+    std::ostream& m_out;
+    std::vector<bool> m_first;
+    bool m_afterKey = false;
+};
+
+struct Timing {
+    double minMs = 0.0;
+    double medianMs = 0.0;
+    double meanMs = 0.0;
+};
+
+Timing summarize(std::vector<double> samples) {
+    Timing timing;
+    if (samples.empty()) return timing;
+    std::sort(samples.begin(), samples.end());
+    timing.minMs = samples.front();
+    timing.medianMs = samples[samples.size() / 2];
+    double total = 0.0;
+    for (double sample : samples) total += sample;
+    timing.meanMs = total / samples.size();
+    return timing;
+}
+
+// setup在每次计时前运行（如复制输入），不计入耗时
+Timing measure(int reps, const std::function<void()>& setup, const std::function<void()>& body) {
+    std::vector<double> samples;
+    for (int i = 0; i < reps; ++i) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return summarize(std::move(samples));
+}
+
+void writeTiming(JsonWriter& json, const Timing& timing, uint32_t size) {
+    json.field("min_ms", timing.minMs);
+    json.field("median_ms", timing.medianMs);
+    json.field("mean_ms", timing.meanMs);
+    double pixels = static_cast<double>(size) * size;
+    json.field("mpix_per_s", timing.medianMs > 0.0 ? pixels / (timing.medianMs * 1000.0) : 0.0);
+}
+
+MapConfig benchConfig(MapConfig::Preset preset, uint32_t size, uint32_t threads) {
+    MapConfig config = ::MapGenerator::MapGenerator::createConfigFromPreset(preset);
+    config.width = size;
+    config.height = size;
+    config.seed = 12345;
+    config.threadCount = threads;
+    return config;
+}
+
+// ---- 各阶段单独计时 ----
+
+void runStages(JsonWriter& json, const Options& options) {
+    json.key("stages");
+    json.beginArray();
+
+    for (uint32_t size : options.sizes) {
+        // 输入数据与线程数无关，每个尺寸只生成一次
+        MapConfig baseConfig = benchConfig(MapConfig::Preset::CONTINENT, size, options.threads.back());
+        MapGeneratorInternal inputEngine(baseConfig.seed);
+        HeightMap heights = inputEngine.generateHeightmapOnly(baseConfig);
+        TileMap terrain = inputEngine.generateTerrainOnly(heights, baseConfig);
+
+        for (uint32_t threads : options.threads) {
+            MapConfig config = baseConfig;
+            config.threadCount = threads;
+            auto processor = std::make_shared<ParallelProcessor>(threads);
+            NoiseGenerator noiseGen(config.seed, processor);
+            MapGeneratorInternal engine(config.seed);
+
+            auto emit = [&](const char* stage, const Timing& timing) {
+                json.beginObject();
+                json.field("stage", stage);
+                json.field("size", size);
+                json.field("threads", threads);
+                writeTiming(json, timing, size);
+                json.endObject();
+                std::cerr << "  stage " << stage << " " << size << "^2 x" << threads << ": "
+                          << timing.medianMs << " ms\n";
+            };
+            auto nothing = []() {};
+
+            // 各噪声类型的fBm
+            const std::pair<NoiseType, const char*> noiseTypes[] = {
+                {NoiseType::PERLIN, "fbm_perlin"},
+                {NoiseType::PERLIN_2D, "fbm_perlin_2d"},
+                {NoiseType::SIMPLEX, "fbm_simplex"},
+                {NoiseType::VALUE, "fbm_value"},
+                {NoiseType::WORLEY, "fbm_worley"},
+            };
+            for (const auto& [type, name] : noiseTypes) {
+                NoiseParams params;
+                params.scale = config.noiseScale;
+                params.octaves = config.noiseOctaves;
+                params.persistence = config.noisePersistence;
+                params.lacunarity = config.noiseLacunarity;
+                params.type = type;
+                HeightMap out;
+                emit(name, measure(options.reps, nothing, [&]() {
+                    out = noiseGen.generateNoise(size, size, params);
+                }));
+            }
+
+            HeightMap work;
+            auto copyHeights = [&]() { work = heights; };
+
+            NoiseParams::DomainWarp warp;
+            warp.enabled = true;
+            emit("domain_warp", measure(options.reps, copyHeights, [&]() {
+                noiseGen.applyDomainWarp(work, size, size, warp);
+            }));
+
+            ErosionParams hydraulic;
+            hydraulic.iterations = 5;
+            hydraulic.pipeIterations = 24;
+            hydraulic.hydraulicErosion = true;
+            hydraulic.thermalErosion = false;
+            emit("erosion_hydraulic", measure(options.reps, copyHeights, [&]() {
+                engine.applyErosion(work, config, hydraulic);
+            }));
+
+            ErosionParams thermal = hydraulic;
+            thermal.hydraulicErosion = false;
+            thermal.thermalErosion = true;
+            thermal.talusAngle = 35.0f;
+            emit("erosion_thermal", measure(options.reps, copyHeights, [&]() {
+                engine.applyErosion(work, config, thermal);
+            }));
+
+            ErosionParams droplet = hydraulic;
+            droplet.hydraulicModel = ErosionModel::DROPLET;
+            emit("erosion_droplet", measure(options.reps, copyHeights, [&]() {
+                engine.applyErosion(work, config, droplet);
+            }));
+
+            emit("smoothing", measure(options.reps, copyHeights, [&]() {
+                noiseGen.applySmoothing(work, size, size, 1);
+            }));
+            emit("smoothing_r16", measure(options.reps, copyHeights, [&]() {
+                noiseGen.applySmoothing(work, size, size, 16);
+            }));
+            emit("smoothing_gaussian", measure(options.reps, copyHeights, [&]() {
+                noiseGen.applyGaussianSmoothing(work, size, size, 8.0f);
+            }));
+
+            TileMap tiles;
+            emit("terrain_classification", measure(options.reps, nothing, [&]() {
+                tiles = engine.generateTerrainOnly(heights, config);
+            }));
+
+            RiverParams riverParams;
+            riverParams.count = static_cast<uint32_t>(size * size * kRiverDensity);
+            riverParams.generateLakes = false;
+            auto copyTerrain = [&]() { tiles = terrain; };
+            emit("rivers", measure(options.reps, copyTerrain, [&]() {
+                engine.generateRivers(tiles, heights, config, riverParams);
+            }));
+
+            riverParams.generateLakes = true;
+            emit("rivers_and_lakes", measure(options.reps, copyTerrain, [&]() {
+                engine.generateRivers(tiles, heights, config, riverParams);
+            }));
+
+            MapConfig flowConfig = config;
+            flowConfig.hydrology = HydrologyModel::FLOW;
+            emit("flow_hydrology", measure(options.reps, copyTerrain, [&]() {
+                engine.generateRivers(tiles, heights, flowConfig, riverParams);
+            }));
+
+            // 湖泊与统计单独计时：湖泊的输入为已合并河流的地形，统计的输入为再加入湖泊后的地形，
+            // 与整图生成中这两个阶段的输入相同
+            TileMap riverTerrain = terrain;
+            riverParams.generateLakes = false;
+            engine.generateRivers(riverTerrain, heights, config, riverParams);
+            riverParams.generateLakes = true;
+            emit("lakes", measure(options.reps, [&]() { tiles = riverTerrain; }, [&]() {
+                engine.generateLakes(tiles, heights, config, riverParams);
+            }));
+
+            MapData statsInput;
+            statsInput.config = config;
+            statsInput.config.compactTiles = false;
+            statsInput.config.heightFormat = HeightFormat::FLOAT32;
+            statsInput.heightMap = heights;
+            statsInput.terrainMap = tiles;
+            emit("statistics", measure(options.reps, nothing, [&]() {
+                engine.calculateStatistics(statsInput);
+            }));
+        }
+    }
+
+    json.endArray();
+}
+
+// ---- 各预设整图生成，分阶段耗时取自MapData::profile ----
+
+void runPipeline(JsonWriter& json, const Options& options) {
+    json.key("pipeline");
+    json.beginArray();
+
+    for (MapConfig::Preset preset : options.presets) {
+        for (uint32_t size : options.sizes) {
+            for (uint32_t threads : options.threads) {
+                MapConfig config = benchConfig(preset, size, threads);
+                ::MapGenerator::MapGenerator generator;
+
+                std::vector<double> totals;
+                std::vector<std::vector<double>> stageWall(static_cast<size_t>(GenerationStage::COUNT));
+                std::vector<std::vector<double>> stageCpu(stageWall.size());
+                std::shared_ptr<MapData> last;
+                for (int rep = 0; rep < options.reps; ++rep) {
+                    // 清空结果和阶段缓存，每次都完整运行
+                    generator.clearCache();
+                    auto start = std::chrono::steady_clock::now();
+                    last = generator.generateMap(config);
+                    auto end = std::chrono::steady_clock::now();
+                    totals.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                    for (size_t s = 0; s < stageWall.size(); ++s) {
+                        stageWall[s].push_back(last->profile.stages[s].wallMs);
+                        stageCpu[s].push_back(last->profile.stages[s].cpuMs);
+                    }
+                }
+
+                Timing total = summarize(totals);
+                json.beginObject();
+                json.field("preset", presetName(preset));
+                json.field("size", size);
+                json.field("threads", threads);
+                writeTiming(json, total, size);
+
+                json.key("stages");
+                json.beginObject();
+                for (size_t s = 0; s < stageWall.size(); ++s) {
+                    const MapStageProfile& stage = last->profile.stages[s];
+                    json.key(kStageNames[s]);
+                    json.beginObject();
+                    json.field("median_wall_ms", summarize(stageWall[s]).medianMs);
+                    json.field("median_cpu_ms", summarize(stageCpu[s]).medianMs);
+                    json.field("threads", stage.threads);
+                    json.field("bytes", stage.bytesAllocated);
+                    json.endObject();
+                }
+                json.endObject();
+
+                const MapProfile& profile = last->profile;
+                json.key("counters");
+                json.beginObject();
+                json.field("river_sources", profile.riverSources);
+                json.field("rivers_traced", profile.riversTraced);
+                json.field("lake_candidates", profile.lakeCandidates);
+                json.field("lakes_placed", profile.lakesPlaced);
+                json.field("erosion_cell_updates", profile.erosionCellUpdates);
+                json.field("droplets_simulated", profile.dropletsSimulated);
+                json.field("droplets_per_second", profile.dropletsPerSecond());
+                json.endObject();
+
+                // 临时缓冲区池的累计统计；每次计时前clearCache会清空池，分配次数包含各次重新分配
+                MapScratchStats scratch = generator.getScratchStats();
+                json.key("scratch");
+                json.beginObject();
+                json.field("allocations", scratch.allocations);
+                json.field("reuses", scratch.reuses);
+                json.field("peak_bytes_in_use", scratch.peakBytesInUse);
+                json.endObject();
+                json.endObject();
+
+                std::cerr << "  pipeline " << presetName(preset) << " " << size << "^2 x"
+                          << threads << ": " << total.medianMs << " ms\n";
+            }
+        }
+    }
+
+    json.endArray();
+}
+
+// ---- 已实现的导出函数，写到临时目录后删除 ----
+
+void runExporters(JsonWriter& json, const Options& options) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "mapgen_bench_export";
+    fs::create_directories(dir);
+
+    json.key("exporters");
+    json.beginArray();
+
+    for (uint32_t size : options.sizes) {
+        if (size > options.exportMax) continue;
+
+        MapConfig config = benchConfig(MapConfig::Preset::CONTINENT, size, options.threads.back());
+        ::MapGenerator::MapGenerator generator;
+        std::shared_ptr<MapData> map = generator.generateMap(config);
+
+        auto run = [&](const char* name, const char* file,
+                       const std::function<bool(const std::string&)>& exporter) {
+            std::string path = (dir / file).string();
+            bool ok = true;
+            Timing timing = measure(options.reps, []() {}, [&]() { ok = exporter(path) && ok; });
+            std::error_code sizeError;
+            std::error_code removeError;
+            uintmax_t bytes = fs::file_size(path, sizeError);
+            fs::remove(path, removeError);
+
+            json.beginObject();
+            json.field("exporter", name);
+            json.field("size", size);
+            json.field("ok", ok);
+            json.field("file_bytes", static_cast<uint64_t>(sizeError ? 0 : bytes));
+            writeTiming(json, timing, size);
+            json.endObject();
+            std::cerr << "  export " << name << " " << size << "^2: " << timing.medianMs << " ms\n";
+        };
+
+        // exportToImage和exportToJSON尚未实现（直接返回true），不计时
+        run("ppm_color", "color.ppm", [&](const std::string& p) {
+            return generator.exportToPPM(*map, p, true, 0);
+        });
+        run("pgm", "map.pgm", [&](const std::string& p) { return generator.exportToPGM(*map, p); });
+        run("heightmap_pgm", "height.pgm", [&](const std::string& p) {
+            return generator.exportHeightmapToPGM(*map, p);
+        });
+        run("terrain_index_pgm", "terrain.pgm", [&](const std::string& p) {
+            return generator.exportTerrainIndexToPGM(*map, p);
+        });
+        run("heightmap_ppm", "height.ppm", [&](const std::string& p) {
+            return generator.exportHeightmapToPPM(*map, p);
+        });
+    }
+
+    json.endArray();
+
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+}
+
+std::string utcTimestamp() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return buffer;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: mapgen_bench [--sizes 128,512,2048,8192] [--threads 1,2,4]"
+                     " [--presets all|NAME,...] [--sections stages,pipeline,exporters]"
+                     " [--reps N] [--export-max SIZE] [--out FILE]\n";
+        return 2;
+    }
+
+    std::ofstream file;
+    if (!options.outPath.empty()) {
+        file.open(options.outPath);
+        if (!file) {
+            std::cerr << "cannot open " << options.outPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = options.outPath.empty() ? std::cout : file;
+
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("schema", 1);
+    json.field("version", MG_VERSION);
+    json.field("timestamp", utcTimestamp());
+    json.field("hardware_threads", std::thread::hardware_concurrency());
+    json.field("simd", simdLevelName(detectSimdLevel()));
+    json.field("profiling", MG_ENABLE_PROFILING != 0);
+    json.field("reps", options.reps);
+
+    if (options.runStages) runStages(json, options);
+    if (options.runPipeline) runPipeline(json, options);
+    if (options.runExporters) runExporters(json, options);
+
+    json.endObject();
+    out << "\n";
+    return 0;
+}
@@ -0,0 +1,100 @@
+// bench/noise_batch_bench.cpp
+// 批量柏林噪声内核（三维与二维）：各指令集级别与标量实现的一致性检查及吞吐量对比
+#include "NoiseKernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace MapGenerator::internal;
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : (1u << 20);
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    // 与PerlinNoiseImp相同方式构造的排列表
+    std::vector<int> perm(512);
+    std::iota(perm.begin(), perm.begin() + 256, 0);
+    std::mt19937 rng(12345);
+    for (int i = 255; i > 0; i--) {
+        std::swap(perm[i], perm[rng() % (i + 1)]);
+    }
+    std::copy(perm.begin(), perm.begin() + 256, perm.begin() + 256);
+
+    // 覆盖负坐标、整数边界和大坐标
+    std::vector<float> xs(count);
+    std::vector<float> ys(count);
+    std::uniform_real_distribution<float> coord(-300.0f, 3000.0f);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = (i % 97 == 0) ? std::floor(coord(rng)) : coord(rng);
+        ys[i] = coord(rng);
+    }
+
+    std::vector<float> reference(count);
+    for (size_t i = 0; i < count; ++i) {
+        reference[i] = perlinNoiseScalar(perm.data(), xs[i], ys[i], 1.5f);
+    }
+
+    SimdLevel supported = detectSimdLevel();
+    std::cout << "Perlin batch kernel: " << count << " samples, detected "
+              << simdLevelName(supported) << "\n";
+
+    // 二维路径：与三维噪声在整数层上的取值比较（按数值，±0视为相等）
+    std::vector<float> reference2D(count);
+    size_t valueMismatches = 0;
+    for (size_t i = 0; i < count; ++i) {
+        reference2D[i] = perlinNoise2DScalar(perm.data(), xs[i], ys[i], 3);
+        if (reference2D[i] != perlinNoiseScalar(perm.data(), xs[i], ys[i], 3.0f)) {
+            ++valueMismatches;
+        }
+    }
+    std::cout << "  2D vs 3D at integer layer: " << valueMismatches << " value mismatches\n";
+
+    bool allMatch = valueMismatches == 0;
+    std::vector<float> out(count);
+
+    auto run = [&](const char* label, const std::vector<float>& expected, auto&& kernel) {
+        for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE41, SimdLevel::AVX2}) {
+            if (static_cast<int>(level) > static_cast<int>(supported)) {
+                std::cout << "  " << label << " " << std::left << std::setw(8)
+                          << simdLevelName(level) << "unsupported\n";
+                continue;
+            }
+
+            kernel(level);
+            size_t mismatches = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (std::memcmp(&out[i], &expected[i], sizeof(float)) != 0) {
+                    ++mismatches;
+                }
+            }
+            allMatch = allMatch && mismatches == 0;
+
+            auto start = std::chrono::steady_clock::now();
+            for (int it = 0; it < iterations; ++it) {
+                kernel(level);
+            }
+            auto end = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+
+            std::cout << "  " << label << " " << std::left << std::setw(8) << simdLevelName(level)
+                      << std::right << std::fixed << std::setprecision(1) << std::setw(8)
+                      << count * static_cast<double>(iterations) / seconds / 1e6 << " Msamples/s   "
+                      << mismatches << " bit mismatches\n";
+        }
+    };
+
+    run("3D", reference, [&](SimdLevel level) {
+        perlinNoiseBatch(level, perm.data(), xs.data(), ys.data(), 1.5f, out.data(), count);
+    });
+    run("2D", reference2D, [&](SimdLevel level) {
+        perlinNoise2DBatch(level, perm.data(), xs.data(), ys.data(), 3, out.data(), count);
+    });
+
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+// bench/parallel_dispatch_bench.cpp
+// 并行循环调度开销对比：std::function 逐像素调用 vs 模板化行区间/分块调用
+#include "ParallelUtils.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+
+using namespace MapGenerator;
+using namespace MapGenerator::internal;
+
+namespace {
+
+// 与岛屿衰减相同的轻量逐像素运算，调度开销占比较高
+inline float falloff(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    float dx = (x / static_cast<float>(width)) - 0.5f;
+    float dy = (y / static_cast<float>(height)) - 0.5f;
+    return std::max(0.0f, 1.0f - std::sqrt(dx * dx + dy * dy) * 2.0f);
+}
+
+template<typename F>
+double measureNsPerPixel(uint32_t width, uint32_t height, int iterations, F&& run) {
+    run(); // 预热
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        run();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return ns / (static_cast<double>(width) * height * iterations);
+}
+
+void report(const std::string& name, double nsPerPixel, double baseline) {
+    std::cout << "  " << std::left << std::setw(28) << name
+              << std::right << std::fixed << std::setprecision(3) << std::setw(8) << nsPerPixel
+              << " ns/pixel   x" << std::setprecision(2) << baseline / nsPerPixel << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t size = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 1024;
+    uint32_t threads = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2]))
+                                : std::max(1u, std::thread::hardware_concurrency());
+    int iterations = argc > 3 ? std::atoi(argv[3]) : 20;
+
+    uint32_t width = size;
+    uint32_t height = size;
+    ParallelProcessor processor(threads);
+    HeightMap input(static_cast<size_t>(width) * height, 0.5f);
+    HeightMap output(input.size());
+
+    std::cout << "Parallel dispatch benchmark: " << width << "x" << height
+              << ", " << threads << " threads, " << iterations << " iterations\n";
+
+    double perPixel = measureNsPerPixel(width, height, iterations, [&]() {
+        processor.parallelFor2D(width, height, [&](uint32_t x, uint32_t y) {
+            output[y * width + x] = input[y * width + x] * falloff(x, y, width, height);
+        });
+    });
+
+    double heightMapWrapper = measureNsPerPixel(width, height, iterations, [&]() {
+        processor.processHeightMapParallel(input, width, height, [&](uint32_t x, uint32_t y, float h) {
+            output[y * width + x] = h * falloff(x, y, width, height);
+        });
+    });
+
+    double rowSpans = measureNsPerPixel(width, height, iterations, [&]() {
+        processor.parallelForRowSpans(width, height, [&](uint32_t y, uint32_t startX, uint32_t endX) {
+            const float* src = input.data() + static_cast<size_t>(y) * width;
+            float* dst = output.data() + static_cast<size_t>(y) * width;
+            for (uint32_t x = startX; x < endX; ++x) {
+                dst[x] = src[x] * falloff(x, y, width, height);
+            }
+        });
+    });
+
+    double tiles = measureNsPerPixel(width, height, iterations, [&]() {
+        processor.parallelForTiles(width, height, 64,
+            [&](uint32_t startX, uint32_t startY, uint32_t endX, uint32_t endY) {
+            for (uint32_t y = startY; y < endY; ++y) {
+                const float* src = input.data() + static_cast<size_t>(y) * width;
+                float* dst = output.data() + static_cast<size_t>(y) * width;
+                for (uint32_t x = startX; x < endX; ++x) {
+                    dst[x] = src[x] * falloff(x, y, width, height);
+                }
+            }
+        });
+    });
+
+    report("parallelFor2D (function)", perPixel, perPixel);
+    report("processHeightMapParallel", heightMapWrapper, perPixel);
+    report("parallelForRowSpans", rowSpans, perPixel);
+    report("parallelForTiles (64)", tiles, perPixel);
+
+    return 0;
+}
@@ -268,13 +268,14 @@ void testAdvancedExport() {
     {
         // 创建装饰索引图
         std::vector<uint8_t> decorationData(map->config.width * map->config.height);
+        MapGenerator::TileLayerView decoration = map->decoration();
         uint32_t maxType = 0;
-        for (uint32_t value : map->decorationMap) {
-            maxType = std::max(maxType, value);
+        for (size_t i = 0; i < decoration.size(); ++i) {
+            maxType = std::max(maxType, decoration[i]);
         }
         
-        for (size_t i = 0; i < map->decorationMap.size(); ++i) {
-            uint32_t type = map->decorationMap[i];
+        for (size_t i = 0; i < decoration.size(); ++i) {
+            uint32_t type = decoration[i];
             decorationData[i] = static_cast<uint8_t>((type * 255) / (maxType ? maxType : 1));
         }
         
@@ -414,15 +415,23 @@ void exportRawData() {
     auto map = generator.generateMap(config);
     
     // 导出原始高度数据
+    MapGenerator::HeightLayerView heights = map->heights();
+    std::vector<float> heightData(heights.size());
+    heights.decode(0, heightData.size(), heightData.data());
     std::ofstream heightFile("raw_height_data.bin", std::ios::binary);
-    heightFile.write(reinterpret_cast<const char*>(map->heightMap.data()), 
-                     map->heightMap.size() * sizeof(float));
+    heightFile.write(reinterpret_cast<const char*>(heightData.data()), 
+                     heightData.size() * sizeof(float));
     heightFile.close();
     
-    // 导出地形类型数据
+    // 导出地形类型数据（统一按32位写出，与图层存储方式无关）
+    MapGenerator::TileLayerView terrain = map->terrain();
+    std::vector<uint32_t> terrainData(terrain.size());
+    for (size_t i = 0; i < terrain.size(); ++i) {
+        terrainData[i] = terrain[i];
+    }
     std::ofstream terrainFile("raw_terrain_data.bin", std::ios::binary);
-    terrainFile.write(reinterpret_cast<const char*>(map->terrainMap.data()), 
-                      map->terrainMap.size() * sizeof(uint32_t));
+    terrainFile.write(reinterpret_cast<const char*>(terrainData.data()), 
+                      terrainData.size() * sizeof(uint32_t));
     terrainFile.close();
     
     // 导出元数据
@@ -437,6 +446,27 @@ void exportRawData() {
     metaFile << "Average Height: " << map->stats.averageHeight << "\n";
     metaFile << "Min Height: " << map->stats.minHeight << "\n";
     metaFile << "Max Height: " << map->stats.maxHeight << "\n";
+    
+    // 分阶段耗时和计数
+    const MapGenerator::MapProfile& profile = map->profile;
+    if (profile.enabled) {
+        static const char* stageNames[] = {
+            "Noise", "Erosion", "Smoothing", "Terrain", "Rivers", "Lakes", "Encode", "Statistics"
+        };
+        metaFile << "\nStage Profile (wall ms / cpu ms / threads / bytes)\n";
+        for (size_t i = 0; i < static_cast<size_t>(MapGenerator::GenerationStage::COUNT); ++i) {
+            const auto& stage = profile.stages[i];
+            metaFile << "  " << stageNames[i] << ": " << stage.wallMs << " / " << stage.cpuMs
+                     << " / " << stage.threads << " / " << stage.bytesAllocated
+                     << (stage.cached ? " (cached)" : "") << "\n";
+        }
+        metaFile << "River Sources: " << profile.riverSources << "\n";
+        metaFile << "Rivers Traced: " << profile.riversTraced << "\n";
+        metaFile << "Lake Candidates: " << profile.lakeCandidates << "\n";
+        metaFile << "Lakes Placed: " << profile.lakesPlaced << "\n";
+        metaFile << "Erosion Cell Updates: " << profile.erosionCellUpdates << "\n";
+        metaFile << "Droplets Simulated: " << profile.dropletsSimulated << "\n";
+    }
     metaFile.close();
     
     std::cout << "Exported raw data files:\n";
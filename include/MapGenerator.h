@@ -12,6 +12,8 @@
 #endif
 
 #include <cstdint>
+#include <cstring>
+#include <functional>
 #include <vector>
 #include <string>
 #include <memory>
@@ -66,6 +68,151 @@ enum class ClimateType : uint32_t {
 // 基础类型定义
 using HeightMap = std::vector<float>;
 using TileMap = std::vector<uint32_t>;
+// 紧凑图块层：地形、装饰和资源的取值都小于256，每格1字节
+using CompactTileMap = std::vector<uint8_t>;
+
+// 图块层只读视图：统一访问32位（TileMap）或8位（CompactTileMap）存储
+class TileLayerView {
+public:
+    TileLayerView() = default;
+    TileLayerView(const TileMap& tiles) : m_wide(tiles.data()), m_size(tiles.size()) {}
+    TileLayerView(const CompactTileMap& tiles) : m_compact(tiles.data()), m_size(tiles.size()) {}
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool isCompact() const { return m_compact != nullptr; }
+
+    uint32_t operator[](size_t idx) const {
+        return m_compact ? m_compact[idx] : m_wide[idx];
+    }
+    TerrainType terrain(size_t idx) const {
+        return static_cast<TerrainType>((*this)[idx]);
+    }
+
+private:
+    const uint32_t* m_wide = nullptr;
+    const uint8_t* m_compact = nullptr;
+    size_t m_size = 0;
+};
+
+// 高度图存储格式：生成过程始终使用float，完成后按此格式保存
+enum class HeightFormat : uint8_t {
+    FLOAT32 = 0,    // MapData::heightMap
+    UNORM16 = 1,    // MapData::heightSamples，[0,1]量化到0..65535
+    HALF16  = 2     // MapData::heightSamples，IEEE 754半精度
+};
+
+// 解码单个16位高度样本
+inline float decodeHeightSample(HeightFormat format, uint16_t sample) {
+    if (format == HeightFormat::UNORM16) {
+        return static_cast<float>(sample) * (1.0f / 65535.0f);
+    }
+    
+    uint32_t sign = static_cast<uint32_t>(sample & 0x8000u) << 16;
+    uint32_t exponent = (sample >> 10) & 0x1Fu;
+    uint32_t mantissa = sample & 0x3FFu;
+    uint32_t bits;
+    if (exponent == 0) {
+        // 零和非规格化数：mantissa * 2^-24 在float中精确表示
+        float value = static_cast<float>(mantissa) * 5.9604644775390625e-8f;
+        return sign ? -value : value;
+    } else if (exponent == 0x1F) {
+        // 无穷大保持不变，NaN转为安静NaN，与F16C指令结果一致
+        bits = sign | 0x7F800000u | (mantissa << 13) | (mantissa ? 0x400000u : 0u);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 批量解码16位高度样本（SIMD），out需容纳count个float
+MG_EXPORT void decodeHeightSamples(HeightFormat format, const uint16_t* samples,
+                                   float* out, size_t count);
+
+// 高度图只读视图：统一访问float或16位存储
+class HeightLayerView {
+public:
+    HeightLayerView() = default;
+    HeightLayerView(const HeightMap& heights)
+        : m_float(heights.data()), m_size(heights.size()) {}
+    HeightLayerView(const std::vector<uint16_t>& samples, HeightFormat format)
+        : m_samples(samples.data()), m_size(samples.size()), m_format(format) {}
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    HeightFormat format() const { return m_format; }
+
+    float operator[](size_t idx) const {
+        return m_samples ? decodeHeightSample(m_format, m_samples[idx]) : m_float[idx];
+    }
+    
+    // 解码[start, start + count)到out，逐行读取时比逐点访问快
+    void decode(size_t start, size_t count, float* out) const {
+        if (m_samples) {
+            decodeHeightSamples(m_format, m_samples + start, out, count);
+        } else if (count > 0) {
+            std::memcpy(out, m_float + start, count * sizeof(float));
+        }
+    }
+
+private:
+    const float* m_float = nullptr;
+    const uint16_t* m_samples = nullptr;
+    size_t m_size = 0;
+    HeightFormat m_format = HeightFormat::FLOAT32;
+};
+
+// 低分辨率气候场（温度或湿度）：采样点位于每cellSize格一个的网格上，覆盖整张地图，
+// 任意格子的值由相邻四个采样点双线性插值得到。采样值为海平面处的值，at()再按高度修正并限制到[0,1]。
+// 网格按世界坐标对齐，地图格子(x, y)位于网格坐标(x + offsetX, y + offsetY)处，分块生成的各块因此一致
+struct ClimateField {
+    uint32_t width = 0;         // 每行采样点数
+    uint32_t height = 0;        // 采样点行数
+    uint32_t cellSize = 1;      // 相邻采样点间隔的格子数
+    uint32_t offsetX = 0;
+    uint32_t offsetY = 0;
+    float heightLapse = 0.0f;   // 每单位高度的减少量
+    std::vector<float> values;  // 按行存储的采样值
+    
+    bool empty() const { return values.empty(); }
+    
+    // 海平面处的值：先沿y后沿x插值
+    float sample(uint32_t x, uint32_t y) const {
+        const uint32_t gx = x + offsetX;
+        const uint32_t gy = y + offsetY;
+        const uint32_t ix = gx / cellSize;
+        const uint32_t iy = gy / cellSize;
+        const uint32_t ix1 = ix + 1 < width ? ix + 1 : ix;
+        const uint32_t iy1 = iy + 1 < height ? iy + 1 : iy;
+        const float fx = static_cast<float>(gx - ix * cellSize) / static_cast<float>(cellSize);
+        const float fy = static_cast<float>(gy - iy * cellSize) / static_cast<float>(cellSize);
+        const float* row0 = values.data() + static_cast<size_t>(iy) * width;
+        const float* row1 = values.data() + static_cast<size_t>(iy1) * width;
+        const float left = row0[ix] + (row1[ix] - row0[ix]) * fy;
+        const float right = row0[ix1] + (row1[ix1] - row0[ix1]) * fy;
+        return left + (right - left) * fx;
+    }
+    
+    // 高度为terrainHeight的格子(x, y)处的值，与地形分类所用的值相同
+    float at(uint32_t x, uint32_t y, float terrainHeight) const {
+        const float value = sample(x, y) - terrainHeight * heightLapse;
+        return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    }
+};
+
+// 河流与湖泊的生成模型
+enum class HydrologyModel : uint8_t {
+    TRACED = 0,     // 随机源点沿最陡下降追踪河流，随机低洼点放置湖泊
+    FLOW   = 1      // 全图填洼与D8汇流累积：汇流量超过阈值处为河流，填洼深度超过阈值处为湖泊
+};
+
+// 水力侵蚀模型
+enum class ErosionModel : uint8_t {
+    PIPE    = 0,    // 虚拟管道网格：全图水流、速度与沉积物按固定轮数迭代
+    DROPLET = 1     // 液滴粒子：大量随机液滴沿坡下行，沿途侵蚀与沉积
+};
 
 // 地图配置
 struct MG_EXPORT MapConfig {
@@ -92,8 +239,17 @@ struct MG_EXPORT MapConfig {
     float temperature = 0.5f;
     float humidity = 0.5f;
     
+    // 水系模型；分块生成（generateChunk）做不了全图填洼，始终按TRACED生成
+    HydrologyModel hydrology = HydrologyModel::TRACED;
+    // 水力侵蚀模型；分块生成只做热侵蚀，不受此项影响（原因见generateChunk）
+    ErosionModel erosion = ErosionModel::PIPE;
+    
     // 性能参数
     uint32_t threadCount = std::thread::hardware_concurrency();
+    // 图块层使用8位存储（MapData::terrainTiles等），内存和带宽为32位的1/4
+    bool compactTiles = false;
+    // 高度图存储格式，16位格式下内存为float的1/2
+    HeightFormat heightFormat = HeightFormat::FLOAT32;
     
     // 预设
     enum class Preset {
@@ -110,13 +266,94 @@ struct MG_EXPORT MapConfig {
     Preset preset = Preset::CONTINENT;
 };
 
+// 生成流水线的阶段
+enum class GenerationStage : uint8_t {
+    NOISE,          // 高度噪声
+    EROSION,        // 水力、热侵蚀与归一化
+    SMOOTHING,      // 高度平滑
+    TERRAIN,        // 地形分类
+    RIVERS,         // 河流
+    LAKES,          // 湖泊
+    ENCODE,         // 高度编码
+    STATISTICS,     // 统计
+    COUNT
+};
+
+// 单个阶段的性能记录
+struct MapStageProfile {
+    double wallMs = 0.0;
+    // 进程CPU时间：批量并发生成时也包含同时运行的其他地图
+    double cpuMs = 0.0;
+    // 阶段可用的工作线程（或工作通道）数
+    uint32_t threads = 0;
+    // 阶段申请的主要缓冲区字节数，含从缓冲池复用的部分
+    size_t bytesAllocated = 0;
+    // 结果取自阶段缓存，未实际运行
+    bool cached = false;
+};
+
+// 一次生成的分阶段性能记录；库以MG_ENABLE_PROFILING=0编译时enabled为假且全部为0
+struct MapProfile {
+    bool enabled = false;
+    MapStageProfile stages[static_cast<size_t>(GenerationStage::COUNT)];
+    
+    // 阶段计数；HydrologyModel::FLOW下河流计数为河源数，湖泊候选为填洼找到的洼地数
+    uint32_t riverSources = 0;          // 找到的河流源点候选
+    uint32_t riversTraced = 0;          // 实际追踪的河流
+    uint32_t lakeCandidates = 0;        // 找到的湖泊候选低洼点
+    uint32_t lakesPlaced = 0;           // 实际放置的湖泊
+    uint64_t erosionCellUpdates = 0;    // 网格侵蚀处理的格子次数（迭代数×格子数）
+    uint64_t dropletsSimulated = 0;     // 液滴侵蚀模拟的液滴数
+    
+    const MapStageProfile& stage(GenerationStage s) const {
+        return stages[static_cast<size_t>(s)];
+    }
+    double totalWallMs() const {
+        double total = 0.0;
+        for (const auto& s : stages) total += s.wallMs;
+        return total;
+    }
+    // 液滴侵蚀吞吐量（液滴/秒），按侵蚀阶段的墙钟时间计算
+    double dropletsPerSecond() const {
+        double ms = stage(GenerationStage::EROSION).wallMs;
+        return ms > 0.0 ? dropletsSimulated * 1000.0 / ms : 0.0;
+    }
+};
+
 // 地图数据
 struct MG_EXPORT MapData {
     HeightMap heightMap;
+    // 16位高度：MapConfig::heightFormat不是FLOAT32时使用，此时heightMap为空
+    std::vector<uint16_t> heightSamples;
     TileMap terrainMap;
     TileMap decorationMap;
     TileMap resourceMap;
     
+    // 紧凑存储：MapConfig::compactTiles为真时使用，此时上面的32位图层为空
+    CompactTileMap terrainTiles;
+    CompactTileMap decorationTiles;
+    CompactTileMap resourceTiles;
+    
+    // 地形分类使用的低分辨率温度和湿度场，装饰、预览等可按格子取值：
+    // temperature.at(x, y, heights()[y * config.width + x])
+    ClimateField temperature;
+    ClimateField moisture;
+    
+    // 按实际存储访问各图层，未生成的图层为空视图
+    HeightLayerView heights() const {
+        return heightSamples.empty() ? HeightLayerView(heightMap)
+                                     : HeightLayerView(heightSamples, config.heightFormat);
+    }
+    TileLayerView terrain() const {
+        return terrainTiles.empty() ? TileLayerView(terrainMap) : TileLayerView(terrainTiles);
+    }
+    TileLayerView decoration() const {
+        return decorationTiles.empty() ? TileLayerView(decorationMap) : TileLayerView(decorationTiles);
+    }
+    TileLayerView resources() const {
+        return resourceTiles.empty() ? TileLayerView(resourceMap) : TileLayerView(resourceTiles);
+    }
+    
     // 统计数据
     struct Statistics {
         uint32_t waterTiles;
@@ -132,8 +369,36 @@ struct MG_EXPORT MapData {
     // 元数据
     MapConfig config;
     uint32_t generationTimeMs;
+    // 分阶段耗时和计数，缓存命中时为首次生成时的记录
+    MapProfile profile;
+};
+
+// 结果缓存统计
+struct MapCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;       // 缓存地图占用的字节数
+    size_t byteBudget = 0;
+    // 中间阶段（高度、地形）缓存，与缓存地图共用byteBudget
+    size_t stageEntries = 0;
+    size_t stageBytes = 0;
+};
+
+// 临时缓冲区池统计：生成过程中整图大小的临时缓冲区（侵蚀、平滑、河流和湖泊等）都取自引擎的池
+struct MapScratchStats {
+    uint64_t allocations = 0;   // 池新分配缓冲区的次数，稳态生成时不再增长
+    uint64_t reuses = 0;        // 复用空闲缓冲区的次数
+    size_t bytesInUse = 0;      // 当前借出的字节数
+    size_t peakBytesInUse = 0;  // 借出字节数的最高水位
+    size_t bytesCached = 0;     // 池中空闲缓冲区的字节数
 };
 
+// 流式批量生成的回调：index为地图在批次中的序号（种子为baseConfig.seed + index），
+// 返回false时不再开始新的地图
+using MapReadyCallback = std::function<bool(uint32_t index, std::shared_ptr<MapData> data)>;
+
 // 地图生成器主类
 class MG_EXPORT MapGenerator {
 public:
@@ -151,14 +416,41 @@ public:
     std::vector<std::shared_ptr<MapData>> generateBatch(
         const MapConfig& baseConfig, uint32_t count);
     
+    // 流式批量生成：每张地图完成后立即交给onMapReady，库不保留已交付的地图，
+    // 峰值内存与同时生成的地图数成正比而与批量大小无关。回调按完成顺序串行调用，
+    // 不必线程安全；maxInFlight限制同时生成的地图数，0表示按线程数和地图大小自动选择。
+    // 返回实际交付的地图数
+    uint32_t generateBatchStreaming(const MapConfig& baseConfig, uint32_t count,
+                                    const MapReadyCallback& onMapReady,
+                                    uint32_t maxInFlight = 0);
+    
     // 从预设生成
     std::shared_ptr<MapData> generateFromPreset(MapConfig::Preset preset);
     
+    // 分块生成无限世界：返回左上角位于世界坐标(chunkX, chunkY) * chunkSize的块，
+    // 同一位置的高度、地形和河流与块的划分无关，相邻块可无缝拼接。
+    // config.width/height为世界参照尺寸（岛屿衰减和纬度），返回数据的尺寸为chunkSize；
+    // 分块模式使用固定归一化区间，不做水力侵蚀：两种模型的影响范围都有限，但所需halo随轮数增长
+    // （管道模型每轮至少外扩3格另加平流回溯距离，液滴模型为寿命加笔刷半径），
+    // 每块要多算数倍面积，代价过高。chunkSize为0或坐标越界时返回nullptr
+    std::shared_ptr<MapData> generateChunk(int32_t chunkX, int32_t chunkY, uint32_t chunkSize,
+                                           const MapConfig& config);
+    
+    // 结果缓存：相同配置的generateMap直接返回缓存结果，超出字节预算时淘汰最久未用的地图；
+    // 中间阶段（高度、地形）的缓存只使用地图缓存剩余的预算，批量生成不写入阶段缓存；
+    // clearCache同时清空中间阶段的缓存并释放临时缓冲区池中的空闲缓冲区
+    MapCacheStats getCacheStats() const;
+    void setCacheBudget(size_t bytes);
+    void clearCache();
+    
+    // 临时缓冲区池的分配次数和最高水位
+    MapScratchStats getScratchStats() const;
+    
     // 导出地图
     bool exportToImage(const MapData& data, const std::string& filename);
     bool exportToJSON(const MapData& data, const std::string& filename);
 
-    // 导出到PPM/PGM图像
+    // 导出到PPM/PGM图像，viewType：0高度 1地形 2装饰 3合成 4资源 5温度 6湿度
     bool exportToPPM(const MapData& data, const std::string& filename, 
                     bool color = true, uint32_t viewType = 0);
     bool exportToPGM(const MapData& data, const std::string& filename,
@@ -161,11 +161,18 @@ void ConfigPanel::setupUI()
     connect(m_mountainHeightSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
             this, &ConfigPanel::onParameterChanged);
     
+    m_erosionCombo = new QComboBox(this);
+    m_erosionCombo->addItem(tr("Pipe Model"), static_cast<int>(MapGenerator::ErosionModel::PIPE));
+    m_erosionCombo->addItem(tr("Droplets"), static_cast<int>(MapGenerator::ErosionModel::DROPLET));
+    connect(m_erosionCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ConfigPanel::onParameterChanged);
+    
     heightLayout->addRow(tr("Sea Level:"), m_seaLevelSpin);
     heightLayout->addRow(tr("Beach Height:"), m_beachHeightSpin);
     heightLayout->addRow(tr("Plain Height:"), m_plainHeightSpin);
     heightLayout->addRow(tr("Hill Height:"), m_hillHeightSpin);
     heightLayout->addRow(tr("Mountain Height:"), m_mountainHeightSpin);
+    heightLayout->addRow(tr("Erosion:"), m_erosionCombo);
     
     tabWidget->addTab(heightTab, tr("Height"));
     
@@ -200,9 +207,16 @@ void ConfigPanel::setupUI()
     connect(m_humiditySpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
             this, &ConfigPanel::onParameterChanged);
     
+    m_hydrologyCombo = new QComboBox(this);
+    m_hydrologyCombo->addItem(tr("Traced Rivers"), static_cast<int>(MapGenerator::HydrologyModel::TRACED));
+    m_hydrologyCombo->addItem(tr("Flow Accumulation"), static_cast<int>(MapGenerator::HydrologyModel::FLOW));
+    connect(m_hydrologyCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ConfigPanel::onParameterChanged);
+    
     climateLayout->addRow(tr("Climate:"), m_climateCombo);
     climateLayout->addRow(tr("Temperature:"), m_temperatureSpin);
     climateLayout->addRow(tr("Humidity:"), m_humiditySpin);
+    climateLayout->addRow(tr("Hydrology:"), m_hydrologyCombo);
     
     tabWidget->addTab(climateTab, tr("Climate"));
     
@@ -246,7 +260,21 @@ void ConfigPanel::setupUI()
     connect(m_threadCountSpin, QOverload<int>::of(&QSpinBox::valueChanged),
             this, &ConfigPanel::onParameterChanged);
     
+    m_compactTilesCheck = new QCheckBox(this);
+    m_compactTilesCheck->setChecked(false);
+    connect(m_compactTilesCheck, &QCheckBox::toggled,
+            this, &ConfigPanel::onParameterChanged);
+    
     perfLayout->addRow(tr("Thread Count:"), m_threadCountSpin);
+    m_heightFormatCombo = new QComboBox(this);
+    m_heightFormatCombo->addItem(tr("Float (32-bit)"), static_cast<int>(MapGenerator::HeightFormat::FLOAT32));
+    m_heightFormatCombo->addItem(tr("Normalized (16-bit)"), static_cast<int>(MapGenerator::HeightFormat::UNORM16));
+    m_heightFormatCombo->addItem(tr("Half Float (16-bit)"), static_cast<int>(MapGenerator::HeightFormat::HALF16));
+    connect(m_heightFormatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ConfigPanel::onParameterChanged);
+    
+    perfLayout->addRow(tr("Compact Tiles:"), m_compactTilesCheck);
+    perfLayout->addRow(tr("Height Storage:"), m_heightFormatCombo);
     
     tabWidget->addTab(perfTab, tr("Performance"));
     
@@ -262,6 +290,8 @@ void ConfigPanel::setupUI()
     m_viewTypeCombo->addItem(tr("Decoration Map"), 2);
     m_viewTypeCombo->addItem(tr("Composite Map"), 3);
     m_viewTypeCombo->addItem(tr("Resource Map"), 4);
+    m_viewTypeCombo->addItem(tr("Temperature Map"), 5);
+    m_viewTypeCombo->addItem(tr("Moisture Map"), 6);
     connect(m_viewTypeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &ConfigPanel::onViewTypeChanged);
     
@@ -313,17 +343,24 @@ MapGenerator::MapConfig ConfigPanel::getConfig() const
     config.plainHeight = static_cast<float>(m_plainHeightSpin->value());
     config.hillHeight = static_cast<float>(m_hillHeightSpin->value());
     config.mountainHeight = static_cast<float>(m_mountainHeightSpin->value());
+    config.erosion = static_cast<MapGenerator::ErosionModel>(
+        m_erosionCombo->currentData().toInt());
     
     config.climate = static_cast<MapGenerator::ClimateType>(
         m_climateCombo->currentData().toInt());
     config.temperature = static_cast<float>(m_temperatureSpin->value());
     config.humidity = static_cast<float>(m_humiditySpin->value());
+    config.hydrology = static_cast<MapGenerator::HydrologyModel>(
+        m_hydrologyCombo->currentData().toInt());
     
     // config.wfcIterations = static_cast<uint32_t>(m_wfcIterationsSpin->value());
     // config.wfcEntropyWeight = static_cast<float>(m_wfcEntropyWeightSpin->value());
     // config.wfcEnableBacktracking = m_wfcBacktrackingCheck->isChecked();
     
     config.threadCount = static_cast<uint32_t>(m_threadCountSpin->value());
+    config.compactTiles = m_compactTilesCheck->isChecked();
+    config.heightFormat = static_cast<MapGenerator::HeightFormat>(
+        m_heightFormatCombo->currentData().toInt());
     
     config.preset = static_cast<MapGenerator::MapConfig::Preset>(
         m_presetCombo->currentData().toInt());
@@ -349,16 +386,29 @@ void ConfigPanel::setConfig(const MapGenerator::MapConfig &config)
     m_plainHeightSpin->setValue(config.plainHeight);
     m_hillHeightSpin->setValue(config.hillHeight);
     m_mountainHeightSpin->setValue(config.mountainHeight);
+    int erosionIndex = m_erosionCombo->findData(static_cast<int>(config.erosion));
+    if (erosionIndex >= 0) {
+        m_erosionCombo->setCurrentIndex(erosionIndex);
+    }
     
     m_climateCombo->setCurrentIndex(static_cast<int>(config.climate));
     m_temperatureSpin->setValue(config.temperature);
     m_humiditySpin->setValue(config.humidity);
+    int hydrologyIndex = m_hydrologyCombo->findData(static_cast<int>(config.hydrology));
+    if (hydrologyIndex >= 0) {
+        m_hydrologyCombo->setCurrentIndex(hydrologyIndex);
+    }
     
     // m_wfcIterationsSpin->setValue(static_cast<int>(config.wfcIterations));
     // m_wfcEntropyWeightSpin->setValue(config.wfcEntropyWeight);
     // m_wfcBacktrackingCheck->setChecked(config.wfcEnableBacktracking);
     
     m_threadCountSpin->setValue(static_cast<int>(config.threadCount));
+    m_compactTilesCheck->setChecked(config.compactTiles);
+    int heightFormatIndex = m_heightFormatCombo->findData(static_cast<int>(config.heightFormat));
+    if (heightFormatIndex >= 0) {
+        m_heightFormatCombo->setCurrentIndex(heightFormatIndex);
+    }
     
     int presetIndex = m_presetCombo->findData(static_cast<int>(config.preset));
     if (presetIndex >= 0) {
@@ -474,11 +524,15 @@ void ConfigPanel::blockSignals(bool block)
     m_plainHeightSpin->blockSignals(block);
     m_hillHeightSpin->blockSignals(block);
     m_mountainHeightSpin->blockSignals(block);
+    m_erosionCombo->blockSignals(block);
     m_climateCombo->blockSignals(block);
     m_temperatureSpin->blockSignals(block);
     m_humiditySpin->blockSignals(block);
+    m_hydrologyCombo->blockSignals(block);
     m_wfcIterationsSpin->blockSignals(block);
     m_wfcEntropyWeightSpin->blockSignals(block);
     m_wfcBacktrackingCheck->blockSignals(block);
     m_threadCountSpin->blockSignals(block);
+    m_compactTilesCheck->blockSignals(block);
+    m_heightFormatCombo->blockSignals(block);
 }
@@ -67,11 +67,13 @@ private:
     QDoubleSpinBox *m_plainHeightSpin;
     QDoubleSpinBox *m_hillHeightSpin;
     QDoubleSpinBox *m_mountainHeightSpin;
+    QComboBox *m_erosionCombo;
     
     // Climate parameters
     QComboBox *m_climateCombo;
     QDoubleSpinBox *m_temperatureSpin;
     QDoubleSpinBox *m_humiditySpin;
+    QComboBox *m_hydrologyCombo;
     
     // WFC parameters
     QSpinBox *m_wfcIterationsSpin;
@@ -80,6 +82,8 @@ private:
     
     // Performance parameters
     QSpinBox *m_threadCountSpin;
+    QCheckBox *m_compactTilesCheck;
+    QComboBox *m_heightFormatCombo;
     
     // View controls
     QComboBox *m_viewTypeCombo;
@@ -15,6 +15,7 @@ MainWindow::MainWindow(QWidget *parent)
     , m_mapView(new MapView(this))
     , m_configPanel(new ConfigPanel(this))
     , m_regenerateTimer(new QTimer(this))
+    , m_generator(std::make_unique<MapGenerator::MapGenerator>())
     , m_statusLabel(new QLabel(this))
     , m_sizeLabel(new QLabel(this))
     , m_timeLabel(new QLabel(this))
@@ -151,6 +152,8 @@ void MainWindow::setupToolbar()
     viewTypeCombo->addItem("Decoration Map", 2);
     viewTypeCombo->addItem("Composite Map", 3);
     viewTypeCombo->addItem("Resource Map", 4);
+    viewTypeCombo->addItem("Temperature Map", 5);
+    viewTypeCombo->addItem("Moisture Map", 6);
     viewTypeCombo->setCurrentIndex(3);
     connect(viewTypeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, [this, viewTypeCombo](int index) { onViewTypeChanged(viewTypeCombo->itemData(index).toInt()); });
@@ -234,8 +237,7 @@ void MainWindow::onExportPPM()
         tr("Export PPM"), QString(), tr("PPM Files (*.ppm);;All Files (*)"));
     
     if (!fileName.isEmpty()) {
-        MapGenerator::MapGenerator generator;
-        bool success = generator.exportToPPM(*m_currentMapData, 
+        bool success = m_generator->exportToPPM(*m_currentMapData, 
             fileName.toStdString(), true, m_mapView->viewType());
         
         if (success) {
@@ -256,8 +258,7 @@ void MainWindow::onExportPGM()
         tr("Export PGM"), QString(), tr("PGM Files (*.pgm);;All Files (*)"));
     
     if (!fileName.isEmpty()) {
-        MapGenerator::MapGenerator generator;
-        bool success = generator.exportToPGM(*m_currentMapData, 
+        bool success = m_generator->exportToPGM(*m_currentMapData, 
             fileName.toStdString(), 1.0f);
         
         if (success) {
@@ -309,8 +310,7 @@ void MainWindow::generateNewMap()
     auto startTime = std::chrono::high_resolution_clock::now();
     
     try {
-        MapGenerator::MapGenerator generator;
-        m_currentMapData = generator.generateMap(config);
+        m_currentMapData = m_generator->generateMap(config);
         
         auto endTime = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
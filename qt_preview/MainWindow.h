@@ -37,6 +37,7 @@ private:
     MapView *m_mapView;
     ConfigPanel *m_configPanel;
     QTimer *m_regenerateTimer;
+    std::unique_ptr<MapGenerator::MapGenerator> m_generator;
     std::shared_ptr<MapGenerator::MapData> m_currentMapData;
     
     // Actions
@@ -311,8 +311,8 @@ void MapView::mouseMoveEvent(QMouseEvent *event)
         int y = qBound(0, (int)imagePos.y(), (int)m_mapData->config.height - 1);
         
         uint32_t idx = y * m_mapData->config.width + x;
-        float height = m_mapData->heightMap[idx];
-        auto terrain = static_cast<MapGenerator::TerrainType>(m_mapData->terrainMap[idx]);
+        float height = m_mapData->heights()[idx];
+        auto terrain = m_mapData->terrain().terrain(idx);
         // auto decoration = static_cast<MapGenerator::TerrainType>(m_mapData->decorationMap[idx]);
         
         QString tooltip = QString("X: %1, Y: %2\n"
@@ -396,6 +396,13 @@ void MapView::generateImage()
     
     m_image = QImage(width, height, QImage::Format_RGB32);
     
+    // Layers may be stored as 8-bit tiles; missing decoration falls back to terrain
+    MapGenerator::TileLayerView terrainLayer = m_mapData->terrain();
+    MapGenerator::TileLayerView decorationLayer = m_mapData->decoration().empty()
+        ? terrainLayer : m_mapData->decoration();
+    MapGenerator::TileLayerView resourceLayer = m_mapData->resources();
+    MapGenerator::HeightLayerView heightLayer = m_mapData->heights();
+    
     // Count legend items
     std::map<MapGenerator::TerrainType, int> terrainCounts;
     std::map<MapGenerator::TerrainType, int> decorationCounts;
@@ -407,12 +414,12 @@ void MapView::generateImage()
             
             switch (m_viewType) {
             case 0: // Height map
-                color = getHeightColor(m_mapData->heightMap[idx]);
+                color = getHeightColor(heightLayer[idx]);
                 break;
                 
             case 1: // Terrain map
                 {
-                    auto terrain = static_cast<MapGenerator::TerrainType>(m_mapData->terrainMap[idx]);
+                    auto terrain = terrainLayer.terrain(idx);
                     color = getTerrainColor(terrain);
                     terrainCounts[terrain]++;
                 }
@@ -420,7 +427,7 @@ void MapView::generateImage()
                 
             case 2: // Decoration map
                 {
-                    auto decoration = static_cast<MapGenerator::TerrainType>(m_mapData->decorationMap[idx]);
+                    auto decoration = decorationLayer.terrain(idx);
                     color = getTerrainColor(decoration);
                     decorationCounts[decoration]++;
                 }
@@ -428,7 +435,7 @@ void MapView::generateImage()
                 
             case 3: // Composite map
                 {
-                    auto terrain = static_cast<MapGenerator::TerrainType>(m_mapData->terrainMap[idx]);
+                    auto terrain = terrainLayer.terrain(idx);
                     // auto decoration = static_cast<MapGenerator::TerrainType>(m_mapData->decorationMap[idx]);
                     
                     QColor terrainColor = getTerrainColor(terrain);
@@ -449,10 +456,22 @@ void MapView::generateImage()
                 
             case 4: // Resource map
                 {
-                    uint32_t resource = m_mapData->resourceMap[idx];
+                    uint32_t resource = resourceLayer.empty() ? 0 : resourceLayer[idx];
                     color = getResourceColor(resource);
                 }
                 break;
+                
+            case 5: // Temperature map
+                color = m_mapData->temperature.empty()
+                    ? QColor(Qt::darkGray)
+                    : getTemperatureColor(m_mapData->temperature.at(x, y, heightLayer[idx]));
+                break;
+                
+            case 6: // Moisture map
+                color = m_mapData->moisture.empty()
+                    ? QColor(Qt::darkGray)
+                    : getMoistureColor(m_mapData->moisture.at(x, y, heightLayer[idx]));
+                break;
             }
             
             m_image.setPixelColor(x, y, color);
@@ -618,6 +637,20 @@ QColor MapView::getHeightColor(float height) const
     return QColor(value, value, 255);
 }
 
+QColor MapView::getTemperatureColor(float temperature) const
+{
+    // Cold blue to hot red
+    int value = qBound(0, static_cast<int>(temperature * 255), 255);
+    return QColor(value, 64, 255 - value);
+}
+
+QColor MapView::getMoistureColor(float moisture) const
+{
+    // Dry tan to wet teal
+    float t = qBound(0.0f, moisture, 1.0f);
+    return QColor(static_cast<int>(210 - 180 * t), static_cast<int>(180 - 40 * t), static_cast<int>(120 + 100 * t));
+}
+
 QColor MapView::getResourceColor(uint32_t resource) const
 {
     static const std::unordered_map<uint32_t, QColor> resourceColors = {
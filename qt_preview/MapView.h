@@ -57,12 +57,14 @@ private:
     QColor getTerrainColor(MapGenerator::TerrainType type) const;
     QColor getHeightColor(float height) const;
     QColor getResourceColor(uint32_t resource) const;
+    QColor getTemperatureColor(float temperature) const;
+    QColor getMoistureColor(float moisture) const;
     
     std::shared_ptr<MapGenerator::MapData> m_mapData;
     QImage m_image;
     QImage m_scaledImage;
     
-    int m_viewType = 3; // 0: height, 1: terrain, 2: decoration, 3: composite, 4: resource
+    int m_viewType = 3; // 0: height, 1: terrain, 2: decoration, 3: composite, 4: resource, 5: temperature, 6: moisture
     int m_zoomLevel = 100;
     
     bool m_showGrid = false;
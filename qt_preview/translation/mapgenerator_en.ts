@@ -213,6 +213,31 @@
         <source>Thread Count:</source>
         <translation>线程数:</translation>
     </message>
+    <message>
+        <location filename="ConfigPanel.cpp" line="271"/>
+        <source>Compact Tiles:</source>
+        <translation>紧凑图块:</translation>
+    </message>
+    <message>
+        <location filename="ConfigPanel.cpp" line="272"/>
+        <source>Height Storage:</source>
+        <translation>高度存储:</translation>
+    </message>
+    <message>
+        <location filename="ConfigPanel.cpp" line="273"/>
+        <source>Float (32-bit)</source>
+        <translation>浮点（32位）</translation>
+    </message>
+    <message>
+        <location filename="ConfigPanel.cpp" line="274"/>
+        <source>Normalized (16-bit)</source>
+        <translation>归一化整数（16位）</translation>
+    </message>
+    <message>
+        <location filename="ConfigPanel.cpp" line="275"/>
+        <source>Half Float (16-bit)</source>
+        <translation>半精度浮点（16位）</translation>
+    </message>
     <message>
         <location filename="ConfigPanel.cpp" line="281"/>
         <source>View Options</source>
@@ -5,26 +5,44 @@
 
 #include "MapGenerator.h"
 #include "internal/MapGeneratorInternal.h"
+#include "internal/HeightCodec.h"
 
 namespace MapGenerator {
 
+void decodeHeightSamples(HeightFormat format, const uint16_t* samples,
+                         float* out, size_t count) {
+    internal::decodeHeights(format, samples, out, count);
+}
+
 class MapGenerator::Impl {
 public:
-    Impl() {
+    Impl() : m_engine(std::make_unique<internal::MapGeneratorInternal>()) {
     }
     
     std::shared_ptr<MapData> generateMap(const MapConfig& config) {
-        std::unique_ptr<internal::MapGeneratorInternal> internal = std::make_unique<internal::MapGeneratorInternal>(config.seed);
-        return internal->generate(config);
+        return m_engine->generate(config);
     }
     
     std::vector<std::shared_ptr<MapData>> generateBatch(
         const MapConfig& baseConfig, uint32_t count) {
-        std::unique_ptr<internal::MapGeneratorInternal> internal = std::make_unique<internal::MapGeneratorInternal>(baseConfig.seed);
-        return internal->generateBatch(baseConfig, count);
+        return m_engine->generateBatch(baseConfig, count);
+    }
+    
+    uint32_t generateBatchStreaming(const MapConfig& baseConfig, uint32_t count,
+                                    const MapReadyCallback& onMapReady, uint32_t maxInFlight) {
+        return m_engine->generateBatchStreaming(baseConfig, count, onMapReady, maxInFlight);
+    }
+    
+    std::shared_ptr<MapData> generateChunk(int32_t chunkX, int32_t chunkY, uint32_t chunkSize,
+                                           const MapConfig& config) {
+        return m_engine->generateChunk(chunkX, chunkY, chunkSize, config);
     }
     
+    internal::MapGeneratorInternal& engine() { return *m_engine; }
+    
 private:
+    // 常驻生成引擎：工作线程、按种子缓存的噪声表、临时缓冲区和结果缓存在多次调用间复用
+    std::unique_ptr<internal::MapGeneratorInternal> m_engine;
 };
 
 // 添加辅助函数
@@ -128,12 +146,39 @@ std::vector<std::shared_ptr<MapData>> MapGenerator::generateBatch(
     return m_impl->generateBatch(baseConfig, count);
 }
 
+uint32_t MapGenerator::generateBatchStreaming(const MapConfig& baseConfig, uint32_t count,
+                                              const MapReadyCallback& onMapReady,
+                                              uint32_t maxInFlight) {
+    return m_impl->generateBatchStreaming(baseConfig, count, onMapReady, maxInFlight);
+}
+
 std::shared_ptr<MapData> MapGenerator::generateFromPreset(
     MapConfig::Preset preset) {
     MapConfig config = createConfigFromPreset(preset);
     return generateMap(config);
 }
 
+std::shared_ptr<MapData> MapGenerator::generateChunk(int32_t chunkX, int32_t chunkY,
+                                                     uint32_t chunkSize, const MapConfig& config) {
+    return m_impl->generateChunk(chunkX, chunkY, chunkSize, config);
+}
+
+MapCacheStats MapGenerator::getCacheStats() const {
+    return m_impl->engine().cacheStats();
+}
+
+void MapGenerator::setCacheBudget(size_t bytes) {
+    m_impl->engine().setCacheBudget(bytes);
+}
+
+void MapGenerator::clearCache() {
+    m_impl->engine().clearCache();
+}
+
+MapScratchStats MapGenerator::getScratchStats() const {
+    return m_impl->engine().scratchStats();
+}
+
 bool MapGenerator::exportToImage(const MapData& data, const std::string& filename) {
     // 简化实现 - 实际应使用图像库
     // 这里返回true表示成功
@@ -151,6 +196,16 @@ bool MapGenerator::exportToPPM(const MapData& data, const std::string& filename,
     uint32_t width = data.config.width;
     uint32_t height = data.config.height;
     
+    // 装饰层未生成时回退到地形层，资源层未生成时视为无资源
+    TileLayerView terrainLayer = data.terrain();
+    TileLayerView decorationLayer = data.decoration().empty() ? terrainLayer : data.decoration();
+    TileLayerView resourceLayer = data.resources();
+    HeightLayerView heights = data.heights();
+    if (terrainLayer.size() < static_cast<size_t>(width) * height ||
+        heights.size() < static_cast<size_t>(width) * height) {
+        return false;
+    }
+    
     if (color) {
         // 彩色图像：3通道
         imageData.resize(width * height * 3);
@@ -163,7 +218,7 @@ bool MapGenerator::exportToPPM(const MapData& data, const std::string& filename,
                 switch (viewType) {
                     case 0: // 高度图
                         {
-                            float h = data.heightMap[idx];
+                            float h = heights[idx];
                             uint8_t gray = static_cast<uint8_t>(h * 255);
                             r = g = b = gray;
                         }
@@ -171,25 +226,25 @@ bool MapGenerator::exportToPPM(const MapData& data, const std::string& filename,
                         
                     case 1: // 地形图
                         {
-                            TerrainType terrain = static_cast<TerrainType>(data.terrainMap[idx]);
+                            TerrainType terrain = terrainLayer.terrain(idx);
                             getTerrainColor(terrain, r, g, b);
                         }
                         break;
                         
                     case 2: // 装饰图
                         {
-                            TerrainType decoration = static_cast<TerrainType>(data.decorationMap[idx]);
+                            TerrainType decoration = decorationLayer.terrain(idx);
                             getTerrainColor(decoration, r, g, b);
                         }
                         break;
                         
                     case 3: // 合成图（地形+装饰）
                         {
-                            TerrainType terrain = static_cast<TerrainType>(data.terrainMap[idx]);
+                            TerrainType terrain = terrainLayer.terrain(idx);
                             getTerrainColor(terrain, r, g, b);
                             
                             // 如果有装饰，混合颜色
-                            TerrainType decoration = static_cast<TerrainType>(data.decorationMap[idx]);
+                            TerrainType decoration = decorationLayer.terrain(idx);
                             if (decoration != TerrainType::GRASS && decoration != TerrainType::WATER) { // 假设GRASS是默认无装饰
                                 uint8_t dr, dg, db;
                                 getTerrainColor(decoration, dr, dg, db);
@@ -203,7 +258,7 @@ bool MapGenerator::exportToPPM(const MapData& data, const std::string& filename,
                         
                     case 4: // 资源图
                         {
-                            uint32_t resource = data.resourceMap[idx];
+                            uint32_t resource = resourceLayer.empty() ? 0 : resourceLayer[idx];
                             switch (resource) {
                                 case 1: // 铁矿
                                     r = 150; g = 80; b = 80; break;
@@ -215,7 +270,7 @@ bool MapGenerator::exportToPPM(const MapData& data, const std::string& filename,
                                     r = 180; g = 160; b = 140; break;
                                 default:
                                     // 无资源：显示背景地形
-                                    TerrainType terrain = static_cast<TerrainType>(data.terrainMap[idx]);
+                                    TerrainType terrain = terrainLayer.terrain(idx);
                                     getTerrainColor(terrain, r, g, b);
                                     // 稍微变暗
                                     r = r * 0.7f;
@@ -226,6 +281,28 @@ bool MapGenerator::exportToPPM(const MapData& data, const std::string& filename,
                         }
                         break;
                         
+                    case 5: // 温度图：冷蓝到暖红，未生成气候场时为黑色
+                        {
+                            const ClimateField& field = data.temperature;
+                            float t = field.empty() ? 0.0f : field.at(x, y, heights[idx]);
+                            r = static_cast<uint8_t>(t * 255);
+                            g = 64;
+                            b = static_cast<uint8_t>(255 - t * 255);
+                            if (field.empty()) r = g = b = 0;
+                        }
+                        break;
+                        
+                    case 6: // 湿度图：干燥的土黄到湿润的青色
+                        {
+                            const ClimateField& field = data.moisture;
+                            float m = field.empty() ? 0.0f : field.at(x, y, heights[idx]);
+                            r = static_cast<uint8_t>(210 - 180 * m);
+                            g = static_cast<uint8_t>(180 - 40 * m);
+                            b = static_cast<uint8_t>(120 + 100 * m);
+                            if (field.empty()) r = g = b = 0;
+                        }
+                        break;
+                        
                     default:
                         r = g = b = 0;
                         break;
@@ -250,16 +327,26 @@ bool MapGenerator::exportToPPM(const MapData& data, const std::string& filename,
                 
                 switch (viewType) {
                     case 0: // 高度图
-                        gray = static_cast<uint8_t>(data.heightMap[idx] * 255);
+                        gray = static_cast<uint8_t>(heights[idx] * 255);
                         break;
                         
                     case 1: // 地形图（按类型赋不同灰度）
                         {
-                            TerrainType terrain = static_cast<TerrainType>(data.terrainMap[idx]);
+                            TerrainType terrain = terrainLayer.terrain(idx);
                             gray = static_cast<uint8_t>(static_cast<uint32_t>(terrain) * 10);
                         }
                         break;
                         
+                    case 5: // 温度
+                        gray = data.temperature.empty() ? 0
+                            : static_cast<uint8_t>(data.temperature.at(x, y, heights[idx]) * 255);
+                        break;
+                        
+                    case 6: // 湿度
+                        gray = data.moisture.empty() ? 0
+                            : static_cast<uint8_t>(data.moisture.at(x, y, heights[idx]) * 255);
+                        break;
+                        
                     default:
                         gray = 128;
                         break;
@@ -281,10 +368,17 @@ bool MapGenerator::exportToPGM(const MapData& data, const std::string& filename,
     
     imageData.resize(width * height);
     
+    HeightLayerView heights = data.heights();
+    if (heights.size() < static_cast<size_t>(width) * height) {
+        return false;
+    }
+    std::vector<float> row(width);
+    
     for (uint32_t y = 0; y < height; ++y) {
+        heights.decode(static_cast<size_t>(y) * width, width, row.data());
+        
         for (uint32_t x = 0; x < width; ++x) {
-            uint32_t idx = y * width + x;
-            float heightValue = data.heightMap[idx];
+            float heightValue = row[x];
             
             // 应用缩放和裁剪
             heightValue = std::clamp(heightValue * scale, 0.0f, 1.0f);
@@ -307,10 +401,17 @@ bool MapGenerator::exportHeightmapToPGM(const MapData& data,
     
     imageData.resize(width * height);
     
+    HeightLayerView heights = data.heights();
+    if (heights.size() < static_cast<size_t>(width) * height) {
+        return false;
+    }
+    std::vector<float> row(width);
+    
     for (uint32_t y = 0; y < height; ++y) {
+        heights.decode(static_cast<size_t>(y) * width, width, row.data());
+        
         for (uint32_t x = 0; x < width; ++x) {
-            uint32_t idx = y * width + x;
-            float heightValue = data.heightMap[idx];
+            float heightValue = row[x];
             
             // 重新映射到指定范围
             float normalized = (heightValue - minHeight) / (maxHeight - minHeight);
@@ -333,10 +434,15 @@ bool MapGenerator::exportTerrainIndexToPGM(const MapData& data,
     
     imageData.resize(width * height);
     
+    TileLayerView terrainLayer = data.terrain();
+    if (terrainLayer.size() < static_cast<size_t>(width) * height) {
+        return false;
+    }
+    
     // 找到最大类型值用于归一化
     uint32_t maxType = 0;
-    for (uint32_t value : data.terrainMap) {
-        maxType = std::max(maxType, value);
+    for (size_t i = 0; i < terrainLayer.size(); ++i) {
+        maxType = std::max(maxType, terrainLayer[i]);
     }
     
     if (maxType == 0) maxType = 1;
@@ -344,7 +450,7 @@ bool MapGenerator::exportTerrainIndexToPGM(const MapData& data,
     for (uint32_t y = 0; y < height; ++y) {
         for (uint32_t x = 0; x < width; ++x) {
             uint32_t idx = y * width + x;
-            uint32_t type = data.terrainMap[idx];
+            uint32_t type = terrainLayer[idx];
             
             // 归一化到0-255
             uint8_t gray = static_cast<uint8_t>((type * 255) / maxType);
@@ -379,10 +485,17 @@ bool MapGenerator::exportHeightmapToPPM(const MapData& data,
     
     const std::vector<Color>& colors = gradient.empty() ? defaultGradient : gradient;
     
+    HeightLayerView heights = data.heights();
+    if (heights.size() < static_cast<size_t>(width) * height) {
+        return false;
+    }
+    std::vector<float> row(width);
+    
     for (uint32_t y = 0; y < height; ++y) {
+        heights.decode(static_cast<size_t>(y) * width, width, row.data());
+        
         for (uint32_t x = 0; x < width; ++x) {
-            uint32_t idx = y * width + x;
-            float heightValue = data.heightMap[idx];
+            float heightValue = row[x];
             
             // 根据高度选择颜色
             float t = std::clamp(heightValue, 0.0f, 1.0f);
@@ -12,6 +12,7 @@ namespace internal {
 // 噪声类型
 enum class NoiseType {
     PERLIN,
+    PERLIN_2D,  // 二维柏林噪声（4个角点），高度图的默认快速路径
     SIMPLEX,
     VALUE,
     WORLEY
@@ -30,6 +31,7 @@ struct NoiseParams {
     float warpFrequency = 0.1f;
     float ridgeWeight = 0.0f;
     float terraceLevels = 0.0f;
+    uint32_t tilePeriod = 0;  // Worley噪声的平铺周期（基础倍频下的格数），0为不平铺
     
     // 域扭曲参数
     struct DomainWarp {
@@ -67,6 +69,8 @@ struct ErosionParams {
     bool thermalErosion = false;
     float talusAngle = 30.0f;
     float thermalRate = 0.1f;
+    // 单轮最大高度变化不超过该值时提前结束热侵蚀
+    float thermalTolerance = 1e-5f;
     
     // 水力侵蚀
     bool hydraulicErosion = true;
@@ -74,6 +78,14 @@ struct ErosionParams {
     float inertia = 0.05f;
     float minSlope = 0.01f;
     float pipeLength = 1.0f;
+    // 管道模型的轮数（热侵蚀仍按iterations）和每轮时间步长
+    uint32_t pipeIterations = 60;
+    float timeStep = 0.05f;
+    
+    // 液滴模型：每格投放的液滴数和侵蚀笔刷半径（寿命和惯性见上）
+    ErosionModel hydraulicModel = ErosionModel::PIPE;
+    float dropletsPerCell = 1.0f;
+    uint32_t dropletRadius = 3;
 };
 
 // 河流参数
@@ -95,6 +107,11 @@ struct RiverParams {
     float lakeProbability = 0.05f;
     float minLakeSize = 10.0f;
     float maxLakeSize = 40.0f;
+    
+    // 汇流模型（HydrologyModel::FLOW）
+    float flowRiverFraction = 0.002f;   // 汇流面积达到全图格数的该比例处成为河流
+    uint32_t flowRiverMinCells = 64;    // 河流汇流面积下限，避免小地图上河流过密
+    float flowLakeDepth = 0.02f;        // 填洼深度超过该值的陆地格成为湖泊
 };
 
 // 生物群落参数
@@ -0,0 +1,244 @@
+// src/internal/DropletErosion.cpp
+#include "DropletErosion.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace MapGenerator {
+namespace internal {
+
+namespace {
+
+// 图块边长下限，实际边长不小于液滴影响半径的2倍
+constexpr uint32_t kMinDropletTile = 64;
+// 液滴分几轮投放：每轮四个着色阶段，轮数越多各图块之间的交替越细
+constexpr uint32_t kDropletRounds = 4;
+// 液滴初速度与初始水量
+constexpr float kInitialSpeed = 1.0f;
+constexpr float kInitialWater = 1.0f;
+
+// 侵蚀笔刷：半径内各格的偏移和归一化权重，越靠近中心权重越大
+struct DropletBrush {
+    std::vector<int32_t> dx;
+    std::vector<int32_t> dy;
+    // 按行宽展开的下标偏移，笔刷完全在图内时直接使用
+    std::vector<ptrdiff_t> offset;
+    std::vector<float> weight;
+    int32_t radius = 0;
+};
+
+DropletBrush buildBrush(uint32_t radius, uint32_t width) {
+    DropletBrush brush;
+    brush.radius = static_cast<int32_t>(radius);
+    const float r = std::max(static_cast<float>(radius), 1.0f);
+    float total = 0.0f;
+    for (int32_t y = -brush.radius; y <= brush.radius; ++y) {
+        for (int32_t x = -brush.radius; x <= brush.radius; ++x) {
+            float distance = std::sqrt(static_cast<float>(x * x + y * y));
+            if (distance > static_cast<float>(radius)) continue;
+            float weight = 1.0f - distance / (r + 1.0f);
+            brush.dx.push_back(x);
+            brush.dy.push_back(y);
+            brush.offset.push_back(static_cast<ptrdiff_t>(y) * width + x);
+            brush.weight.push_back(weight);
+            total += weight;
+        }
+    }
+    for (float& weight : brush.weight) {
+        weight /= total;
+    }
+    return brush;
+}
+
+struct HeightSample {
+    float height;
+    float gx;
+    float gy;
+};
+
+// 双线性插值的高度与梯度，要求 x < width-1、y < height-1
+inline HeightSample sampleHeight(const float* h, uint32_t width, float x, float y) {
+    const uint32_t ix = static_cast<uint32_t>(x);
+    const uint32_t iy = static_cast<uint32_t>(y);
+    const float fx = x - static_cast<float>(ix);
+    const float fy = y - static_cast<float>(iy);
+    const size_t i = static_cast<size_t>(iy) * width + ix;
+    const float nw = h[i];
+    const float ne = h[i + 1];
+    const float sw = h[i + width];
+    const float se = h[i + width + 1];
+    HeightSample s;
+    s.gx = (ne - nw) * (1.0f - fy) + (se - sw) * fy;
+    s.gy = (sw - nw) * (1.0f - fx) + (se - ne) * fx;
+    s.height = nw * (1.0f - fx) * (1.0f - fy) + ne * fx * (1.0f - fy) +
+               sw * (1.0f - fx) * fy + se * fx * fy;
+    return s;
+}
+
+// 图块：[x0, x1) x [y0, y1)，颜色为 (tx & 1) | ((ty & 1) << 1)
+struct DropletTile {
+    uint32_t x0, y0, x1, y1;
+    uint32_t index;
+};
+
+class DropletSimulator {
+public:
+    DropletSimulator(float* heights, uint32_t width, uint32_t height,
+                     const ErosionParams& params, const DropletBrush& brush)
+        : m_h(heights), m_width(width), m_height(height), m_params(params), m_brush(brush) {}
+
+    // 液滴出发点在[0, width-1) x [0, height-1)内
+    void simulate(float x, float y) const {
+        const ErosionParams& p = m_params;
+        const float maxX = static_cast<float>(m_width - 1);
+        const float maxY = static_cast<float>(m_height - 1);
+        float dirX = 0.0f;
+        float dirY = 0.0f;
+        float speed = kInitialSpeed;
+        float water = kInitialWater;
+        float sediment = 0.0f;
+
+        for (uint32_t step = 0; step < p.dropletLifetime; ++step) {
+            const uint32_t ix = static_cast<uint32_t>(x);
+            const uint32_t iy = static_cast<uint32_t>(y);
+            const float fx = x - static_cast<float>(ix);
+            const float fy = y - static_cast<float>(iy);
+            const HeightSample here = sampleHeight(m_h, m_width, x, y);
+
+            // 方向带惯性地转向下坡，每步恰好前进一格
+            dirX = dirX * p.inertia - here.gx * (1.0f - p.inertia);
+            dirY = dirY * p.inertia - here.gy * (1.0f - p.inertia);
+            const float length = std::sqrt(dirX * dirX + dirY * dirY);
+            if (length <= 0.0f) break;
+            dirX /= length;
+            dirY /= length;
+            x += dirX;
+            y += dirY;
+            if (x < 0.0f || y < 0.0f || x >= maxX || y >= maxY) break;
+
+            const float deltaHeight = sampleHeight(m_h, m_width, x, y).height - here.height;
+            const float capacity = std::max(-deltaHeight, p.minSlope) * speed * water * p.sedimentCapacity;
+            const size_t cell = static_cast<size_t>(iy) * m_width + ix;
+
+            if (sediment > capacity || deltaHeight > 0.0f) {
+                // 上坡时填平来时的坑，否则按沉积率卸下超出能力的部分
+                float amount = deltaHeight > 0.0f ? std::min(deltaHeight, sediment)
+                                                  : (sediment - capacity) * p.depositionRate;
+                sediment -= amount;
+                m_h[cell] += amount * (1.0f - fx) * (1.0f - fy);
+                m_h[cell + 1] += amount * fx * (1.0f - fy);
+                m_h[cell + m_width] += amount * (1.0f - fx) * fy;
+                m_h[cell + m_width + 1] += amount * fx * fy;
+            } else {
+                // 侵蚀量不超过高差，避免挖出坑
+                float amount = std::min((capacity - sediment) * p.erosionRate, -deltaHeight);
+                sediment += erode(ix, iy, amount);
+            }
+
+            speed = std::sqrt(std::max(0.0f, speed * speed - deltaHeight * p.gravity));
+            water *= 1.0f - p.evaporationRate;
+        }
+    }
+
+private:
+    // 笔刷侵蚀，落在图外的部分不计；返回实际带走的量
+    float erode(uint32_t cx, uint32_t cy, float amount) const {
+        const uint32_t r = static_cast<uint32_t>(m_brush.radius);
+        const size_t count = m_brush.weight.size();
+        if (cx >= r && cy >= r && cx + r < m_width && cy + r < m_height) {
+            float* center = m_h + static_cast<size_t>(cy) * m_width + cx;
+            for (size_t k = 0; k < count; ++k) {
+                center[m_brush.offset[k]] -= amount * m_brush.weight[k];
+            }
+            return amount;
+        }
+        float removed = 0.0f;
+        for (size_t k = 0; k < count; ++k) {
+            int32_t x = static_cast<int32_t>(cx) + m_brush.dx[k];
+            int32_t y = static_cast<int32_t>(cy) + m_brush.dy[k];
+            if (x < 0 || y < 0 || x >= static_cast<int32_t>(m_width) || y >= static_cast<int32_t>(m_height)) {
+                continue;
+            }
+            float delta = amount * m_brush.weight[k];
+            m_h[static_cast<size_t>(y) * m_width + x] -= delta;
+            removed += delta;
+        }
+        return removed;
+    }
+
+    float* m_h;
+    uint32_t m_width;
+    uint32_t m_height;
+    const ErosionParams& m_params;
+    const DropletBrush& m_brush;
+};
+
+} // namespace
+
+uint64_t applyDropletErosion(HeightMap& heightmap, uint32_t width, uint32_t height,
+                             const ErosionParams& params, uint32_t seed,
+                             ParallelProcessor& processor) {
+    if (width < 2 || height < 2 || heightmap.size() < static_cast<size_t>(width) * height ||
+        params.dropletLifetime == 0 || params.dropletsPerCell <= 0.0f) {
+        return 0;
+    }
+
+    // 液滴从出发点最多走dropletLifetime格，笔刷和角点沉积再外扩radius+1格
+    const uint32_t reach = params.dropletLifetime + params.dropletRadius + 2;
+    const uint32_t tileSize = std::max(kMinDropletTile, 2 * reach);
+    const uint32_t tilesX = (width + tileSize - 1) / tileSize;
+    const uint32_t tilesY = (height + tileSize - 1) / tileSize;
+
+    std::vector<DropletTile> phases[4];
+    for (uint32_t ty = 0; ty < tilesY; ++ty) {
+        for (uint32_t tx = 0; tx < tilesX; ++tx) {
+            DropletTile tile;
+            tile.x0 = tx * tileSize;
+            tile.y0 = ty * tileSize;
+            tile.x1 = std::min(tile.x0 + tileSize, width - 1);
+            tile.y1 = std::min(tile.y0 + tileSize, height - 1);
+            tile.index = ty * tilesX + tx;
+            if (tile.x0 >= tile.x1 || tile.y0 >= tile.y1) continue;
+            phases[(tx & 1) | ((ty & 1) << 1)].push_back(tile);
+        }
+    }
+
+    const DropletBrush brush = buildBrush(params.dropletRadius, width);
+    const DropletSimulator simulator(heightmap.data(), width, height, params, brush);
+    std::vector<uint64_t> tileDroplets(static_cast<size_t>(tilesX) * tilesY, 0);
+
+    for (uint32_t round = 0; round < kDropletRounds; ++round) {
+        for (const std::vector<DropletTile>& phase : phases) {
+            processor.parallelFor1DChunked(static_cast<uint32_t>(phase.size()), 1,
+                [&](uint32_t start, uint32_t end) {
+                    for (uint32_t t = start; t < end; ++t) {
+                        const DropletTile& tile = phase[t];
+                        const float spanX = static_cast<float>(tile.x1 - tile.x0);
+                        const float spanY = static_cast<float>(tile.y1 - tile.y0);
+                        // 各轮平分图块的液滴数，余数落在前几轮
+                        const double total = params.dropletsPerCell * spanX * spanY;
+                        const uint64_t perRound = static_cast<uint64_t>(total / kDropletRounds);
+                        const uint64_t extra = static_cast<uint64_t>(total) - perRound * kDropletRounds;
+                        const uint64_t count = perRound + (round < extra ? 1 : 0);
+
+                        std::mt19937 rng(Utils::hash(tile.index, round, seed ^ 0x5bd1e995u));
+                        for (uint64_t k = 0; k < count; ++k) {
+                            float x = static_cast<float>(tile.x0) + (rng() >> 8) * (1.0f / 16777216.0f) * spanX;
+                            float y = static_cast<float>(tile.y0) + (rng() >> 8) * (1.0f / 16777216.0f) * spanY;
+                            simulator.simulate(x, y);
+                        }
+                        tileDroplets[tile.index] += count;
+                    }
+                });
+        }
+    }
+
+    uint64_t droplets = 0;
+    for (uint64_t count : tileDroplets) droplets += count;
+    return droplets;
+}
+
+} // namespace internal
+} // namespace MapGenerator
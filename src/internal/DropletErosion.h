@@ -0,0 +1,24 @@
+// src/internal/DropletErosion.h
+#ifndef MAPGENERATOR_INTERNAL_DROPLETEROSION_H
+#define MAPGENERATOR_INTERNAL_DROPLETEROSION_H
+
+#include "CommonTypes.h"
+#include "ParallelUtils.h"
+#include <cstdint>
+
+namespace MapGenerator {
+namespace internal {
+
+// 液滴（粒子）水力侵蚀：每个液滴从随机位置出发，沿双线性插值的坡度带惯性下行，
+// 搬运能力不足时在所在格的四个角点沉积，否则在半径dropletRadius的笔刷内侵蚀，最多走dropletLifetime步。
+// 地图划分为图块，图块按2x2着色分四个阶段处理：同色图块的影响范围（图块外扩液滴的最远行程）互不重叠，
+// 可以并行地直接改写高度图；每个图块每轮的液滴由(seed, 轮次, 图块)确定的随机数流生成并按顺序模拟，
+// 结果与线程数无关。共模拟约dropletsPerCell×格子数个液滴，返回实际模拟的液滴数
+uint64_t applyDropletErosion(HeightMap& heightmap, uint32_t width, uint32_t height,
+                             const ErosionParams& params, uint32_t seed,
+                             ParallelProcessor& processor);
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_DROPLETEROSION_H
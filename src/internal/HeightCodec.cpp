@@ -0,0 +1,195 @@
+// src/internal/HeightCodec.cpp
+#include "HeightCodec.h"
+#include "SimdTarget.h"
+
+namespace MapGenerator {
+namespace internal {
+
+namespace {
+
+void encodeScalar(HeightFormat format, const float* in, uint16_t* out, size_t n) {
+    if (format == HeightFormat::UNORM16) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = encodeUnorm16(in[i]);
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = encodeHalf(in[i]);
+        }
+    }
+}
+
+void decodeScalar(HeightFormat format, const uint16_t* in, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = decodeHeightSample(format, in[i]);
+    }
+}
+
+#if MG_SIMD_X86
+
+// ---- SSE4.1：UNORM16，每次8个 ----
+
+MG_TARGET_SSE41 inline __m128i quantize4(const float* in) {
+    __m128 v = _mm_loadu_ps(in);
+    // maxps在任一操作数为NaN时返回第二个操作数，NaN因此被限制为0
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    v = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(65535.0f)), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(v);
+}
+
+MG_TARGET_SSE41 void encodeUnormSse41(const float* in, uint16_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i packed = _mm_packus_epi32(quantize4(in + i), quantize4(in + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+    encodeScalar(HeightFormat::UNORM16, in + i, out + i, n - i);
+}
+
+MG_TARGET_SSE41 void decodeUnormSse41(const uint16_t* in, float* out, size_t n) {
+    const __m128 scale = _mm_set1_ps(1.0f / 65535.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i low = _mm_cvtepu16_epi32(samples);
+        __m128i high = _mm_cvtepu16_epi32(_mm_srli_si128(samples, 8));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+    decodeScalar(HeightFormat::UNORM16, in + i, out + i, n - i);
+}
+
+// ---- AVX2：UNORM16，每次8个 ----
+
+MG_TARGET_AVX2 void encodeUnormAvx2(const float* in, uint16_t* out, size_t n) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 scale = _mm256_set1_ps(65535.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(in + i);
+        v = _mm256_min_ps(_mm256_max_ps(v, zero), one);
+        __m256i q = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, scale), half));
+        __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(q),
+                                          _mm256_extracti128_si256(q, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+    encodeScalar(HeightFormat::UNORM16, in + i, out + i, n - i);
+}
+
+MG_TARGET_AVX2 void decodeUnormAvx2(const uint16_t* in, float* out, size_t n) {
+    const __m256 scale = _mm256_set1_ps(1.0f / 65535.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(samples));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(v, scale));
+    }
+    decodeScalar(HeightFormat::UNORM16, in + i, out + i, n - i);
+}
+
+// ---- AVX2 + F16C：半精度，每次8个 ----
+
+MG_TARGET_AVX2_F16C void encodeHalfF16c(const float* in, uint16_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i packed = _mm256_cvtps_ph(_mm256_loadu_ps(in + i),
+                                         _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+    encodeScalar(HeightFormat::HALF16, in + i, out + i, n - i);
+}
+
+MG_TARGET_AVX2_F16C void decodeHalfF16c(const uint16_t* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(samples));
+    }
+    decodeScalar(HeightFormat::HALF16, in + i, out + i, n - i);
+}
+
+bool queryF16c() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 1) return false;
+    __cpuid(info, 1);
+    return (info[2] & (1 << 29)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("f16c") != 0;
+#endif
+}
+
+#endif // MG_SIMD_X86
+
+bool hasF16c() {
+#if MG_SIMD_X86
+    static const bool supported = queryF16c();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+SimdLevel clampLevel(SimdLevel level) {
+    SimdLevel supported = detectSimdLevel();
+    return static_cast<int>(level) > static_cast<int>(supported) ? supported : level;
+}
+
+} // namespace
+
+void encodeHeights(SimdLevel level, HeightFormat format, const float* in, uint16_t* out, size_t n) {
+    level = clampLevel(level);
+
+#if MG_SIMD_X86
+    if (format == HeightFormat::HALF16) {
+        if (level == SimdLevel::AVX2 && hasF16c()) {
+            encodeHalfF16c(in, out, n);
+            return;
+        }
+    } else if (level == SimdLevel::AVX2) {
+        encodeUnormAvx2(in, out, n);
+        return;
+    } else if (level == SimdLevel::SSE41) {
+        encodeUnormSse41(in, out, n);
+        return;
+    }
+#endif
+
+    encodeScalar(format, in, out, n);
+}
+
+void decodeHeights(SimdLevel level, HeightFormat format, const uint16_t* in, float* out, size_t n) {
+    level = clampLevel(level);
+
+#if MG_SIMD_X86
+    if (format == HeightFormat::HALF16) {
+        if (level == SimdLevel::AVX2 && hasF16c()) {
+            decodeHalfF16c(in, out, n);
+            return;
+        }
+    } else if (level == SimdLevel::AVX2) {
+        decodeUnormAvx2(in, out, n);
+        return;
+    } else if (level == SimdLevel::SSE41) {
+        decodeUnormSse41(in, out, n);
+        return;
+    }
+#endif
+
+    decodeScalar(format, in, out, n);
+}
+
+void encodeHeights(HeightFormat format, const float* in, uint16_t* out, size_t n) {
+    encodeHeights(detectSimdLevel(), format, in, out, n);
+}
+
+void decodeHeights(HeightFormat format, const uint16_t* in, float* out, size_t n) {
+    decodeHeights(detectSimdLevel(), format, in, out, n);
+}
+
+} // namespace internal
+} // namespace MapGenerator
@@ -0,0 +1,77 @@
+// src/internal/HeightCodec.h
+#ifndef MAPGENERATOR_INTERNAL_HEIGHTCODEC_H
+#define MAPGENERATOR_INTERNAL_HEIGHTCODEC_H
+
+#include "CommonTypes.h"
+#include "NoiseKernels.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace MapGenerator {
+namespace internal {
+
+// 单值编码：UNORM16先限制到[0,1]（NaN视为0）再四舍五入；
+// HALF16按IEEE 754就近舍入到偶数，与F16C指令结果一致
+inline uint16_t encodeUnorm16(float value) {
+    value = value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+    return static_cast<uint16_t>(static_cast<uint32_t>(value * 65535.0f + 0.5f));
+}
+
+inline uint16_t encodeHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t absBits = bits & 0x7FFFFFFFu;
+
+    if (absBits >= 0x7F800000u) {
+        // 无穷大保持不变，NaN转为安静NaN并保留高位尾数
+        uint32_t nan = absBits > 0x7F800000u ? (0x200u | ((absBits >> 13) & 0x3FFu)) : 0u;
+        return static_cast<uint16_t>(sign | 0x7C00u | nan);
+    }
+    if (absBits >= 0x477FF000u) {
+        // 不小于65520时舍入为无穷大
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+    if (absBits < 0x38800000u) {
+        // 小于2^-14：以2^-24为单位的非规格化数
+        uint32_t exponent = absBits >> 23;
+        uint32_t shift = 126 - exponent;
+        if (shift > 24) {
+            return static_cast<uint16_t>(sign);
+        }
+        uint32_t mantissa = (absBits & 0x7FFFFFu) | 0x800000u;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t midpoint = 1u << (shift - 1);
+        if (rest > midpoint || (rest == midpoint && (half & 1))) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (absBits - 0x38000000u) >> 13;
+    uint32_t rest = absBits & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1))) {
+        ++half;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+inline uint16_t encodeHeightSample(HeightFormat format, float value) {
+    return format == HeightFormat::UNORM16 ? encodeUnorm16(value) : encodeHalf(value);
+}
+
+// 批量编码/解码，按检测到的指令集分派，结果与单值版本逐位一致
+// format必须是UNORM16或HALF16
+void encodeHeights(HeightFormat format, const float* in, uint16_t* out, size_t n);
+void decodeHeights(HeightFormat format, const uint16_t* in, float* out, size_t n);
+
+// 指定指令集级别的版本，半精度的SIMD路径另需CPU支持F16C
+void encodeHeights(SimdLevel level, HeightFormat format, const float* in, uint16_t* out, size_t n);
+void decodeHeights(SimdLevel level, HeightFormat format, const uint16_t* in, float* out, size_t n);
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_HEIGHTCODEC_H
@@ -0,0 +1,201 @@
+// src/internal/Hydrology.cpp
+#include "Hydrology.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace MapGenerator {
+namespace internal {
+
+namespace {
+
+// 尚未到达的格子
+constexpr uint8_t kUnvisited = 0xFE;
+
+// 二进制位数：0为0，否则为最高置位的位置加1
+inline size_t bitWidth(uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    return _BitScanReverse64(&index, value) ? static_cast<size_t>(index) + 1 : 0;
+#else
+    return value ? 64 - static_cast<size_t>(__builtin_clzll(value)) : 0;
+#endif
+}
+
+// 堆元素：高位为高度的可排序编码，低位为下标，按整数比较即先比高度、高度相同再比下标，
+// 保证扩展顺序唯一
+inline uint64_t floodKey(float height, uint32_t index) {
+    uint32_t bits;
+    std::memcpy(&bits, &height, sizeof(bits));
+    // 负数取反、非负数置符号位，编码后的无符号序与浮点序一致
+    bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    return (static_cast<uint64_t>(bits) << 32) | index;
+}
+
+// 单调优先队列（基数堆）：填洼过程中出队的键单调不减，新入队的键不小于上次出队的键。
+// 键按与上次出队键的最高不同位分桶，入队O(1)，出队均摊O(键位数)，比二叉堆少大量比较与搬移
+class RadixHeap {
+public:
+    bool empty() const { return m_size == 0; }
+
+    void push(uint64_t key) {
+        m_buckets[bucketOf(key)].push_back(key);
+        ++m_size;
+    }
+
+    uint64_t pop() {
+        if (m_buckets[0].empty()) {
+            size_t i = 1;
+            while (m_buckets[i].empty()) ++i;
+            // 桶内最小键成为新的基准，其余键按新基准重新分到更低的桶
+            m_last = *std::min_element(m_buckets[i].begin(), m_buckets[i].end());
+            for (uint64_t key : m_buckets[i]) {
+                m_buckets[bucketOf(key)].push_back(key);
+            }
+            m_buckets[i].clear();
+        }
+        uint64_t key = m_buckets[0].back();
+        m_buckets[0].pop_back();
+        --m_size;
+        return key;
+    }
+
+private:
+    size_t bucketOf(uint64_t key) const {
+        return bitWidth(key ^ m_last);
+    }
+
+    std::vector<uint64_t> m_buckets[65];
+    uint64_t m_last = 0;
+    size_t m_size = 0;
+};
+
+} // namespace
+
+bool computeFlowField(const HeightMap& heights, uint32_t width, uint32_t height,
+                      float seaLevel, ScratchPool& scratch, FlowField& field) {
+    const size_t count = static_cast<size_t>(width) * height;
+    if (count == 0 || heights.size() < count) {
+        return false;
+    }
+
+    field.width = width;
+    field.height = height;
+    field.filled = scratch.acquireUninitialized<float>(count);
+    std::copy(heights.begin(), heights.begin() + count, field.filled.begin());
+    field.receiver = scratch.acquire<uint8_t>(count, kUnvisited);
+    field.accumulation = scratch.acquire<uint32_t>(count, 1u);
+    field.spill = scratch.acquire<uint32_t>(count, kNoSpill);
+    field.depressions = 0;
+    std::vector<uint32_t> order = scratch.acquireUninitialized<uint32_t>(count);
+    size_t orderSize = 0;
+
+    HeightMap& filled = field.filled;
+    std::vector<uint8_t>& receiver = field.receiver;
+    std::vector<uint32_t>& spill = field.spill;
+
+    // 种子：地图边界和海面以下的格子，它们是汇。陆地格都不低于海面，
+    // 所以海面以下的格子不必进堆，按下标顺序放进FIFO队列最先处理，堆里只有陆地的前沿
+    RadixHeap open;
+    std::vector<uint32_t> pit;
+    size_t pitHead = 0;
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t idx = y * width + x;
+            bool border = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+            if (filled[idx] < seaLevel) {
+                receiver[idx] = kNoReceiver;
+                pit.push_back(idx);
+            } else if (border) {
+                receiver[idx] = kNoReceiver;
+                open.push(floodKey(filled[idx], idx));
+            }
+        }
+    }
+
+    int64_t offsets[8];
+    for (uint8_t d = 0; d < 8; ++d) {
+        offsets[d] = static_cast<int64_t>(kD8Dy[d]) * width + kD8Dx[d];
+    }
+
+    // FIFO队列中的格子（海面以下的种子、被抬升到当前水位的洼地格）先于堆中的格子处理
+    while (true) {
+        uint32_t current;
+        if (pitHead < pit.size()) {
+            current = pit[pitHead++];
+        } else {
+            pit.clear();
+            pitHead = 0;
+            if (open.empty()) break;
+            current = static_cast<uint32_t>(open.pop());
+        }
+        order[orderSize++] = current;
+
+        const float level = filled[current];
+        // 洼地内的格子沿用所属洼地的溢出口，其余格子漫入的新洼地以该格为溢出口
+        const uint32_t outlet = spill[current] != kNoSpill ? spill[current] : current;
+        bool opensDepression = false;
+        auto visit = [&](uint32_t neighbor, uint8_t d) {
+            if (receiver[neighbor] != kUnvisited) return;
+
+            // 邻居流向当前格
+            receiver[neighbor] = static_cast<uint8_t>((d + 4) & 7);
+            if (filled[neighbor] <= level) {
+                filled[neighbor] = level;
+                spill[neighbor] = outlet;
+                opensDepression = opensDepression || outlet == current;
+                pit.push_back(neighbor);
+            } else {
+                open.push(floodKey(filled[neighbor], neighbor));
+            }
+        };
+
+        const uint32_t cy = current / width;
+        const uint32_t cx = current - cy * width;
+        if (cx > 0 && cy > 0 && cx + 1 < width && cy + 1 < height) {
+            // 内部格的8个邻居都在图内
+            for (uint8_t d = 0; d < 8; ++d) {
+                visit(static_cast<uint32_t>(static_cast<int64_t>(current) + offsets[d]), d);
+            }
+        } else {
+            for (uint8_t d = 0; d < 8; ++d) {
+                int64_t nx = static_cast<int64_t>(cx) + kD8Dx[d];
+                int64_t ny = static_cast<int64_t>(cy) + kD8Dy[d];
+                if (nx >= 0 && ny >= 0 && nx < width && ny < height) {
+                    visit(static_cast<uint32_t>(ny * width + nx), d);
+                }
+            }
+        }
+        field.depressions += opensDepression ? 1 : 0;
+    }
+
+    // 下游格总是先于上游格出队，逆序遍历即可把汇流量逐级传到下游
+    std::vector<uint32_t>& accumulation = field.accumulation;
+    for (size_t k = orderSize; k-- > 0;) {
+        uint32_t idx = order[k];
+        uint8_t dir = receiver[idx];
+        if (dir == kNoReceiver) continue;
+        uint32_t target = static_cast<uint32_t>(static_cast<int64_t>(idx) +
+                                                static_cast<int64_t>(kD8Dy[dir]) * width + kD8Dx[dir]);
+        accumulation[target] += accumulation[idx];
+    }
+
+    scratch.release(std::move(order));
+    return true;
+}
+
+void releaseFlowField(ScratchPool& scratch, FlowField& field) {
+    scratch.release(std::move(field.filled));
+    scratch.release(std::move(field.receiver));
+    scratch.release(std::move(field.accumulation));
+    scratch.release(std::move(field.spill));
+    field.width = 0;
+    field.height = 0;
+    field.depressions = 0;
+}
+
+} // namespace internal
+} // namespace MapGenerator
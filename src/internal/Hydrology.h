@@ -0,0 +1,53 @@
+// src/internal/Hydrology.h
+#ifndef MAPGENERATOR_INTERNAL_HYDROLOGY_H
+#define MAPGENERATOR_INTERNAL_HYDROLOGY_H
+
+#include "CommonTypes.h"
+#include "ScratchPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MapGenerator {
+namespace internal {
+
+// D8流向：receiver取0..7时为下游邻居的方向编号，汇（地图边界、海面以下）为kNoReceiver
+constexpr uint8_t kNoReceiver = 0xFF;
+// 不在洼地内的格子的溢出口编号
+constexpr uint32_t kNoSpill = 0xFFFFFFFFu;
+constexpr int32_t kD8Dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+constexpr int32_t kD8Dy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+// 全图汇流场，各缓冲区取自ScratchPool，用完由releaseFlowField归还
+struct FlowField {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    // 填洼后的高度：洼地被抬升到溢出口高度，其余格子不变
+    HeightMap filled;
+    std::vector<uint8_t> receiver;
+    // 汇流累积量：流经该格的上游格子数（含自身）
+    std::vector<uint32_t> accumulation;
+    // 洼地内的格子所属洼地的溢出口下标，同一洼地的格子取值相同
+    std::vector<uint32_t> spill;
+    // 洼地数
+    uint32_t depressions = 0;
+
+    size_t bytes() const {
+        return filled.capacity() * sizeof(float) + receiver.capacity() +
+               (accumulation.capacity() + spill.capacity()) * sizeof(uint32_t);
+    }
+};
+
+// 优先队列填洼（priority-flood，洼地内的格子走FIFO队列不进堆）：
+// 从地图边界和海面以下的格子出发按填洼高度由低到高扩展，每个格子的下游即首次到达它的邻居，
+// 因此所有陆地格都沿D8流向排到海洋或边界；再按扩展顺序逆序累加得到汇流量。
+// 堆按(高度, 下标)排序，结果与线程数无关。复杂度O(n log n)，尺寸为0时返回false
+bool computeFlowField(const HeightMap& heights, uint32_t width, uint32_t height,
+                      float seaLevel, ScratchPool& scratch, FlowField& field);
+
+void releaseFlowField(ScratchPool& scratch, FlowField& field);
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_HYDROLOGY_H
@@ -2,7 +2,15 @@
 #include "MapGeneratorInternal.h"
 #include "ParallelUtils.h"
 #include "NoiseGenerator.h"
-#include "ThreadPool.h"
+#include "ScratchPool.h"
+#include "HeightCodec.h"
+#include "ResultCache.h"
+#include "StageCache.h"
+#include "Profiler.h"
+#include "Hydrology.h"
+#include "PipeErosion.h"
+#include "DropletErosion.h"
+#include "ThermalErosion.h"
 #include <algorithm>
 #include <chrono>
 #include <memory>
@@ -12,6 +20,9 @@
 #include <cmath>
 #include <queue>
 #include <stack>
+#include <tuple>
+#include <list>
+#include <mutex>
 
 namespace MapGenerator {
 namespace internal {
@@ -24,102 +35,373 @@ struct RiverPoint {
     uint32_t depth; // 递归深度
 };
 
+// 单个湖泊的外接框栅格：坐标与所在地图一致，框外视为无湖泊
+struct LakeRaster {
+    int32_t x0 = 0;
+    int32_t y0 = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> tiles;
+
+    uint8_t at(int32_t x, int32_t y) const {
+        return tiles[static_cast<size_t>(y - y0) * width + (x - x0)];
+    }
+};
+
 class MapGeneratorInternal::Impl {
 private:
-    std::mt19937 m_rng;
-    uint32_t m_seed;
-    std::unique_ptr<NoiseGenerator> m_noiseGen;
-    std::unique_ptr<ThreadPool> m_threadPool;
-    std::unique_ptr<ParallelProcessor> m_parallelProcessor;
-
-    // 缓存
-    std::unordered_map<uint64_t, std::shared_ptr<MapData>> m_cache;
+    // 按种子缓存的噪声生成器数量上限（LRU淘汰）
+    static constexpr size_t kMaxNoiseGenerators = 8;
+    // 气候噪声批量采样的块长度
+    static constexpr uint32_t kClimateBatchSize = 256;
+    // 气候场采样点间隔（格）：气候噪声最细的一层周期约50格，8格插值的误差远小于噪声幅度
+    static constexpr uint32_t kClimateCellSize = 8;
+    // 每个任务生成的气候场行数
+    static constexpr uint32_t kClimateRowsPerTask = 4;
+    // 高度对温度、湿度的影响：每单位高度的减少量
+    static constexpr float kTemperatureLapse = 0.3f;
+    static constexpr float kMoistureLapse = 0.2f;
+    // 河流、湖泊临时栅格中表示"无"的取值
+    static constexpr uint8_t kNoTile = 0xFF;
+    // 每个格子的河流源点密度
+    static constexpr float kRiverDensity = 0.0005f;
+    // 每个格子的湖泊密度上限
+    static constexpr float kLakeDensity = 0.0001f;
+    // 整图湖泊合并时每个任务负责的行数
+    static constexpr uint32_t kLakeMergeRows = 64;
+    // 分块生成：河流的影响半径（河长上限加支流偏移），河流源点与湖心的选取单元边长（约1/sqrt(密度)）
+    static constexpr uint32_t kChunkFeatureHalo = 128;
+    static constexpr uint32_t kChunkRiverCellSize = 45;
+    static constexpr uint32_t kChunkLakeCellSize = 100;
+    static constexpr uint32_t kChunkSmoothingRadius = 1;
+    // 整图高度平滑半径
+    static constexpr uint32_t kSmoothingRadius = 1;
+    // 批量生成时每个线程至少分到的像素数，用于决定地图级与图内并行的比例
+    static constexpr size_t kBatchPixelsPerThread = 256 * 256;
+    // 每个中间阶段最多保留的结果数（整图大小的缓冲区），另受字节预算限制
+    static constexpr size_t kStageCacheEntries = 2;
+
+    // 当前线程数对应的并行处理器，只在m_engineMutex内读写；各次生成使用prepare返回的快照
+    std::shared_ptr<ParallelProcessor> m_parallelProcessor;
+    // 噪声生成器按种子缓存，只缓存绑定当前并行处理器的生成器
+    struct NoiseGenEntry {
+        uint32_t seed;
+        std::shared_ptr<ParallelProcessor> processor;
+        std::shared_ptr<NoiseGenerator> generator;
+    };
+    std::list<NoiseGenEntry> m_noiseGens;
+    // 临时缓冲区池，与各噪声生成器共享
+    std::shared_ptr<ScratchPool> m_scratch = std::make_shared<ScratchPool>();
+    std::mutex m_engineMutex;
+
+    // 结果缓存，自带分片锁，不经过m_engineMutex
+    ResultCache m_cache;
+    
+    // 地形分类阶段的输出：按compactTiles只填充其中一个
+    struct TerrainLayers {
+        TileMap terrainMap;
+        CompactTileMap terrainTiles;
+        ClimateField temperature;
+        ClimateField moisture;
+    };
+    
+    // 阶段缓存：只改下游参数（海平面、高度阈值等）时跳过噪声、侵蚀和平滑，
+    // 只改存储格式时再跳过地形分类和水系。两者与结果缓存共用字节预算，结果缓存优先，
+    // 各阶段最多使用结果缓存剩余预算的一半
+    StageCache<HeightMap, ReliefInputs, sameReliefInputs> m_reliefStage{kStageCacheEntries};
+    StageCache<TerrainLayers, MapConfig, sameMapConfig> m_terrainStage{kStageCacheEntries};
+    
+    static size_t terrainLayerBytes(const TerrainLayers& layers) {
+        return layers.terrainMap.capacity() * sizeof(uint32_t) + layers.terrainTiles.capacity() +
+               (layers.temperature.values.capacity() + layers.moisture.values.capacity()) * sizeof(float);
+    }
     
 public:
     Impl(uint32_t seed) 
-        : m_seed(seed), m_rng(seed),
-          m_noiseGen(std::make_unique<NoiseGenerator>(seed)),
-          m_threadPool(std::make_unique<ThreadPool>(std::thread::hardware_concurrency())) {
+        : m_parallelProcessor(std::make_shared<ParallelProcessor>(std::thread::hardware_concurrency())) {
+        // 预热构造时指定种子的噪声表
+        noiseGenerator(seed, m_parallelProcessor);
+    }
+    
+    // 准备常驻资源：线程数变化时才重建并行处理器。返回值是本次生成的处理器快照，
+    // 各阶段都只用它；之后其他调用替换成员不影响已在运行的生成
+    std::shared_ptr<ParallelProcessor> prepare(const MapConfig& config) {
+        uint32_t threadCount = std::max(1u, config.threadCount);
+        std::lock_guard<std::mutex> lock(m_engineMutex);
+        if (m_parallelProcessor->getThreadCount() != threadCount) {
+            m_parallelProcessor = std::make_shared<ParallelProcessor>(threadCount);
+            // 绑定旧处理器的噪声生成器不再分配出去，仍在使用它们的生成各自持有引用
+            m_noiseGens.remove_if([&](const NoiseGenEntry& entry) {
+                return entry.processor != m_parallelProcessor;
+            });
+        }
+        return m_parallelProcessor;
+    }
+    
+    // 获取指定种子、绑定processor的噪声生成器，排列表只在首次使用时构建；
+    // processor已被替换时临时创建，不进入缓存
+    std::shared_ptr<NoiseGenerator> noiseGenerator(uint32_t seed,
+                                                   const std::shared_ptr<ParallelProcessor>& processor) {
+        std::lock_guard<std::mutex> lock(m_engineMutex);
+        for (auto it = m_noiseGens.begin(); it != m_noiseGens.end(); ++it) {
+            if (it->seed == seed && it->processor == processor) {
+                m_noiseGens.splice(m_noiseGens.begin(), m_noiseGens, it);
+                return it->generator;
+            }
+        }
+        
+        auto noiseGen = std::make_shared<NoiseGenerator>(seed, processor, m_scratch);
+        if (processor == m_parallelProcessor) {
+            m_noiseGens.push_front({seed, processor, noiseGen});
+            if (m_noiseGens.size() > kMaxNoiseGenerators) {
+                m_noiseGens.pop_back();
+            }
+        }
+        return noiseGen;
     }
     
     std::shared_ptr<MapData> generate(const MapConfig& config) {
+        return generatePrepared(config, prepare(config));
+    }
+    
+    // 用prepare取得的并行处理器生成，整张图的各阶段都在这一个处理器上运行，
+    // 批量调度在分发前统一准备一次；cacheResults为假时结果不写入缓存，
+    // cacheStages为假时中间阶段既不查找也不写入（批量地图种子各不相同，阶段缓存不会命中）
+    std::shared_ptr<MapData> generatePrepared(const MapConfig& config,
+                                              const std::shared_ptr<ParallelProcessor>& processor,
+                                              bool cacheResults = true, bool cacheStages = true) {
         // 检查缓存
-        uint64_t cacheKey = computeCacheKey(config);
-        auto it = m_cache.find(cacheKey);
-        if (it != m_cache.end()) {
-            return it->second;
-        }
-
-        if (config.threadCount > 0) {
-            m_parallelProcessor = std::make_unique<ParallelProcessor>(config.threadCount);
+        uint64_t cacheKey = hashMapConfig(config);
+        if (auto cached = m_cache.find(cacheKey, config)) {
+            return cached;
         }
         
         auto startTime = std::chrono::high_resolution_clock::now();
         
         auto data = std::make_shared<MapData>();
         data->config = config;
+        MapProfile* profile = &data->profile;
         
-        // 步骤1: 生成高度图
-        data->heightMap = generateHeightmapOnly(config);
-        
-        // 步骤2: 应用侵蚀
-        ErosionParams erosionParams;
-        erosionParams.iterations = 5;
-        erosionParams.thermalErosion = true;
-        erosionParams.hydraulicErosion = true;
-        erosionParams.talusAngle = 35.0f;
-
-        applyErosion(data->heightMap, config, erosionParams);
-
-        // 步骤3: 平滑高度图
-        m_noiseGen->applySmoothing(data->heightMap, config.width, config.height, 1);
-
-        // 步骤4: 生成地形图
-        data->terrainMap = generateTerrainOnly(data->heightMap, config);
-
-        // 步骤5: 生成河流
-        RiverParams riverParams;
-        riverParams.count = static_cast<uint32_t>(config.width * config.height * 0.0005f);
-        riverParams.minSourceHeight = 0.6f;
-        riverParams.maxSourceHeight = 0.9f;
+        // 步骤1-3: 生成高度图、侵蚀、平滑；各阶段输入指纹不变时复用缓存的结果
+        ReliefInputs reliefInputs = reliefStageInputs(config);
+        uint64_t reliefKey = hashReliefInputs(reliefInputs);
+        std::shared_ptr<const HeightMap> relief =
+            cacheStages ? m_reliefStage.find(reliefKey, reliefInputs) : nullptr;
+        if (relief) {
+            data->heightMap = *relief;
+            markStageCached(profile, GenerationStage::NOISE);
+            markStageCached(profile, GenerationStage::EROSION);
+            markStageCached(profile, GenerationStage::SMOOTHING);
+        } else {
+            HeightMap heights = generateHeightmapOnly(config, processor, profile);
+            applyErosion(heights, config, reliefInputs.erosion, *processor, profile);
+            {
+                StageTimer timer(profile, GenerationStage::SMOOTHING, processor->getThreadCount());
+                noiseGenerator(config.seed, processor)->applySmoothing(heights, config.width, config.height,
+                                                                       kSmoothingRadius);
+            }
+            if (cacheStages) {
+                relief = std::make_shared<const HeightMap>(std::move(heights));
+                m_reliefStage.insert(reliefKey, reliefInputs, relief,
+                                     relief->capacity() * sizeof(float), stageBudget());
+                data->heightMap = *relief;
+            } else {
+                data->heightMap = std::move(heights);
+            }
+        }
 
-        generateRivers(data->terrainMap, data->heightMap, config, riverParams);
+        // 步骤4、5: 生成地形图和河流，输入为高度和除存储格式外的全部配置；
+        // 河流与湖泊按位置播种，结果与线程数无关，hashMapConfig不含线程数
+        MapConfig terrainConfig = config;
+        terrainConfig.heightFormat = HeightFormat::FLOAT32;
+        uint64_t terrainKey = combineFingerprint(reliefKey, hashMapConfig(terrainConfig));
+        std::shared_ptr<const TerrainLayers> terrain =
+            cacheStages ? m_terrainStage.find(terrainKey, terrainConfig) : nullptr;
+        if (terrain) {
+            data->terrainMap = terrain->terrainMap;
+            data->terrainTiles = terrain->terrainTiles;
+            data->temperature = terrain->temperature;
+            data->moisture = terrain->moisture;
+            markStageCached(profile, GenerationStage::TERRAIN);
+            markStageCached(profile, GenerationStage::RIVERS);
+            markStageCached(profile, GenerationStage::LAKES);
+        } else {
+            if (config.compactTiles) {
+                generateTerrainLayer(data->terrainTiles, *data, config, processor, profile);
+            } else {
+                generateTerrainLayer(data->terrainMap, *data, config, processor, profile);
+            }
+            if (cacheStages) {
+                auto layers = std::make_shared<TerrainLayers>();
+                layers->terrainMap = data->terrainMap;
+                layers->terrainTiles = data->terrainTiles;
+                layers->temperature = data->temperature;
+                layers->moisture = data->moisture;
+                m_terrainStage.insert(terrainKey, terrainConfig, layers,
+                                      terrainLayerBytes(*layers), stageBudget());
+            }
+        }
+        
+        // 步骤6: 按配置的格式保存高度，统计和导出读取保存后的数据
+        storeHeights(*data, *processor);
         
-        // 步骤6: 计算统计信息
-        calculateStatistics(*data);
+        // 步骤7: 计算统计信息
+        calculateStatistics(*data, *processor);
         
         auto endTime = std::chrono::high_resolution_clock::now();
         data->generationTimeMs = std::chrono::duration_cast<
             std::chrono::milliseconds>(endTime - startTime).count();
         
         // 缓存结果
-        m_cache[cacheKey] = data;
+        if (cacheResults) {
+            m_cache.insert(cacheKey, config, data);
+            trimStageCaches();
+        }
         
         return data;
     }
     
+    ResultCache& resultCache() { return m_cache; }
+    
+    // 结果缓存未用的预算由两个阶段缓存平分
+    size_t stageBudget() const {
+        size_t budget = m_cache.byteBudget();
+        size_t used = m_cache.bytes();
+        return used < budget ? (budget - used) / 2 : 0;
+    }
+    
+    void trimStageCaches() {
+        size_t budget = stageBudget();
+        m_reliefStage.trim(budget);
+        m_terrainStage.trim(budget);
+    }
+    
+    MapCacheStats cacheStats() const {
+        MapCacheStats stats = m_cache.stats();
+        stats.stageEntries = m_reliefStage.entries() + m_terrainStage.entries();
+        stats.stageBytes = m_reliefStage.bytes() + m_terrainStage.bytes();
+        return stats;
+    }
+    
+    void setCacheBudget(size_t bytes) {
+        m_cache.setByteBudget(bytes);
+        trimStageCaches();
+    }
+    ScratchPool& scratchPool() { return *m_scratch; }
+    
+    void clearCaches() {
+        m_cache.clear();
+        m_reliefStage.clear();
+        m_terrainStage.clear();
+        m_scratch->clear();
+    }
+    
+    // 起伏阶段（噪声→侵蚀→平滑）的输入：按实际生效的噪声参数记录，
+    // 因此只改变湿度等不影响噪声参数的取值时仍可复用；各步结果与线程数无关，线程数不参与
+    ReliefInputs reliefStageInputs(const MapConfig& config) {
+        ReliefInputs inputs;
+        inputs.seed = config.seed;
+        inputs.width = config.width;
+        inputs.height = config.height;
+        inputs.noise = createHeightNoiseParams(config);
+        inputs.erosion = createErosionParams(config);
+        inputs.smoothingRadius = kSmoothingRadius;
+        return inputs;
+    }
+    
+    // 批量生成：所有地图共享引擎的并行处理器，结果全部保留并写入缓存
     std::vector<std::shared_ptr<MapData>> generateBatch(
         const MapConfig& baseConfig, uint32_t count) {
         std::vector<std::shared_ptr<MapData>> results(count);
-        std::vector<std::future<std::shared_ptr<MapData>>> futures;
+        generateBatchStreaming(baseConfig, count,
+            [&](uint32_t index, std::shared_ptr<MapData> data) {
+                results[index] = std::move(data);
+                return true;
+            }, 0, true);
+        return results;
+    }
+    
+    // 流式批量生成：maxInFlight条通道各自领取下一张地图，生成完即在锁内交付，
+    // 通道不保留已交付的地图，因此同时驻留的地图数不超过通道数
+    uint32_t generateBatchStreaming(const MapConfig& baseConfig, uint32_t count,
+                                    const MapReadyCallback& onMapReady, uint32_t maxInFlight,
+                                    bool cacheResults = false) {
+        if (count == 0 || !onMapReady) return 0;
         
-        for (uint32_t i = 0; i < count; i++) {
-            MapConfig config = baseConfig;
-            config.seed = baseConfig.seed + i;
-            
-            futures.push_back(m_threadPool->enqueueTask([this, config]() {
-                return this->generate(config);
-            }));
-        }
+        std::shared_ptr<ParallelProcessor> processor = prepare(baseConfig);
+        uint32_t lanes = maxInFlight > 0 ? std::min(maxInFlight, count)
+                                         : batchConcurrency(baseConfig, count, *processor);
+        
+        std::atomic<uint32_t> nextMap{0};
+        std::atomic<bool> stopped{false};
+        std::mutex callbackMutex;
+        uint32_t delivered = 0;
+        
+        auto runLane = [&]() {
+            while (!stopped.load(std::memory_order_acquire)) {
+                uint32_t i = nextMap.fetch_add(1, std::memory_order_relaxed);
+                if (i >= count) break;
+                
+                MapConfig config = baseConfig;
+                config.seed = baseConfig.seed + i;
+                std::shared_ptr<MapData> data = generatePrepared(config, processor, cacheResults, false);
+                
+                std::lock_guard<std::mutex> lock(callbackMutex);
+                if (stopped.load(std::memory_order_relaxed)) break;
+                ++delivered;
+                if (!onMapReady(i, std::move(data))) {
+                    stopped.store(true, std::memory_order_release);
+                }
+            }
+        };
         
-        for (uint32_t i = 0; i < count; i++) {
-            results[i] = futures[i].get();
+        if (lanes <= 1) {
+            // 逐张生成，每张图使用全部线程
+            runLane();
+        } else {
+            // 通道与图内循环在同一组工作线程上调度，空闲线程窃取任一地图的分块
+            processor->parallelFor1DChunked(lanes, 1,
+                [&](uint32_t, uint32_t) { runLane(); });
         }
         
-        return results;
+        return delivered;
     }
     
-    HeightMap generateHeightmapOnly(const MapConfig& config) {
+    // 同时生成的地图数：按地图大小估算图内能用满的线程数，剩余的并行度分给多张地图，
+    // 总线程数不超过并行处理器的线程数
+    uint32_t batchConcurrency(const MapConfig& config, uint32_t count, ParallelProcessor& processor) {
+        const uint32_t budget = processor.getThreadCount();
+        size_t pixels = static_cast<size_t>(config.width) * config.height;
+        uint32_t threadsPerMap = static_cast<uint32_t>(
+            std::clamp<size_t>(pixels / kBatchPixelsPerThread, 1, budget));
+        return std::clamp(budget / threadsPerMap, 1u, count);
+    }
+    
+    HeightMap generateHeightmapOnly(const MapConfig& config,
+                                    const std::shared_ptr<ParallelProcessor>& processor,
+                                    MapProfile* profile = nullptr) {
+        StageTimer timer(profile, GenerationStage::NOISE, processor->getThreadCount());
+        NoiseParams noiseParams = createHeightNoiseParams(config);
+        
+        // 并行生成高度图
+        HeightMap heightmap(config.width * config.height);
+        addStageBytes(profile, GenerationStage::NOISE, heightmap.size() * sizeof(float));
+        
+        // 根据地图大小决定是否使用并行
+        std::shared_ptr<NoiseGenerator> noiseGen = noiseGenerator(config.seed, processor);
+        if (config.width * config.height >= 256 * 256 && config.threadCount > 1) {
+            // 并行生成噪声
+            generateNoiseParallel(*noiseGen, heightmap, config.width, config.height, noiseParams);
+        } else {
+            // 小地图串行生成
+            heightmap = noiseGen->generateHeightMap(config.width, config.height, noiseParams);
+        }
+        
+        return heightmap;
+    }
+
+    // 高度场噪声参数：配置、预设对应的噪声类型和气候影响
+    NoiseParams createHeightNoiseParams(const MapConfig& config) {
         NoiseParams noiseParams = createNoiseParamsFromConfig(config);
         
         // 根据预设选择噪声类型
@@ -127,19 +409,19 @@ public:
             case MapConfig::Preset::MOUNTAINS:
             case MapConfig::Preset::ALPINE:
                 noiseParams.ridgeWeight = 2.0f;  // 增加山脊效果
-                noiseParams.type = NoiseType::PERLIN;  // 基础噪声类型还是Perlin
+                noiseParams.type = NoiseType::PERLIN_2D;  // 基础噪声类型还是Perlin
                 break;
             case MapConfig::Preset::DESERT_CANYONS:
                 // 使用梯田噪声处理
                 noiseParams.terraceLevels = 8.0f;  // 设置梯田级别
-                noiseParams.type = NoiseType::PERLIN;
+                noiseParams.type = NoiseType::PERLIN_2D;
                 break;
             case MapConfig::Preset::ARCHIPELAGO:
                 // 使用细胞噪声
                 noiseParams.type = NoiseType::WORLEY;
                 break;
             default:
-                noiseParams.type = NoiseType::PERLIN;
+                noiseParams.type = NoiseType::PERLIN_2D;
                 break;
         }
         
@@ -147,258 +429,197 @@ public:
         applyClimateEffects(noiseParams, config.climate, 
                            config.temperature, config.humidity);
         
-        // 并行生成高度图
-        HeightMap heightmap(config.width * config.height);
-        
-        // 根据地图大小决定是否使用并行
-        if (config.width * config.height >= 256 * 256 && config.threadCount > 1) {
-            // 并行生成噪声
-            generateNoiseParallel(heightmap, config.width, config.height, noiseParams);
-        } else {
-            // 小地图串行生成
-            heightmap = m_noiseGen->generateHeightMap(config.width, config.height, noiseParams);
-        }
-        
-        return heightmap;
+        return noiseParams;
     }
 
     // 并行生成噪声
-    void generateNoiseParallel(HeightMap& heightmap, uint32_t width, uint32_t height,
-                              const NoiseParams& params) {
-        heightmap = m_noiseGen->generateNoise(width, height, params);
+    void generateNoiseParallel(NoiseGenerator& noiseGen, HeightMap& heightmap,
+                              uint32_t width, uint32_t height, const NoiseParams& params) {
+        heightmap = noiseGen.generateNoise(width, height, params);
     }
 
-    // 优化地形生成
-    TileMap generateTerrainOnly(const HeightMap& heightmap, const MapConfig& config) {
-        TileMap terrainMap(heightmap.size());
-        
-        // 创建生物群落参数（线程安全）
-        BiomeParams biomeParams = createBiomeParams(config);
-        
-        // 并行处理每个像素
-        m_parallelProcessor->processHeightMapParallel(heightmap, config.width, config.height,
-            [&](uint32_t x, uint32_t y, float height) {
-                uint32_t idx = y * config.width + x;
-                
-                // 计算生物群落参数（并行安全）
-                float temperature = calculateTemperature(x, y, config, height, biomeParams);
-                float moisture = calculateMoisture(x, y, config, height, biomeParams);
-                
-                // 确定地形类型
-                TerrainType terrain = determineTerrainType(height, temperature, moisture, config);
-                terrainMap[idx] = static_cast<uint32_t>(terrain);
-            });
-        
+    // 优化地形生成，TileT为图块存储类型（32位或紧凑的8位）
+    template<typename TileT>
+    std::vector<TileT> generateTerrainOnly(const HeightMap& heightmap, const MapConfig& config,
+                                           const std::shared_ptr<ParallelProcessor>& processor) {
+        std::vector<TileT> terrainMap(heightmap.size());
+        ClimateField temperature;
+        ClimateField moisture;
+        generateClimateFields(0, 0, config.width, config.height, config, temperature, moisture, processor);
+        classifyTerrain(heightmap.data(), config.width, terrainMap.data(), config.width,
+                        config.width, config.height, temperature, moisture, config, *processor);
         return terrainMap;
     }
-    
-    // 优化侵蚀应用
-    void applyErosion(HeightMap& heightmap, const MapConfig& config,
-                     const ErosionParams& params) {
-        if (params.hydraulicErosion) {
-            applyHydraulicErosionParallel(heightmap, config.width, config.height, params);
-        }
-        
-        if (params.thermalErosion) {
-            applyThermalErosionParallel(heightmap, config.width, config.height, params);
+
+    // 按配置的存储宽度生成地形层（同时把气候场写入data）并加入河流和湖泊
+    template<typename TileT>
+    void generateTerrainLayer(std::vector<TileT>& terrainMap, MapData& data,
+                              const MapConfig& config, const std::shared_ptr<ParallelProcessor>& processor,
+                              MapProfile* profile = nullptr) {
+        const HeightMap& heightmap = data.heightMap;
+        {
+            StageTimer timer(profile, GenerationStage::TERRAIN, processor->getThreadCount());
+            generateClimateFields(0, 0, config.width, config.height, config, data.temperature, data.moisture,
+                                  processor);
+            terrainMap.resize(heightmap.size());
+            classifyTerrain(heightmap.data(), config.width, terrainMap.data(), config.width,
+                            config.width, config.height, data.temperature, data.moisture, config, *processor);
+            addStageBytes(profile, GenerationStage::TERRAIN,
+                          terrainMap.size() * sizeof(TileT) +
+                          2 * data.temperature.values.size() * sizeof(float));
         }
-        
-        // 并行重新归一化高度图
-        normalizeHeightmapParallel(heightmap);
+
+        RiverParams riverParams = createRiverParams();
+        riverParams.count = static_cast<uint32_t>(config.width * config.height * kRiverDensity);
+        generateRivers(terrainMap, heightmap, config, riverParams, processor, profile);
     }
 
-    // 并行水力侵蚀
-    void applyHydraulicErosionParallel(HeightMap& heightmap, uint32_t width, uint32_t height,
-                                      const ErosionParams& params) {
-        
-        std::vector<float> water(heightmap.size(), 0.0f);
-        std::vector<float> sediment(heightmap.size(), 0.0f);
-        
-        // 为每个线程创建本地缓冲区以避免竞争
-        const uint32_t chunkSize = 32;
-        
-        for (uint32_t iter = 0; iter < params.iterations; iter++) {
-            // 模拟降雨（并行）
-            m_parallelProcessor->parallelFor2DChunked(width, height, chunkSize,
-                [&](uint32_t startX, uint32_t startY, uint32_t endX, uint32_t endY) {
-                    for (uint32_t y = startY; y < endY; ++y) {
-                        for (uint32_t x = startX; x < endX; ++x) {
-                            uint32_t idx = y * width + x;
-                            water[idx] += params.rainAmount;
-                        }
-                    }
-                });
-            
-            // 分块处理侵蚀，每个块独立处理以避免数据竞争
-            m_parallelProcessor->parallelFor2DChunked(width, height, chunkSize,
-                [&](uint32_t startX, uint32_t startY, uint32_t endX, uint32_t endY) {
-                    // 限制边界
-                    uint32_t realStartX = std::max(startX, 1u);
-                    uint32_t realStartY = std::max(startY, 1u);
-                    uint32_t realEndX = std::min(endX, width - 1);
-                    uint32_t realEndY = std::min(endY, height - 1);
-                    
-                    for (uint32_t y = realStartY; y < realEndY; ++y) {
-                        for (uint32_t x = realStartX; x < realEndX; ++x) {
-                            applyHydraulicErosionAtPoint(heightmap, water, sediment,
-                                                        x, y, width, height, params);
+    // 生成世界坐标(originX, originY)起width x height格区域的温度和湿度场：
+    // 采样点对齐到世界坐标kClimateCellSize的整数倍，每个采样点只取决于世界坐标，
+    // 三层气候噪声按采样点行批量求值，纬度按config.height计算
+    void generateClimateFields(int32_t originX, int32_t originY, uint32_t width, uint32_t height,
+                               const MapConfig& config, ClimateField& temperature, ClimateField& moisture,
+                               const std::shared_ptr<ParallelProcessor>& processor) {
+        const int64_t cell = kClimateCellSize;
+        auto floorToCell = [cell](int64_t v) { return (v >= 0 ? v / cell : -((-v + cell - 1) / cell)) * cell; };
+        const int64_t gridX = floorToCell(originX);
+        const int64_t gridY = floorToCell(originY);
+
+        for (ClimateField* field : {&temperature, &moisture}) {
+            field->cellSize = kClimateCellSize;
+            field->offsetX = static_cast<uint32_t>(originX - gridX);
+            field->offsetY = static_cast<uint32_t>(originY - gridY);
+            // 最后一个格子的右下采样点也要在网格内
+            field->width = width == 0 ? 0 : (field->offsetX + width - 1) / kClimateCellSize + 2;
+            field->height = height == 0 ? 0 : (field->offsetY + height - 1) / kClimateCellSize + 2;
+            field->values.resize(static_cast<size_t>(field->width) * field->height);
+        }
+        temperature.heightLapse = kTemperatureLapse;
+        moisture.heightLapse = kMoistureLapse;
+
+        BiomeParams biomeParams = createBiomeParams(config);
+        std::shared_ptr<NoiseGenerator> noiseGen = noiseGenerator(config.seed, processor);
+        const uint32_t columns = temperature.width;
+        processor->parallelFor1DChunked(temperature.height, kClimateRowsPerTask,
+            [&](uint32_t startRow, uint32_t endRow) {
+                float temperatureNoise[3][kClimateBatchSize];
+                float moistureNoise[3][kClimateBatchSize];
+                for (uint32_t row = startRow; row < endRow; ++row) {
+                    const int32_t worldY = static_cast<int32_t>(gridY + int64_t(row) * cell);
+                    float* temperatureRow = temperature.values.data() + static_cast<size_t>(row) * columns;
+                    float* moistureRow = moisture.values.data() + static_cast<size_t>(row) * columns;
+                    for (uint32_t block = 0; block < columns; block += kClimateBatchSize) {
+                        uint32_t count = std::min(kClimateBatchSize, columns - block);
+                        int32_t worldX = static_cast<int32_t>(gridX + int64_t(block) * cell);
+                        sampleClimateNoise(*noiseGen, worldY, worldX, kClimateCellSize, count,
+                                           biomeParams.temperatureScale, 0.3f, temperatureNoise);
+                        sampleClimateNoise(*noiseGen, worldY, worldX, kClimateCellSize, count,
+                                           biomeParams.moistureScale, 0.5f, moistureNoise);
+                        for (uint32_t k = 0; k < count; ++k) {
+                            temperatureRow[block + k] = seaLevelTemperature(worldY, config, biomeParams,
+                                temperatureNoise[0][k], temperatureNoise[1][k], temperatureNoise[2][k]);
+                            moistureRow[block + k] = seaLevelMoisture(worldY, config, biomeParams,
+                                moistureNoise[0][k], moistureNoise[1][k], moistureNoise[2][k]);
                         }
                     }
-                });
-        }
+                }
+            });
     }
-    
-    // 单点水力侵蚀（线程安全）
-    void applyHydraulicErosionAtPoint(HeightMap& heightmap,
-                                     std::vector<float>& water,
-                                     std::vector<float>& sediment,
-                                     uint32_t x, uint32_t y,
-                                     uint32_t width, uint32_t height,
-                                     const ErosionParams& params) {
-        size_t idx = y * width + x;
-        
-        // 计算水流方向
-        float h = heightmap[idx] + water[idx];
-        float lowest = h;
-        int bestDx = 0, bestDy = 0;
-        
-        // 检查8个方向
-        for (int dy = -1; dy <= 1; dy++) {
-            for (int dx = -1; dx <= 1; dx++) {
-                if (dx == 0 && dy == 0) continue;
-                
-                size_t nIdx = (y + dy) * width + (x + dx);
-                float nh = heightmap[nIdx] + water[nIdx];
-                
-                if (nh < lowest) {
-                    lowest = nh;
-                    bestDx = dx;
-                    bestDy = dy;
+
+    // 对一块区域分类地形，heights/tiles按各自的行跨度寻址，区域内格子(x, y)的气候取自
+    // 气候场的同一坐标；每行先把上下两行采样点按fy插值，再沿x插值，与ClimateField::at逐位一致
+    template<typename TileT>
+    void classifyTerrain(const float* heights, size_t heightStride,
+                         TileT* tiles, size_t tileStride,
+                         uint32_t width, uint32_t height,
+                         const ClimateField& temperatureField, const ClimateField& moistureField,
+                         const MapConfig& config, ParallelProcessor& processor) {
+        const uint32_t cell = temperatureField.cellSize;
+        const uint32_t columns = temperatureField.width;
+        processor.parallelForRowSpans(width, height,
+            [&](uint32_t y, uint32_t startX, uint32_t endX) {
+                const uint32_t gy = y + temperatureField.offsetY;
+                const uint32_t iy = gy / cell;
+                const uint32_t iy1 = iy + 1 < temperatureField.height ? iy + 1 : iy;
+                const float fy = static_cast<float>(gy - iy * cell) / static_cast<float>(cell);
+                const uint32_t gx0 = startX + temperatureField.offsetX;
+                const uint32_t firstColumn = gx0 / cell;
+                const uint32_t lastColumn = std::min((endX - 1 + temperatureField.offsetX) / cell + 1, columns - 1);
+
+                // 该行用到的采样点列先沿y插值
+                std::vector<float> temperatureColumn(lastColumn - firstColumn + 1);
+                std::vector<float> moistureColumn(lastColumn - firstColumn + 1);
+                for (uint32_t c = firstColumn; c <= lastColumn; ++c) {
+                    const float* t = temperatureField.values.data() + c;
+                    const float* m = moistureField.values.data() + c;
+                    const float t0 = t[static_cast<size_t>(iy) * columns];
+                    const float t1 = t[static_cast<size_t>(iy1) * columns];
+                    const float m0 = m[static_cast<size_t>(iy) * columns];
+                    const float m1 = m[static_cast<size_t>(iy1) * columns];
+                    temperatureColumn[c - firstColumn] = t0 + (t1 - t0) * fy;
+                    moistureColumn[c - firstColumn] = m0 + (m1 - m0) * fy;
                 }
-            }
-        }
-        
-        if (bestDx != 0 || bestDy != 0) {
-            size_t flowIdx = (y + bestDy) * width + (x + bestDx);
-            
-            // 计算水流强度
-            float deltaH = h - lowest;
-            if (deltaH > params.minSlope) {
-                float flow = std::min(water[idx], deltaH * params.pipeLength);
-                
-                // 搬运沉积物
-                float sedimentCapacity = flow * params.sedimentCapacity;
-                float actualSediment = std::min(sediment[idx], sedimentCapacity);
-                
-                // 侵蚀
-                float erosion = (sedimentCapacity - actualSediment) * params.erosionRate;
-                heightmap[idx] -= erosion;
-                sediment[idx] += erosion + actualSediment;
-                
-                // 水流和沉积物转移
-                water[idx] -= flow;
-                water[flowIdx] += flow * (1.0f - params.evaporationRate);
-                sediment[idx] -= actualSediment;
-                sediment[flowIdx] += actualSediment * (1.0f - params.depositionRate);
-            }
-        }
-        
-        // 蒸发
-        water[idx] *= (1.0f - params.evaporationRate);
-        
-        // 沉积
-        float deposit = sediment[idx] * params.depositionRate;
-        heightmap[idx] += deposit;
-        sediment[idx] -= deposit;
+
+                const float* heightRow = heights + y * heightStride;
+                TileT* tileRow = tiles + y * tileStride;
+                for (uint32_t x = startX; x < endX; ++x) {
+                    const uint32_t gx = x + temperatureField.offsetX;
+                    const uint32_t ix = gx / cell;
+                    const uint32_t ix1 = ix + 1 < columns ? ix + 1 : ix;
+                    const float fx = static_cast<float>(gx - ix * cell) / static_cast<float>(cell);
+                    const float* t = temperatureColumn.data() - firstColumn;
+                    const float* m = moistureColumn.data() - firstColumn;
+                    const float height = heightRow[x];
+                    const float temperature = std::clamp(
+                        t[ix] + (t[ix1] - t[ix]) * fx - height * kTemperatureLapse, 0.0f, 1.0f);
+                    const float moisture = std::clamp(
+                        m[ix] + (m[ix1] - m[ix]) * fx - height * kMoistureLapse, 0.0f, 1.0f);
+
+                    // 确定地形类型
+                    TerrainType terrain = determineTerrainType(height, temperature, moisture, config);
+                    tileRow[x] = static_cast<TileT>(terrain);
+                }
+            });
     }
     
-    // 并行热侵蚀
-    void applyThermalErosionParallel(HeightMap& heightmap, uint32_t width, uint32_t height,
-                                    const ErosionParams& params) {
-        
-        std::vector<float> changes(heightmap.size(), 0.0f);
+    // 优化侵蚀应用
+    void applyErosion(HeightMap& heightmap, const MapConfig& config,
+                     const ErosionParams& params, ParallelProcessor& processor,
+                     MapProfile* profile = nullptr) {
+        StageTimer timer(profile, GenerationStage::EROSION, processor.getThreadCount());
+        const uint64_t interiorCells = config.width > 2 && config.height > 2
+            ? static_cast<uint64_t>(config.width - 2) * (config.height - 2) : 0;
         
-        for (uint32_t iter = 0; iter < params.iterations; iter++) {
-            // 使用线程安全的处理方式
-            std::vector<float> localChanges(heightmap.size(), 0.0f);
-            
-            m_parallelProcessor->parallelFor2DChunked(width, height, 32,
-                [&](uint32_t startX, uint32_t startY, uint32_t endX, uint32_t endY) {
-                    uint32_t realStartX = std::max(startX, 1u);
-                    uint32_t realStartY = std::max(startY, 1u);
-                    uint32_t realEndX = std::min(endX, width - 1);
-                    uint32_t realEndY = std::min(endY, height - 1);
-                    
-                    for (uint32_t y = realStartY; y < realEndY; ++y) {
-                        for (uint32_t x = realStartX; x < realEndX; ++x) {
-                            applyThermalErosionAtPoint(heightmap, localChanges,
-                                                      x, y, width, height, params);
-                        }
-                    }
-                });
-            
-            // 合并变化
-            for (size_t i = 0; i < heightmap.size(); ++i) {
-                heightmap[i] += localChanges[i];
-            }
+        if (params.hydraulicErosion && params.hydraulicModel == ErosionModel::DROPLET) {
+            uint64_t droplets = applyDropletErosion(heightmap, config.width, config.height, params,
+                                                    config.seed, processor);
+            MG_PROFILE_COUNT(profile, dropletsSimulated, droplets);
+        } else if (params.hydraulicErosion &&
+                   applyPipeErosion(heightmap, config.width, config.height, params,
+                                    processor, *m_scratch)) {
+            addStageBytes(profile, GenerationStage::EROSION,
+                          kPipeErosionGrids * heightmap.size() * sizeof(float));
+            MG_PROFILE_COUNT(profile, erosionCellUpdates,
+                             uint64_t(params.pipeIterations) * heightmap.size());
         }
-    }
-    
-    // 单点热侵蚀（线程安全）
-    void applyThermalErosionAtPoint(HeightMap& heightmap,
-                                   std::vector<float>& changes,
-                                   uint32_t x, uint32_t y,
-                                   uint32_t width, uint32_t height,
-                                   const ErosionParams& params) {
         
-        size_t idx = y * width + x;
-        float h = heightmap[idx];
-        
-        // 计算坡度和总差异
-        float maxSlope = 0.0f;
-        float totalDiff = 0.0f;
-        std::vector<std::pair<size_t, float>> steepNeighbors;
-        
-        for (int dy = -1; dy <= 1; dy++) {
-            for (int dx = -1; dx <= 1; dx++) {
-                if (dx == 0 && dy == 0) continue;
-                
-                size_t nIdx = (y + dy) * width + (x + dx);
-                float nh = heightmap[nIdx];
-                float slope = h - nh;
-                
-                if (slope > maxSlope) {
-                    maxSlope = slope;
-                }
-                
-                float talusThreshold = params.talusAngle * (M_PI / 180.0f) * params.pipeLength;
-                if (slope > talusThreshold) {
-                    totalDiff += slope;
-                    steepNeighbors.emplace_back(nIdx, slope);
-                }
-            }
+        if (params.thermalErosion) {
+            uint32_t thermalIterations = applyThermalErosion(heightmap, config.width, config.height, params,
+                                                             *m_scratch, &processor, true);
+            addStageBytes(profile, GenerationStage::EROSION, 2 * heightmap.size() * sizeof(float));
+            MG_PROFILE_COUNT(profile, erosionCellUpdates, thermalIterations * interiorCells);
         }
         
-        // 应用热侵蚀
-        if (!steepNeighbors.empty() && maxSlope > params.talusAngle * (M_PI / 180.0f)) {
-            float erosion = totalDiff * params.thermalRate / steepNeighbors.size();
-            changes[idx] -= erosion;
-            
-            // 分配到邻居
-            for (const auto& [neighborIdx, slope] : steepNeighbors) {
-                if (totalDiff > 0) {
-                    changes[neighborIdx] += erosion * (slope / totalDiff);
-                }
-            }
-        }
+        // 并行重新归一化高度图
+        normalizeHeightmapParallel(heightmap, processor);
     }
-    
+
     // 并行归一化高度图
-    void normalizeHeightmapParallel(HeightMap& heightmap) {
+    void normalizeHeightmapParallel(HeightMap& heightmap, ParallelProcessor& processor) {
         if (heightmap.empty()) return;
         
         // 使用新的并行函数查找最小最大值
-        auto [minVal, maxVal] = m_parallelProcessor->parallelMinMax(
+        auto [minVal, maxVal] = processor.parallelMinMax(
             heightmap.data(), static_cast<uint32_t>(heightmap.size())
         );
         
@@ -406,7 +627,7 @@ public:
         
         if (range > 0.0f) {
             // 使用新的并行函数进行归一化
-            m_parallelProcessor->parallelNormalize(
+            processor.parallelNormalize(
                 heightmap.data(), static_cast<uint32_t>(heightmap.size()),
                 minVal, maxVal
             );
@@ -416,29 +637,554 @@ public:
         }
     }
     
-    void generateRivers(TileMap& terrainMap, const HeightMap& heightmap,
-                       const MapConfig& config, const RiverParams& params) {
+    template<typename TileT>
+    void generateRivers(std::vector<TileT>& terrainMap, const HeightMap& heightmap,
+                       const MapConfig& config, const RiverParams& params,
+                       const std::shared_ptr<ParallelProcessor>& processor,
+                       MapProfile* profile = nullptr) {
+        if (config.hydrology == HydrologyModel::FLOW) {
+            generateFlowHydrology(terrainMap, heightmap, config, params, *processor, profile);
+            return;
+        }
+
+        // 每次生成使用独立的随机序列，保证常驻引擎下结果可复现
+        std::mt19937 rng(config.seed);
+        
         // 生成河流网络
-        generateRiverNetwork(terrainMap, heightmap, config, params);
+        {
+            StageTimer timer(profile, GenerationStage::RIVERS, processor->getThreadCount());
+            generateRiverNetwork(terrainMap, heightmap, config, params, rng, *processor, profile);
+        }
         
         // 生成湖泊
         if (params.generateLakes) {
-            generateLakesParallel(terrainMap, heightmap, config, params);
+            StageTimer timer(profile, GenerationStage::LAKES, processor->getThreadCount());
+            generateLakesParallel(terrainMap, heightmap, config, params, rng, processor, profile);
+        }
+    }
+
+    // 单独运行湖泊阶段：整图生成中湖泊的抽选接在河流源点抽选之后，这里随机序列从种子开始
+    template<typename TileT>
+    void generateLakes(std::vector<TileT>& terrainMap, const HeightMap& heightmap,
+                       const MapConfig& config, const RiverParams& params,
+                       const std::shared_ptr<ParallelProcessor>& processor) {
+        std::mt19937 rng(config.seed);
+        generateLakesParallel(terrainMap, heightmap, config, params, rng, processor);
+    }
+
+    // 汇流模型：一次填洼得到流向和汇流量，汇流量达到阈值的陆地格为河流，
+    // 填洼深度超过阈值的陆地格为湖泊；河流经过湖泊时湖面优先，出湖后继续向下游延伸
+    template<typename TileT>
+    void generateFlowHydrology(std::vector<TileT>& terrainMap, const HeightMap& heightmap,
+                               const MapConfig& config, const RiverParams& params,
+                               ParallelProcessor& processor, MapProfile* profile = nullptr) {
+        const uint32_t width = config.width;
+        const uint32_t count = static_cast<uint32_t>(terrainMap.size());
+        const float seaLevel = config.seaLevel;
+        const uint32_t threshold = std::max(params.flowRiverMinCells,
+            static_cast<uint32_t>(static_cast<double>(count) * params.flowRiverFraction));
+        const bool lakes = params.generateLakes;
+
+        StageTimer riverTimer(profile, GenerationStage::RIVERS, processor.getThreadCount());
+        FlowField field;
+        if (!computeFlowField(heightmap, width, config.height, seaLevel, *m_scratch, field)) {
+            return;
+        }
+        addStageBytes(profile, GenerationStage::RIVERS, field.bytes());
+
+        const HeightMap& filled = field.filled;
+        const std::vector<uint8_t>& receiver = field.receiver;
+        const std::vector<uint32_t>& accumulation = field.accumulation;
+        auto isLake = [&](uint32_t idx) {
+            return heightmap[idx] >= seaLevel && filled[idx] - heightmap[idx] > params.flowLakeDepth;
+        };
+        auto isRiver = [&](uint32_t idx) {
+            return accumulation[idx] >= threshold && heightmap[idx] >= seaLevel &&
+                   !(lakes && isLake(idx));
+        };
+
+        // 河流：源头是没有上游河流格流入的河流格
+        std::atomic<uint32_t> heads{0};
+        processor.parallelFor1DChunked(count, 16384,
+            [&](uint32_t start, uint32_t end) {
+                uint32_t localHeads = 0;
+                for (uint32_t idx = start; idx < end; ++idx) {
+                    if (!isRiver(idx)) continue;
+
+                    TerrainType current = static_cast<TerrainType>(terrainMap[idx]);
+                    if (current != TerrainType::DEEP_OCEAN &&
+                        current != TerrainType::SHALLOW_OCEAN &&
+                        current != TerrainType::COAST) {
+                        terrainMap[idx] = static_cast<TileT>(TerrainType::RIVER);
+                    }
+
+                    int32_t x = static_cast<int32_t>(idx % width);
+                    int32_t y = static_cast<int32_t>(idx / width);
+                    bool fed = false;
+                    for (uint8_t d = 0; d < 8 && !fed; ++d) {
+                        int32_t nx = x + kD8Dx[d];
+                        int32_t ny = y + kD8Dy[d];
+                        if (nx < 0 || ny < 0 || nx >= static_cast<int32_t>(width) ||
+                            ny >= static_cast<int32_t>(config.height)) {
+                            continue;
+                        }
+                        uint32_t neighbor = static_cast<uint32_t>(ny) * width + static_cast<uint32_t>(nx);
+                        fed = receiver[neighbor] == ((d + 4) & 7) && isRiver(neighbor);
+                    }
+                    localHeads += fed ? 0 : 1;
+                }
+                heads.fetch_add(localHeads, std::memory_order_relaxed);
+            });
+        MG_PROFILE_COUNT(profile, riverSources, heads.load());
+        MG_PROFILE_COUNT(profile, riversTraced, heads.load());
+        riverTimer.stop();
+
+        // 湖泊：按所属洼地的溢出口计数，一个洼地内的湖泊格算一个湖泊
+        if (lakes) {
+            StageTimer lakeTimer(profile, GenerationStage::LAKES, processor.getThreadCount());
+            std::vector<uint32_t> lakeOutlets;
+            std::mutex outletMutex;
+            processor.parallelFor1DChunked(count, 16384,
+                [&](uint32_t start, uint32_t end) {
+                    std::vector<uint32_t> localOutlets;
+                    for (uint32_t idx = start; idx < end; ++idx) {
+                        if (!isLake(idx)) continue;
+                        applyLakeTile(terrainMap[idx], static_cast<uint8_t>(TerrainType::LAKE));
+                        if (localOutlets.empty() || localOutlets.back() != field.spill[idx]) {
+                            localOutlets.push_back(field.spill[idx]);
+                        }
+                    }
+                    if (!localOutlets.empty()) {
+                        std::lock_guard<std::mutex> lock(outletMutex);
+                        lakeOutlets.insert(lakeOutlets.end(), localOutlets.begin(), localOutlets.end());
+                    }
+                });
+            std::sort(lakeOutlets.begin(), lakeOutlets.end());
+            lakeOutlets.erase(std::unique(lakeOutlets.begin(), lakeOutlets.end()), lakeOutlets.end());
+            MG_PROFILE_COUNT(profile, lakeCandidates, field.depressions);
+            MG_PROFILE_COUNT(profile, lakesPlaced, static_cast<uint32_t>(lakeOutlets.size()));
+        }
+
+        releaseFlowField(*m_scratch, field);
+    }
+
+    // 分块生成：块四周扩展halo后生成整块区域，平滑、热侵蚀等模板运算以及跨块的河流、湖泊
+    // 在块内的结果只取决于世界坐标，相邻块各自独立生成也能无缝拼接。
+    // config.width/height作为世界尺寸，决定岛屿衰减和纬度
+    std::shared_ptr<MapData> generateChunk(int32_t chunkX, int32_t chunkY, uint32_t chunkSize,
+                                           const MapConfig& config) {
+        if (chunkSize == 0 || config.width == 0 || config.height == 0) {
+            return nullptr;
+        }
+
+        ErosionParams erosionParams = createErosionParams(config);
+        RiverParams riverParams = createRiverParams();
+
+        // 模板运算的依赖半径：每轮热侵蚀2格、平滑radius格，再留1格不处理的边界；
+        // 河流源点和湖心要在整个选取单元内比较，高度须在单元范围内精确
+        const uint32_t stencilHalo = 2 * erosionParams.iterations + kChunkSmoothingRadius + 1;
+        const uint32_t featureHalo = std::max(kChunkFeatureHalo + kChunkRiverCellSize + 1,
+                                              chunkLakeReach(riverParams) + kChunkLakeCellSize + 2);
+        const uint32_t halo = stencilHalo + featureHalo;
+        const uint64_t regionSize64 = static_cast<uint64_t>(chunkSize) + 2 * halo;
+        const int64_t originX64 = static_cast<int64_t>(chunkX) * chunkSize - halo;
+        const int64_t originY64 = static_cast<int64_t>(chunkY) * chunkSize - halo;
+
+        // 世界坐标必须在int32范围内
+        if (regionSize64 > std::numeric_limits<int32_t>::max() ||
+            originX64 < std::numeric_limits<int32_t>::min() ||
+            originY64 < std::numeric_limits<int32_t>::min() ||
+            originX64 + static_cast<int64_t>(regionSize64) > std::numeric_limits<int32_t>::max() ||
+            originY64 + static_cast<int64_t>(regionSize64) > std::numeric_limits<int32_t>::max()) {
+            return nullptr;
+        }
+
+        const uint32_t regionSize = static_cast<uint32_t>(regionSize64);
+        const int32_t originX = static_cast<int32_t>(originX64);
+        const int32_t originY = static_cast<int32_t>(originY64);
+
+        std::shared_ptr<ParallelProcessor> processor = prepare(config);
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        auto data = std::make_shared<MapData>();
+        data->config = config;
+        data->config.width = chunkSize;
+        data->config.height = chunkSize;
+        MapProfile* profile = &data->profile;
+        const uint32_t threads = processor->getThreadCount();
+        const size_t regionBytes = static_cast<size_t>(regionSize) * regionSize * sizeof(float);
+
+        // 步骤1: 在世界坐标上生成带halo的高度场
+        std::shared_ptr<NoiseGenerator> noiseGen = noiseGenerator(config.seed, processor);
+        NoiseParams noiseParams = createHeightNoiseParams(config);
+        HeightMap region;
+        {
+            StageTimer timer(profile, GenerationStage::NOISE, threads);
+            region = noiseGen->generateNoiseRegion(originX, originY, regionSize, regionSize,
+                                                   config.width, config.height, noiseParams);
+            addStageBytes(profile, GenerationStage::NOISE, regionBytes);
+        }
+
+        // 步骤2: 热侵蚀后按固定区间归一化。水力侵蚀分块做需要pipeIterations×每轮影响半径
+        // （通量、水深、侵蚀各1格加平流回溯）的halo，默认轮数下区域面积成倍增加，分块模式不做
+        {
+            StageTimer timer(profile, GenerationStage::EROSION, 1);
+            // 提前结束与否取决于整块内容，相邻块的重叠部分会不一致，须跑满轮数
+            applyThermalErosion(region, regionSize, regionSize, erosionParams, *m_scratch, nullptr, false);
+            auto [minHeight, maxHeight] = fixedHeightRange(noiseParams);
+            processor->parallelNormalize(region.data(), static_cast<uint32_t>(region.size()),
+                                         minHeight, maxHeight);
+            addStageBytes(profile, GenerationStage::EROSION, regionBytes);
+            MG_PROFILE_COUNT(profile, erosionCellUpdates,
+                             erosionParams.iterations * uint64_t(regionSize - 2) * (regionSize - 2));
+        }
+
+        // 步骤3: 平滑
+        {
+            StageTimer timer(profile, GenerationStage::SMOOTHING, threads);
+            noiseGen->applySmoothing(region, regionSize, regionSize, kChunkSmoothingRadius);
+        }
+
+        // 步骤4: 裁剪出块内高度并分类地形
+        data->heightMap.resize(static_cast<size_t>(chunkSize) * chunkSize);
+
+        const float* chunkHeights = region.data() + static_cast<size_t>(halo) * regionSize + halo;
+        for (uint32_t y = 0; y < chunkSize; ++y) {
+            std::copy(chunkHeights + static_cast<size_t>(y) * regionSize,
+                      chunkHeights + static_cast<size_t>(y) * regionSize + chunkSize,
+                      data->heightMap.begin() + static_cast<size_t>(y) * chunkSize);
         }
+        auto buildTerrain = [&](auto& terrainMap) {
+            {
+                StageTimer timer(profile, GenerationStage::TERRAIN, threads);
+                terrainMap.resize(data->heightMap.size());
+                generateClimateFields(originX + static_cast<int32_t>(halo), originY + static_cast<int32_t>(halo),
+                                      chunkSize, chunkSize, config, data->temperature, data->moisture, processor);
+                classifyTerrain(chunkHeights, regionSize, terrainMap.data(), chunkSize,
+                                chunkSize, chunkSize, data->temperature, data->moisture, config, *processor);
+                addStageBytes(profile, GenerationStage::TERRAIN,
+                              terrainMap.size() * sizeof(terrainMap[0]) +
+                              2 * data->temperature.values.size() * sizeof(float));
+            }
+
+            // 步骤5: 河流与湖泊
+            generateChunkWaterFeatures(terrainMap, region, regionSize, halo, chunkSize,
+                                       originX, originY, config, riverParams, processor, profile);
+        };
+        if (config.compactTiles) {
+            buildTerrain(data->terrainTiles);
+        } else {
+            buildTerrain(data->terrainMap);
+        }
+
+        // 步骤6: 按配置的格式保存高度
+        storeHeights(*data, *processor);
+
+        // 步骤7: 计算统计信息
+        calculateStatistics(*data, *processor);
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        data->generationTimeMs = std::chrono::duration_cast<
+            std::chrono::milliseconds>(endTime - startTime).count();
+
+        return data;
     }
     
 private:
-    uint64_t computeCacheKey(const MapConfig& config) {
-        // 简单的哈希函数用于缓存键
-        uint64_t key = config.seed;
-        key = key * 31 + config.width;
-        key = key * 31 + config.height;
-        key = key * 31 + static_cast<uint32_t>(config.preset);
-        key = key * 31 + *reinterpret_cast<const uint32_t*>(&config.seaLevel);
-        key = key * 31 + *reinterpret_cast<const uint32_t*>(&config.temperature);
-        return key;
+    // 各噪声类型下fBm（含岛屿衰减）的典型取值区间，分块生成用它代替整图的最小最大值归一化
+    static std::pair<float, float> fixedHeightRange(const NoiseParams& params) {
+        if (params.type == NoiseType::WORLEY) {
+            return {0.0f, 0.75f};
+        }
+        if (params.islandMode) {
+            return {-0.22f, 0.25f};
+        }
+        return {-0.45f, 0.45f};
     }
-    
+
+    // 位置哈希：分块生成中所有随机决策都由世界坐标和种子决定
+    static uint32_t positionHash(uint32_t seed, int32_t x, int32_t y, uint32_t salt) {
+        uint32_t h = Utils::hash(static_cast<uint32_t>(x), static_cast<uint32_t>(y),
+                                 seed ^ (salt * 0x9e3779b9u));
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    static float positionUnit(uint32_t seed, int32_t x, int32_t y, uint32_t salt) {
+        return (positionHash(seed, x, y, salt) >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // 湖泊能影响到的离湖心最远距离（含边界平滑）
+    static uint32_t chunkLakeReach(const RiverParams& params) {
+        return static_cast<uint32_t>(params.maxLakeSize * 1.5f) + 3;
+    }
+
+    static int32_t floorDiv(int32_t a, int32_t b) {
+        int32_t q = a / b;
+        return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+    }
+
+    // 分块的河流与湖泊：源点和湖心按世界网格选取，随机量取自位置哈希，
+    // 块内结果只取决于块四周kChunkFeatureHalo以内的高度
+    template<typename TileT>
+    void generateChunkWaterFeatures(std::vector<TileT>& terrainMap, const HeightMap& region,
+                                    uint32_t regionSize, uint32_t halo, uint32_t chunkSize,
+                                    int32_t originX, int32_t originY,
+                                    const MapConfig& config, const RiverParams& params,
+                                    const std::shared_ptr<ParallelProcessor>& processor,
+                                    MapProfile* profile = nullptr) {
+        const uint32_t kNoFeature = std::numeric_limits<uint32_t>::max();
+        const int32_t chunkWorldX = originX + static_cast<int32_t>(halo);
+        const int32_t chunkWorldY = originY + static_cast<int32_t>(halo);
+        const int32_t reach = static_cast<int32_t>(kChunkFeatureHalo);
+        const int32_t size = static_cast<int32_t>(chunkSize);
+
+        auto heightAt = [&](int32_t worldX, int32_t worldY) {
+            return region[static_cast<size_t>(worldY - originY) * regionSize + (worldX - originX)];
+        };
+
+        // 世界网格每个cellSize见方的单元内至多选一个点：满足条件的点中取哈希值最小者，
+        // 与整图生成按面积限制数量的密度相当；只返回离块不超过reach的点，按世界坐标行优先排序
+        auto selectPerCell = [&](int32_t cellSize, int32_t reach, uint32_t salt, auto&& accept) {
+            std::vector<std::pair<int32_t, int32_t>> points;
+            int32_t cellX0 = floorDiv(chunkWorldX - reach, cellSize);
+            int32_t cellY0 = floorDiv(chunkWorldY - reach, cellSize);
+            int32_t cellX1 = floorDiv(chunkWorldX + size + reach - 1, cellSize);
+            int32_t cellY1 = floorDiv(chunkWorldY + size + reach - 1, cellSize);
+
+            for (int32_t cellY = cellY0; cellY <= cellY1; ++cellY) {
+                for (int32_t cellX = cellX0; cellX <= cellX1; ++cellX) {
+                    uint32_t bestHash = kNoFeature;
+                    std::pair<int32_t, int32_t> best;
+
+                    for (int32_t wy = cellY * cellSize; wy < (cellY + 1) * cellSize; ++wy) {
+                        for (int32_t wx = cellX * cellSize; wx < (cellX + 1) * cellSize; ++wx) {
+                            if (!accept(wx, wy)) continue;
+                            uint32_t hash = positionHash(config.seed, wx, wy, salt);
+                            if (hash < bestHash) {
+                                bestHash = hash;
+                                best = {wx, wy};
+                            }
+                        }
+                    }
+
+                    auto [wx, wy] = best;
+                    if (bestHash != kNoFeature &&
+                        wx >= chunkWorldX - reach && wx < chunkWorldX + size + reach &&
+                        wy >= chunkWorldY - reach && wy < chunkWorldY + size + reach) {
+                        points.push_back(best);
+                    }
+                }
+            }
+
+            std::sort(points.begin(), points.end(), [](const auto& a, const auto& b) {
+                return a.second != b.second ? a.second < b.second : a.first < b.first;
+            });
+            return points;
+        };
+
+        // 1. 河流源点：高度区间内的局部高点
+        StageTimer riverTimer(profile, GenerationStage::RIVERS, 1);
+        auto sources = selectPerCell(static_cast<int32_t>(kChunkRiverCellSize), reach, 1,
+            [&](int32_t wx, int32_t wy) {
+                float height = heightAt(wx, wy);
+                if (height < params.minSourceHeight || height > params.maxSourceHeight) {
+                    return false;
+                }
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        if ((dx != 0 || dy != 0) && heightAt(wx + dx, wy + dy) > height) {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            });
+
+        MG_PROFILE_COUNT(profile, riverSources, static_cast<uint32_t>(sources.size()));
+        MG_PROFILE_COUNT(profile, riversTraced, static_cast<uint32_t>(sources.size()));
+
+        std::vector<uint32_t> riverCells;
+        for (const auto& [sourceX, sourceY] : sources) {
+            traceChunkRiver(riverCells, region, regionSize, originX, originY,
+                            sourceX - originX, sourceY - originY, config, params);
+        }
+        addStageBytes(profile, GenerationStage::RIVERS, riverCells.capacity() * sizeof(uint32_t));
+
+        // 合并落在块内的河流格子（不覆盖海洋），光环区的格子只用于追踪
+        for (uint32_t regionIdx : riverCells) {
+            uint32_t x = regionIdx % regionSize;
+            uint32_t y = regionIdx / regionSize;
+            if (x < halo || y < halo || x - halo >= chunkSize || y - halo >= chunkSize) {
+                continue;
+            }
+            TileT& tile = terrainMap[static_cast<size_t>(y - halo) * chunkSize + (x - halo)];
+            TerrainType current = static_cast<TerrainType>(tile);
+            if (current != TerrainType::DEEP_OCEAN &&
+                current != TerrainType::SHALLOW_OCEAN &&
+                current != TerrainType::COAST) {
+                tile = static_cast<TileT>(TerrainType::RIVER);
+            }
+        }
+        riverTimer.stop();
+
+        if (!params.generateLakes) {
+            return;
+        }
+
+        // 2. 湖泊：5x5范围内的低点按位置哈希以lakeProbability的概率成为候选湖心，
+        //    按世界坐标的行优先顺序合并，形状随机数由湖心位置播种
+        StageTimer lakeTimer(profile, GenerationStage::LAKES, 1);
+        MapConfig regionConfig = config;
+        regionConfig.width = regionSize;
+        regionConfig.height = regionSize;
+        std::shared_ptr<NoiseGenerator> noiseGen = noiseGenerator(config.seed, processor);
+
+        auto lakeCenters = selectPerCell(static_cast<int32_t>(kChunkLakeCellSize),
+                                         static_cast<int32_t>(chunkLakeReach(params)), 2,
+            [&](int32_t wx, int32_t wy) {
+                if (positionUnit(config.seed, wx, wy, 3) >= params.lakeProbability) {
+                    return false;
+                }
+                float height = heightAt(wx, wy);
+                for (int dy = -2; dy <= 2; dy++) {
+                    for (int dx = -2; dx <= 2; dx++) {
+                        if ((dx != 0 || dy != 0) && heightAt(wx + dx, wy + dy) < height) {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            });
+        MG_PROFILE_COUNT(profile, lakeCandidates, static_cast<uint32_t>(lakeCenters.size()));
+        MG_PROFILE_COUNT(profile, lakesPlaced, static_cast<uint32_t>(lakeCenters.size()));
+
+        // 湖泊栅格与块内部的交集写入块地形
+        const int32_t interiorBegin = static_cast<int32_t>(halo);
+        const int32_t interiorEnd = static_cast<int32_t>(halo + chunkSize);
+        LakeRaster lake;
+        for (const auto& [wx, wy] : lakeCenters) {
+            std::mt19937 lakeRng(positionHash(config.seed, wx, wy, 4));
+            rasterizeLake(*noiseGen, lake, regionConfig,
+                          static_cast<uint32_t>(wx - originX),
+                          static_cast<uint32_t>(wy - originY),
+                          params, lakeRng, originX, originY);
+
+            int32_t rowBegin = std::max(lake.y0, interiorBegin);
+            int32_t rowEnd = std::min(lake.y0 + static_cast<int32_t>(lake.height), interiorEnd);
+            int32_t colBegin = std::max(lake.x0, interiorBegin);
+            int32_t colEnd = std::min(lake.x0 + static_cast<int32_t>(lake.width), interiorEnd);
+            for (int32_t y = rowBegin; y < rowEnd; ++y) {
+                for (int32_t x = colBegin; x < colEnd; ++x) {
+                    applyLakeTile(terrainMap[static_cast<size_t>(y - interiorBegin) * chunkSize +
+                                             (x - interiorBegin)],
+                                  lake.at(x, y));
+                }
+            }
+        }
+        addStageBytes(profile, GenerationStage::LAKES, lake.tiles.capacity());
+    }
+
+    // 分块河流追踪：与traceRiver相同的最陡下降和支流规则，
+    // 随机终止和支流偏移取自(世界坐标, 深度)的哈希，结果与追踪顺序无关
+    void traceChunkRiver(std::vector<uint32_t>& cells, const HeightMap& region,
+                         uint32_t regionSize, int32_t originX, int32_t originY,
+                         int32_t startX, int32_t startY,
+                         const MapConfig& config, const RiverParams& params) {
+        const int32_t size = static_cast<int32_t>(regionSize);
+        std::stack<RiverPoint> riverStack;
+        riverStack.push({static_cast<uint32_t>(startX), static_cast<uint32_t>(startY),
+                         region[static_cast<size_t>(startY) * regionSize + startX], false, 0});
+
+        while (!riverStack.empty()) {
+            RiverPoint current = riverStack.top();
+            riverStack.pop();
+
+            int32_t x = static_cast<int32_t>(current.x);
+            int32_t y = static_cast<int32_t>(current.y);
+            if (x <= 0 || x >= size - 1 || y <= 0 || y >= size - 1) {
+                continue;
+            }
+
+            size_t idx = static_cast<size_t>(y) * regionSize + x;
+            float currentHeight = region[idx];
+            cells.push_back(static_cast<uint32_t>(idx));
+
+            // 流入海洋、随机终止或超出长度时停止
+            int32_t worldX = originX + x;
+            int32_t worldY = originY + y;
+            uint32_t salt = 16 + current.depth * 4 + (current.isTributary ? 2 : 0);
+            if (currentHeight < config.seaLevel ||
+                positionUnit(config.seed, worldX, worldY, salt) < 0.01f ||
+                current.depth > params.maxRiverLength) {
+                continue;
+            }
+
+            // 找到最低的邻居（水流方向）
+            float minHeight = currentHeight;
+            int bestDx = 0, bestDy = 0;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if (dx == 0 && dy == 0) continue;
+                    float nHeight = region[static_cast<size_t>(y + dy) * regionSize + (x + dx)];
+                    if (nHeight < minHeight) {
+                        minHeight = nHeight;
+                        bestDx = dx;
+                        bestDy = dy;
+                    }
+                }
+            }
+
+            if (bestDx == 0 && bestDy == 0) {
+                continue;
+            }
+
+            riverStack.push({static_cast<uint32_t>(x + bestDx), static_cast<uint32_t>(y + bestDy),
+                             minHeight, current.isTributary, current.depth + 1});
+
+            // 支流
+            if (params.tributaries && !current.isTributary &&
+                current.depth > 20 && current.depth % 30 == 0) {
+                float angle = positionUnit(config.seed, worldX, worldY, salt + 1) * 2.0f * M_PI;
+                float distance = 3.0f + positionUnit(config.seed, worldX, worldY, salt + 3) * 5.0f;
+
+                int32_t tribX = std::clamp(static_cast<int32_t>(x + std::cos(angle) * distance), 1, size - 2);
+                int32_t tribY = std::clamp(static_cast<int32_t>(y + std::sin(angle) * distance), 1, size - 2);
+                float tribHeight = region[static_cast<size_t>(tribY) * regionSize + tribX];
+
+                if (tribHeight >= params.minSourceHeight &&
+                    tribHeight <= params.maxSourceHeight) {
+                    riverStack.push({static_cast<uint32_t>(tribX), static_cast<uint32_t>(tribY),
+                                     tribHeight, true, current.depth + 1});
+                }
+            }
+        }
+    }
+
+    ErosionParams createErosionParams(const MapConfig& config) {
+        ErosionParams params;
+        params.hydraulicModel = config.erosion;
+        params.iterations = 5;
+        params.thermalErosion = true;
+        params.hydraulicErosion = true;
+        params.talusAngle = 35.0f;
+        params.pipeIterations = 24;
+        params.sedimentCapacity = 2.0f;
+        return params;
+    }
+
+    RiverParams createRiverParams() {
+        RiverParams params;
+        params.minSourceHeight = 0.6f;
+        params.maxSourceHeight = 0.9f;
+        return params;
+    }
+
     NoiseParams createNoiseParamsFromConfig(const MapConfig& config) {
         NoiseParams params;
         params.scale = config.noiseScale;
@@ -553,26 +1299,6 @@ private:
         }
     }
     
-    void generateTerrainChunk(const HeightMap& heightmap, TileMap& terrainMap,
-                             const MapConfig& config, uint32_t startY, uint32_t endY) {
-        BiomeParams biomeParams = createBiomeParams(config);
-        
-        for (uint32_t y = startY; y < endY; y++) {
-            for (uint32_t x = 0; x < config.width; x++) {
-                uint32_t idx = y * config.width + x;
-                float height = heightmap[idx];
-                
-                // 计算生物群落参数
-                float temperature = calculateTemperature(x, y, config, height, biomeParams);
-                float moisture = calculateMoisture(x, y, config, height, biomeParams);
-                
-                // 确定地形类型
-                TerrainType terrain = determineTerrainType(height, temperature, moisture, config);
-                terrainMap[idx] = static_cast<uint32_t>(terrain);
-            }
-        }
-    }
-    
     BiomeParams createBiomeParams(const MapConfig& config) {
         BiomeParams params;
         params.temperatureScale = 100.0f;
@@ -599,80 +1325,74 @@ private:
         return params;
     }
     
-    float calculateTemperature(uint32_t x, uint32_t y, const MapConfig& config,
-                               float height, const BiomeParams& params) {
+    // 批量采样一行上间隔step格的count个点的三层气候噪声（主噪声、2倍细节、coarseFactor倍大尺度），
+    // 三层分别位于整数切片1、2、3上
+    void sampleClimateNoise(NoiseGenerator& noiseGen, int32_t y, int32_t startX, uint32_t step,
+                            uint32_t count, float scale, float coarseFactor,
+                            float (&noise)[3][kClimateBatchSize]) {
+        float xs[kClimateBatchSize];
+        float ys[kClimateBatchSize];
+        float noiseY = y / scale;
+
+        const float factors[3] = {1.0f, 2.0f, coarseFactor};
+        const int layers[3] = {1, 2, 3};
+
+        for (int layer = 0; layer < 3; ++layer) {
+            for (uint32_t k = 0; k < count; ++k) {
+                xs[k] = (startX + static_cast<int32_t>(k * step)) / scale * factors[layer];
+                ys[k] = noiseY * factors[layer];
+            }
+            noiseGen.applyPerlinNoise2DBatch(xs, ys, layers[layer], noise[layer], count);
+        }
+    }
+
+    // 由三层噪声采样合成海平面处的温度（不含高度影响、未限制范围）
+    float seaLevelTemperature(int32_t y, const MapConfig& config,
+                              const BiomeParams& params, float noise1, float noise2, float noise3) {
         // 1. 基础温度
         float temperature = config.temperature;
 
         // 2. 纬度影响 - 使用加法而不是乘法
         // 赤道附近更热，两极更冷
-        float latitude = static_cast<float>(y) / config.height; // [0, 1]
+        // 分块生成时y可能超出地图范围，超出部分按两极处理
+        float latitude = std::clamp(static_cast<float>(y) / config.height, 0.0f, 1.0f); // [0, 1]
         float latDistance = fabs(latitude - 0.5f); // 距离赤道的距离 [0, 0.5]
 
         // 纬度影响：赤道+0.2，两极-0.3
         float latEffect = 0.2f - latDistance * 1.0f; // [0.2, -0.3]
 
-        // 3. 高度影响 - 每"升高"降温
-        // height范围[0,1]，高处降温更多
-        float heightEffect = -height * 0.3f; // [0, -0.3]
-
-        // 4. 季节/日夜模拟（简化）
-        float seasonalEffect = 0.0f;
-        // 可以根据需要添加季节变化
-
-        // 5. 使用柏林噪声生成空间变化
-        float noiseX = x / params.temperatureScale;
-        float noiseY = y / params.temperatureScale;
-
-        // 多层噪声
-        float noise1 = m_noiseGen->applyPerlinNoise(noiseX, noiseY, 0.5f); // 主噪声
-        float noise2 = m_noiseGen->applyPerlinNoise(noiseX * 2.0f, noiseY * 2.0f, 1.5f) * 0.5f; // 细节
-        float noise3 = m_noiseGen->applyPerlinNoise(noiseX * 0.3f, noiseY * 0.3f, 2.5f) * 0.8f; // 大尺度
+        // 3. 多层噪声
+        noise2 *= 0.5f; // 细节
+        noise3 *= 0.8f; // 大尺度
 
         float totalNoise = (noise1 * 0.6f + noise2 * 0.3f + noise3 * 0.1f) * 0.3f; // [-0.3, 0.3]
 
-
-        // 综合计算
-        temperature = temperature + latEffect + heightEffect + totalNoise +
-                      params.temperatureBias + seasonalEffect;
-
-        // 确保在合理范围内
-        return std::clamp(temperature, 0.0f, 1.0f);
+        // 综合计算，高度影响（每升高降温）在分类时按格子的高度扣除
+        return temperature + latEffect + totalNoise + params.temperatureBias;
     }
 
-    float calculateMoisture(uint32_t x, uint32_t y, const MapConfig& config,
-                            float height, const BiomeParams& params) {
+    // 由三层噪声采样合成海平面处的湿度（不含高度影响、未限制范围）
+    float seaLevelMoisture(int32_t y, const MapConfig& config,
+                           const BiomeParams& params, float noise1, float noise2, float noise3) {
         // 1. 基础湿度 - 直接使用配置值
         float moisture = config.humidity;
 
         // 2. 纬度影响 - 使用加法而不是乘法
-        float latitude = static_cast<float>(y) / config.height;
+        float latitude = std::clamp(static_cast<float>(y) / config.height, 0.0f, 1.0f);
         float latDistance = fabs(latitude - 0.5f); // 距离中心的距离 [0, 0.5]
         float latEffect = -latDistance * 0.3f; // 边缘比中心干燥 0.15
 
-        // 3. 高度影响 - 适度干燥
-        float heightEffect = -height * 0.2f; // 高处干燥，减少幅度
-
-        // 4. 使用多层柏林噪声生成更丰富的湿度分布
-        float noiseX = x / params.moistureScale;
-        float noiseY = y / params.moistureScale;
-
-        // 主噪声层
-        float noise1 = m_noiseGen->applyPerlinNoise(noiseX, noiseY, 0.5f);
-
-        // 细节噪声层
-        float noise2 = m_noiseGen->applyPerlinNoise(noiseX * 2.0f, noiseY * 2.0f, 1.5f) * 0.5f;
-
-        // 大尺度噪声层
-        float noise3 = m_noiseGen->applyPerlinNoise(noiseX * 0.5f, noiseY * 0.5f, 2.5f) * 0.8f;
+        // 3. 多层噪声
+        noise2 *= 0.5f;
+        noise3 *= 0.8f;
 
         // 综合噪声
         float totalNoise = (noise1 * 0.5f + noise2 * 0.3f + noise3 * 0.2f) * 0.4f;
         // 现在 totalNoise 范围大约是 [-0.4, 0.4]
 
-        // 5. 风向/降水带影响 - 模拟降雨带
+        // 4. 风向/降水带影响 - 模拟降雨带
         float precipitationBand = 0.0f;
-        float normalizedY = static_cast<float>(y) / config.height;
+        float normalizedY = latitude;
 
         // 在特定纬度增加湿度（模拟赤道降水带）
         if (normalizedY > 0.4f && normalizedY < 0.6f) {
@@ -684,11 +1404,8 @@ private:
             precipitationBand = 0.08f;
         }
 
-        // 6. 综合所有因素
-        moisture = moisture + latEffect + heightEffect + totalNoise + precipitationBand + params.moistureBias;
-
-        // 确保在合理范围内
-        return std::clamp(moisture, 0.0f, 1.0f);
+        // 5. 综合所有因素，高度影响（高处干燥）在分类时按格子的高度扣除
+        return moisture + latEffect + totalNoise + precipitationBand + params.moistureBias;
     }
     
     TerrainType determineTerrainType(float height, float temperature, float moisture,
@@ -757,8 +1474,11 @@ private:
     }
     
     // 优化河流生成
-    void generateRiverNetwork(TileMap& terrainMap, const HeightMap& heightmap,
-                              const MapConfig& config, const RiverParams& params) {
+    template<typename TileT>
+    void generateRiverNetwork(std::vector<TileT>& terrainMap, const HeightMap& heightmap,
+                              const MapConfig& config, const RiverParams& params,
+                              std::mt19937& rng, ParallelProcessor& processor,
+                              MapProfile* profile = nullptr) {
 
         // 并行寻找河流源点 - 修复版本
         std::vector<std::pair<uint32_t, uint32_t>> riverSources;
@@ -814,11 +1534,16 @@ private:
         };
 
         // 并行查找源点
-        m_parallelProcessor->parallelFor2DChunked(config.width, config.height, chunkSize, findSources);
+        processor.parallelFor2DChunked(config.width, config.height, chunkSize, findSources);
+        MG_PROFILE_COUNT(profile, riverSources, static_cast<uint32_t>(riverSources.size()));
+
+        // 各块合并的先后取决于调度，先按位置排序，抽选结果只取决于种子
+        std::sort(riverSources.begin(), riverSources.end(),
+                  [](const auto& a, const auto& b) { return std::tie(a.second, a.first) < std::tie(b.second, b.first); });
 
         // 限制河流数量
         if (riverSources.size() > params.count) {
-            std::shuffle(riverSources.begin(), riverSources.end(), m_rng);
+            std::shuffle(riverSources.begin(), riverSources.end(), rng);
             riverSources.resize(params.count);
         }
 
@@ -830,19 +1555,18 @@ private:
         // 第二阶段：并行生成每条河流
         // 使用1D并行处理每条河流
         const uint32_t riverCount = static_cast<uint32_t>(riverSources.size());
+        MG_PROFILE_COUNT(profile, riversTraced, riverCount);
 
-        // 创建河流缓冲区，避免直接修改terrainMap
-        std::vector<std::vector<uint32_t>> riverBuffers(config.threadCount);
-        for (auto& buffer : riverBuffers) {
-            buffer.resize(terrainMap.size(), std::numeric_limits<uint32_t>::max());
-        }
+        // 每条工作通道记录自己经过的格子，追踪时不修改terrainMap，
+        // 内存和合并耗时都与河流格数成正比，与地图大小和线程数无关。
+        // 每条河流的随机数由源点位置播种，与哪条通道追踪它无关；合并只把格子标为河流，与顺序无关
+        const uint32_t laneCount = processor.getThreadCount();
+        std::vector<std::vector<uint32_t>> riverCells(laneCount);
 
         std::atomic<uint32_t> nextRiver{0};
-        std::mutex riverStatsMutex;
 
-        auto generateRiver = [&](uint32_t threadId) {
-            std::vector<uint32_t>& buffer = riverBuffers[threadId];
-            std::mt19937 localRng(m_seed + threadId);
+        auto generateRiver = [&](uint32_t lane) {
+            std::vector<uint32_t>& cells = riverCells[lane];
 
             while (true) {
                 uint32_t riverIdx = nextRiver.fetch_add(1);
@@ -850,37 +1574,37 @@ private:
 
                 auto [startX, startY] = riverSources[riverIdx];
 
-                // 生成单条河流到本地缓冲区
-                generateSingleRiverToBuffer(buffer, heightmap, config,
-                                            startX, startY, params, localRng);
+                // 追踪单条河流，格子记入本通道的列表
+                std::mt19937 riverRng(positionHash(config.seed, static_cast<int32_t>(startX),
+                                                   static_cast<int32_t>(startY), 5));
+                traceRiver(cells, heightmap, config, startX, startY, params, riverRng);
             }
         };
 
-        // 启动工作线程
-        std::vector<std::thread> riverWorkers;
-        for (uint32_t t = 0; t < config.threadCount; ++t) {
-            riverWorkers.emplace_back(generateRiver, t);
-        }
-
-        // 主线程也参与工作
-        generateRiver(0);
+        // 通道在引擎的工作线程上运行，不额外创建线程
+        processor.parallelFor1DChunked(laneCount, 1,
+            [&](uint32_t startLane, uint32_t endLane) {
+                for (uint32_t lane = startLane; lane < endLane; ++lane) {
+                    generateRiver(lane);
+                }
+            });
 
-        // 等待所有河流生成完成
-        for (auto& worker : riverWorkers) {
-            worker.join();
+        // 第三阶段：合并各通道的河流格子到地形图
+        size_t cellBytes = 0;
+        for (const auto& cells : riverCells) {
+            cellBytes += cells.capacity() * sizeof(uint32_t);
         }
-
-        // 第三阶段：合并河流缓冲区到地形图
-        mergeRiverBuffers(terrainMap, riverBuffers, config);
+        addStageBytes(profile, GenerationStage::RIVERS, cellBytes);
+        mergeRiverCells(terrainMap, riverCells);
     }
 
-    // 生成单条河流到本地缓冲区（避免竞争）
-    void generateSingleRiverToBuffer(std::vector<uint32_t>& buffer,
-                                     const HeightMap& heightmap,
-                                     const MapConfig& config,
-                                     uint32_t startX, uint32_t startY,
-                                     const RiverParams& params,
-                                     std::mt19937& rng) {
+    // 追踪单条河流（含支流），经过的格子追加到cells，同一格可能出现多次
+    void traceRiver(std::vector<uint32_t>& cells,
+                    const HeightMap& heightmap,
+                    const MapConfig& config,
+                    uint32_t startX, uint32_t startY,
+                    const RiverParams& params,
+                    std::mt19937& rng) {
 
         // 河流点栈
         struct RiverPoint {
@@ -909,9 +1633,9 @@ private:
 
             uint32_t idx = y * config.width + x;
 
-            // 标记为河流（在缓冲区中）
+            // 标记为河流
             float currentHeight = heightmap[idx];
-            buffer[idx] = static_cast<uint32_t>(TerrainType::RIVER);
+            cells.push_back(idx);
 
             // 检查是否到达海洋或已存在的河流
             if (currentHeight < config.seaLevel) {
@@ -1004,30 +1728,20 @@ private:
         }
     }
 
-    // 合并河流缓冲区到地形图
-    void mergeRiverBuffers(TileMap& terrainMap,
-                           const std::vector<std::vector<uint32_t>>& riverBuffers,
-                           const MapConfig& config) {
-
-        // 并行合并缓冲区
-        m_parallelProcessor->parallelFor2D(config.width, config.height,
-                                           [&](uint32_t x, uint32_t y) {
-                                               uint32_t idx = y * config.width + x;
-
-                                               // 检查所有缓冲区
-                                               for (const auto& buffer : riverBuffers) {
-                                                   if (buffer[idx] == static_cast<uint32_t>(TerrainType::RIVER)) {
-                                                       // 标记为河流，但避免覆盖海洋
-                                                       TerrainType current = static_cast<TerrainType>(terrainMap[idx]);
-                                                       if (current != TerrainType::DEEP_OCEAN &&
-                                                           current != TerrainType::SHALLOW_OCEAN &&
-                                                           current != TerrainType::COAST) {
-                                                           terrainMap[idx] = static_cast<uint32_t>(TerrainType::RIVER);
-                                                       }
-                                                       break; // 找到一个河流点即可
-                                                   }
-                                               }
-                                           });
+    // 合并河流格子到地形图，不覆盖海洋；重复的格子和合并顺序不影响结果
+    template<typename TileT>
+    void mergeRiverCells(std::vector<TileT>& terrainMap,
+                         const std::vector<std::vector<uint32_t>>& riverCells) {
+        for (const auto& cells : riverCells) {
+            for (uint32_t idx : cells) {
+                TerrainType current = static_cast<TerrainType>(terrainMap[idx]);
+                if (current != TerrainType::DEEP_OCEAN &&
+                    current != TerrainType::SHALLOW_OCEAN &&
+                    current != TerrainType::COAST) {
+                    terrainMap[idx] = static_cast<TileT>(TerrainType::RIVER);
+                }
+            }
+        }
     }
 
     // 线程安全的单条河流生成
@@ -1042,7 +1756,7 @@ private:
         uint32_t y = startY;
         
         // 使用本地RNG避免线程竞争
-        std::mt19937 localRng(m_seed + startX * 1000 + startY);
+        std::mt19937 localRng(config.seed + startX * 1000 + startY);
         std::uniform_real_distribution<float> dist(0.0f, 1.0f);
         
         while (true) {
@@ -1119,31 +1833,19 @@ private:
         }
     }
 
-    void generateLakesParallel(TileMap& terrainMap, const HeightMap& heightmap,
-                               const MapConfig& config, const RiverParams& params) {
+    template<typename TileT>
+    void generateLakesParallel(std::vector<TileT>& terrainMap, const HeightMap& heightmap,
+                               const MapConfig& config, const RiverParams& params,
+                               std::mt19937& rng, const std::shared_ptr<ParallelProcessor>& processor,
+                               MapProfile* profile = nullptr) {
 
         // 并行寻找低洼区域
         std::vector<std::pair<uint32_t, uint32_t>> depressionPoints;
         std::mutex depressionMutex;
 
-        // 为每个线程创建独立的随机数生成器
-        std::vector<std::mt19937> threadRngs(config.threadCount);
-        for (uint32_t i = 0; i < config.threadCount; ++i) {
-            threadRngs[i] = std::mt19937(m_seed + 321 + i);
-        }
-
-        // 并行寻找低洼区域
-        m_parallelProcessor->parallelFor2DChunked(config.width, config.height, 32,
+        // 并行寻找低洼区域，是否成为湖泊候选由位置哈希决定，与线程和分块无关
+        processor->parallelFor2DChunked(config.width, config.height, 32,
                                                   [&](uint32_t startX, uint32_t startY, uint32_t endX, uint32_t endY) {
-                                                      // 获取当前线程的随机数生成器
-                                                      static thread_local uint32_t threadId = []() {
-                                                          static std::atomic<uint32_t> counter{0};
-                                                          return counter.fetch_add(1);
-                                                      }();
-
-                                                      std::mt19937& lakeRng = threadRngs[threadId % config.threadCount];
-                                                      std::uniform_real_distribution<float> lakeDist(0.0f, 1.0f);
-
                                                       std::vector<std::pair<uint32_t, uint32_t>> localDepressions;
 
                                                       // 确保边界安全
@@ -1187,7 +1889,9 @@ private:
                                                                   }
                                                               }
 
-                                                              if (isDepression && lakeDist(lakeRng) < params.lakeProbability) {
+                                                              if (isDepression &&
+                                                                  positionUnit(config.seed, static_cast<int32_t>(x),
+                                                                               static_cast<int32_t>(y), 6) < params.lakeProbability) {
                                                                   localDepressions.emplace_back(x, y);
                                                               }
                                                           }
@@ -1201,85 +1905,89 @@ private:
                                                       }
                                                   });
 
+        MG_PROFILE_COUNT(profile, lakeCandidates, static_cast<uint32_t>(depressionPoints.size()));
+
         // 限制湖泊数量，避免过多
         const uint32_t maxLakes = std::min(static_cast<uint32_t>(depressionPoints.size()),
-                                           static_cast<uint32_t>((config.width * config.height) * 0.0001f));
+                                           static_cast<uint32_t>((config.width * config.height) * kLakeDensity));
 
         if (maxLakes == 0) return;
 
-        // 随机选择湖泊中心点
-        std::shuffle(depressionPoints.begin(), depressionPoints.end(), m_rng);
+        // 随机选择湖泊中心点；各块合并的先后取决于调度，先按位置排序
+        std::sort(depressionPoints.begin(), depressionPoints.end(),
+                  [](const auto& a, const auto& b) { return std::tie(a.second, a.first) < std::tie(b.second, b.first); });
+        std::shuffle(depressionPoints.begin(), depressionPoints.end(), rng);
         depressionPoints.resize(maxLakes);
 
-        // 并行生成湖泊（使用任务队列）
-        generateLakesParallelTasks(terrainMap, heightmap, config, params, depressionPoints);
+        // 并行生成湖泊
+        generateLakesParallelTasks(terrainMap, config, params, depressionPoints, processor, profile);
     }
 
-    // 使用任务队列并行生成湖泊
-    void generateLakesParallelTasks(TileMap& terrainMap, const HeightMap& heightmap,
-                                    const MapConfig& config, const RiverParams& params,
-                                    const std::vector<std::pair<uint32_t, uint32_t>>& lakeCenters) {
-
-        // 创建任务队列
-        std::queue<uint32_t> taskQueue;
-        for (uint32_t i = 0; i < lakeCenters.size(); ++i) {
-            taskQueue.push(i);
-        }
-
-        std::mutex queueMutex;
-        std::mutex terrainMutex;
-
-        // 工作线程函数
-        auto lakeWorker = [&]() {
-            std::mt19937 localRng(m_seed + std::hash<std::thread::id>{}(std::this_thread::get_id()));
-
-            while (true) {
-                uint32_t taskIdx;
-
-                // 获取任务
-                {
-                    std::lock_guard<std::mutex> lock(queueMutex);
-                    if (taskQueue.empty()) break;
-                    taskIdx = taskQueue.front();
-                    taskQueue.pop();
-                }
-
-                auto [centerX, centerY] = lakeCenters[taskIdx];
-
-                // 生成湖泊到本地缓冲区
-                std::vector<uint32_t> lakeBuffer(terrainMap.size(), std::numeric_limits<uint32_t>::max());
-                generateLakeToBuffer(lakeBuffer, heightmap, config, centerX, centerY, params, localRng);
-
-                // 合并到主地形图
-                {
-                    std::lock_guard<std::mutex> lock(terrainMutex);
-                    mergeLakeBuffer(terrainMap, lakeBuffer, config);
+    // 并行生成湖泊：先把每个湖泊画进各自的外接框栅格，形状随机数由湖心位置播种；
+    // 再按行分带并行合并，每个带按湖泊序号依次写入自己的行，后写的覆盖先写的，无需加锁
+    template<typename TileT>
+    void generateLakesParallelTasks(std::vector<TileT>& terrainMap, const MapConfig& config,
+                                    const RiverParams& params,
+                                    const std::vector<std::pair<uint32_t, uint32_t>>& lakeCenters,
+                                    const std::shared_ptr<ParallelProcessor>& processor,
+                                    MapProfile* profile = nullptr) {
+        std::shared_ptr<NoiseGenerator> noiseGen = noiseGenerator(config.seed, processor);
+        const uint32_t lakeCount = static_cast<uint32_t>(lakeCenters.size());
+        std::vector<LakeRaster> lakes(lakeCount);
+
+        processor->parallelFor1DChunked(lakeCount, 1,
+            [&](uint32_t start, uint32_t end) {
+                for (uint32_t i = start; i < end; ++i) {
+                    auto [centerX, centerY] = lakeCenters[i];
+                    std::mt19937 lakeRng(positionHash(config.seed, static_cast<int32_t>(centerX),
+                                                      static_cast<int32_t>(centerY), 4));
+                    rasterizeLake(*noiseGen, lakes[i], config, centerX, centerY, params, lakeRng);
                 }
-            }
-        };
-
-        // 启动工作线程
-        uint32_t numWorkers = std::min(config.threadCount, static_cast<uint32_t>(lakeCenters.size()));
-        std::vector<std::thread> workers;
+            });
 
-        for (uint32_t i = 0; i < numWorkers; ++i) {
-            workers.emplace_back(lakeWorker);
+        size_t rasterBytes = 0;
+        for (const auto& lake : lakes) {
+            rasterBytes += lake.tiles.capacity();
         }
+        MG_PROFILE_COUNT(profile, lakesPlaced, lakeCount);
+        setStageThreads(profile, GenerationStage::LAKES, processor->getThreadCount());
+        addStageBytes(profile, GenerationStage::LAKES, rasterBytes);
+
+        processor->parallelFor1DChunked(config.height, kLakeMergeRows,
+            [&](uint32_t rowStart, uint32_t rowEnd) {
+                for (const auto& lake : lakes) {
+                    int32_t yBegin = std::max(lake.y0, static_cast<int32_t>(rowStart));
+                    int32_t yEnd = std::min(lake.y0 + static_cast<int32_t>(lake.height),
+                                            static_cast<int32_t>(rowEnd));
+                    for (int32_t y = yBegin; y < yEnd; ++y) {
+                        TileT* row = terrainMap.data() + static_cast<size_t>(y) * config.width;
+                        for (uint32_t dx = 0; dx < lake.width; ++dx) {
+                            int32_t x = lake.x0 + static_cast<int32_t>(dx);
+                            applyLakeTile(row[x], lake.at(x, y));
+                        }
+                    }
+                }
+            });
+    }
 
-        // 主线程也参与工作
-        lakeWorker();
-
-        // 等待所有工作线程完成
-        for (auto& worker : workers) {
-            worker.join();
+    // 湖泊格写入地形：只覆盖陆地，并且不是河流
+    template<typename TileT>
+    static void applyLakeTile(TileT& tile, uint8_t lake) {
+        if (lake == kNoTile) return;
+        TerrainType current = static_cast<TerrainType>(tile);
+        if (current != TerrainType::DEEP_OCEAN &&
+            current != TerrainType::SHALLOW_OCEAN &&
+            current != TerrainType::COAST &&
+            current != TerrainType::RIVER) {
+            tile = static_cast<TileT>(lake);
         }
     }
 
-    // 生成湖泊到缓冲区
-    void generateLakeToBuffer(std::vector<uint32_t>& buffer, const HeightMap& heightmap,
-                              const MapConfig& config, uint32_t centerX, uint32_t centerY,
-                              const RiverParams& params, std::mt19937& rng) {
-
+    // 把湖泊画进外接框栅格，外接框为湖心周围1.5倍湖泊尺寸并裁剪到地图内
+    void rasterizeLake(NoiseGenerator& noiseGen, LakeRaster& lake,
+                       const MapConfig& config, uint32_t centerX, uint32_t centerY,
+                       const RiverParams& params, std::mt19937& rng,
+                       int32_t worldOffsetX = 0, int32_t worldOffsetY = 0) {
         std::uniform_real_distribution<float> sizeDist(params.minLakeSize, params.maxLakeSize);
         std::uniform_real_distribution<float> noiseDist(0.0f, 1.0f);
 
@@ -1310,6 +2018,12 @@ private:
         endX = std::min(endX, static_cast<int>(config.width) - 1);
         endY = std::min(endY, static_cast<int>(config.height) - 1);
 
+        lake.x0 = startX;
+        lake.y0 = startY;
+        lake.width = static_cast<uint32_t>(std::max(endX - startX + 1, 0));
+        lake.height = static_cast<uint32_t>(std::max(endY - startY + 1, 0));
+        lake.tiles.assign(static_cast<size_t>(lake.width) * lake.height, kNoTile);
+
         // 处理湖泊区域
         for (int y = startY; y <= endY; ++y) {
             for (int x = startX; x <= endX; ++x) {
@@ -1329,8 +2043,8 @@ private:
                     normalizedDist = dist / baseSize;
                 }
 
-                // 应用不规则性
-                float angle = std::atan2(dy, dx);
+                // 应用不规则性（单精度反正切，双精度版本是逐格开销的大头）
+                float angle = std::atan2(static_cast<float>(dy), static_cast<float>(dx));
                 float noiseValue = 0.0f;
 
                 switch (lakeType) {
@@ -1348,9 +2062,9 @@ private:
                 }
 
                 // 应用柏林噪声增加细节
-                float nx = x / 10.0f;
-                float ny = y / 10.0f;
-                float perlinNoise = m_noiseGen->applyPerlinNoise(nx, ny) * 0.5f + 0.5f;
+                float nx = (x + worldOffsetX) / 10.0f;
+                float ny = (y + worldOffsetY) / 10.0f;
+                float perlinNoise = noiseGen.applyPerlinNoise(nx, ny) * 0.5f + 0.5f;
                 noiseValue *= (0.7f + perlinNoise * 0.3f);
 
                 // 添加随机扰动
@@ -1365,50 +2079,30 @@ private:
 
                 // 如果这个位置在湖泊内
                 if (alpha > 0.5f) {
-                    uint32_t idx = y * config.width + x;
+                    uint8_t& tile = lake.tiles[static_cast<size_t>(y - startY) * lake.width + (x - startX)];
 
                     // 根据alpha值决定是湖泊还是浅滩
                     if (alpha > 0.8f) {
-                        buffer[idx] = static_cast<uint32_t>(TerrainType::LAKE);
+                        tile = static_cast<uint8_t>(TerrainType::LAKE);
                     } else {
                         // 边缘区域可能是浅滩
                         if (localDist(rng) < 0.3f) {
-                            buffer[idx] = static_cast<uint32_t>(TerrainType::BEACH);
+                            tile = static_cast<uint8_t>(TerrainType::BEACH);
                         } else {
-                            buffer[idx] = static_cast<uint32_t>(TerrainType::LAKE);
+                            tile = static_cast<uint8_t>(TerrainType::LAKE);
                         }
                     }
 
                     // 随机添加小岛
                     if (alpha < 0.95f && localDist(rng) < 0.02f) {
-                        buffer[idx] = static_cast<uint32_t>(TerrainType::PLAIN);
+                        tile = static_cast<uint8_t>(TerrainType::PLAIN);
                     }
                 }
             }
         }
 
-        // 平滑湖泊边界（在缓冲区中进行）
-        smoothLakeBoundaryInBuffer(buffer, config, centerX, centerY, baseSize);
-    }
-
-    // 合并湖泊缓冲区到地形图
-    void mergeLakeBuffer(TileMap& terrainMap, const std::vector<uint32_t>& lakeBuffer,
-                         const MapConfig& config) {
-
-        for (uint32_t i = 0; i < terrainMap.size(); ++i) {
-            if (lakeBuffer[i] != std::numeric_limits<uint32_t>::max()) {
-                TerrainType current = static_cast<TerrainType>(terrainMap[i]);
-
-                // 只覆盖陆地，并且不是河流
-                if (current != TerrainType::DEEP_OCEAN &&
-                    current != TerrainType::SHALLOW_OCEAN &&
-                    current != TerrainType::COAST &&
-                    current != TerrainType::RIVER) {
-
-                    terrainMap[i] = lakeBuffer[i];
-                }
-            }
-        }
+        // 平滑湖泊边界（在栅格中进行）
+        smoothLakeBoundary(lake, config, centerX, centerY, baseSize);
     }
 
     float smoothstep(float edge0, float edge1, float x) {
@@ -1416,95 +2110,125 @@ private:
         return x * x * (3.0f - 2.0f * x);
     }
 
-    // 在缓冲区中平滑湖泊边界
-    void smoothLakeBoundaryInBuffer(std::vector<uint32_t>& buffer, const MapConfig& config,
-                                    uint32_t centerX, uint32_t centerY, float lakeSize) {
+    // 在栅格中平滑湖泊边界：先判定要去掉的孤立湖泊格，扫描结束后再统一修改；
+    // 邻居按地图范围计数，栅格外的邻居不是湖泊
+    void smoothLakeBoundary(LakeRaster& lake, const MapConfig& config,
+                            uint32_t centerX, uint32_t centerY, float lakeSize) {
 
-        std::vector<uint32_t> tempBuffer = buffer;
+        std::vector<size_t> isolated;
         int radius = static_cast<int>(lakeSize) + 2;
+        const int lakeEndX = lake.x0 + static_cast<int>(lake.width);
+        const int lakeEndY = lake.y0 + static_cast<int>(lake.height);
+        const uint8_t lakeTile = static_cast<uint8_t>(TerrainType::LAKE);
 
-        // 计算边界
-        int startX = std::max(static_cast<int>(centerX) - radius, 0);
-        int startY = std::max(static_cast<int>(centerY) - radius, 0);
-        int endX = std::min(static_cast<int>(centerX) + radius, static_cast<int>(config.width) - 1);
-        int endY = std::min(static_cast<int>(centerY) + radius, static_cast<int>(config.height) - 1);
+        // 平滑范围与栅格的交集
+        int startX = std::max(static_cast<int>(centerX) - radius, lake.x0);
+        int startY = std::max(static_cast<int>(centerY) - radius, lake.y0);
+        int endX = std::min(static_cast<int>(centerX) + radius, lakeEndX - 1);
+        int endY = std::min(static_cast<int>(centerY) + radius, lakeEndY - 1);
 
         for (int y = startY; y <= endY; ++y) {
             for (int x = startX; x <= endX; ++x) {
-                uint32_t idx = y * config.width + x;
+                if (lake.at(x, y) != lakeTile) continue;
 
-                if (buffer[idx] == static_cast<uint32_t>(TerrainType::LAKE)) {
-                    // 检查周围8个邻居
-                    int lakeNeighbors = 0;
-                    int totalNeighbors = 0;
+                // 检查周围8个邻居
+                int lakeNeighbors = 0;
+                int totalNeighbors = 0;
 
-                    for (int ndy = -1; ndy <= 1; ndy++) {
-                        for (int ndx = -1; ndx <= 1; ndx++) {
-                            if (ndx == 0 && ndy == 0) continue;
+                for (int ndy = -1; ndy <= 1; ndy++) {
+                    for (int ndx = -1; ndx <= 1; ndx++) {
+                        if (ndx == 0 && ndy == 0) continue;
 
-                            int nx = x + ndx;
-                            int ny = y + ndy;
+                        int nx = x + ndx;
+                        int ny = y + ndy;
 
-                            if (nx >= 0 && nx < static_cast<int>(config.width) &&
-                                ny >= 0 && ny < static_cast<int>(config.height)) {
-                                totalNeighbors++;
-                                uint32_t nIdx = ny * config.width + nx;
-
-                                if (buffer[nIdx] == static_cast<uint32_t>(TerrainType::LAKE)) {
-                                    lakeNeighbors++;
-                                }
+                        if (nx >= 0 && nx < static_cast<int>(config.width) &&
+                            ny >= 0 && ny < static_cast<int>(config.height)) {
+                            totalNeighbors++;
+                            if (nx >= lake.x0 && nx < lakeEndX && ny >= lake.y0 && ny < lakeEndY &&
+                                lake.at(nx, ny) == lakeTile) {
+                                lakeNeighbors++;
                             }
                         }
                     }
+                }
 
-                    // 如果湖泊单元格被陆地包围太多，可能是孤岛
-                    if (lakeNeighbors < 3 && totalNeighbors > 0) {
-                        float lakeRatio = static_cast<float>(lakeNeighbors) / totalNeighbors;
-                        if (lakeRatio < 0.4f) {
-                            tempBuffer[idx] = static_cast<uint32_t>(TerrainType::PLAIN);
-                        }
+                // 如果湖泊单元格被陆地包围太多，可能是孤岛
+                if (lakeNeighbors < 3 && totalNeighbors > 0) {
+                    float lakeRatio = static_cast<float>(lakeNeighbors) / totalNeighbors;
+                    if (lakeRatio < 0.4f) {
+                        isolated.push_back(static_cast<size_t>(y - lake.y0) * lake.width + (x - lake.x0));
                     }
                 }
             }
         }
 
-        buffer = tempBuffer;
+        for (size_t idx : isolated) {
+            lake.tiles[idx] = static_cast<uint8_t>(TerrainType::PLAIN);
+        }
     }
     
-    // 优化统计计算
-    void calculateStatistics(MapData& data) {
+    // 将float高度按config.heightFormat编码为16位并释放float缓冲
+    void storeHeights(MapData& data, ParallelProcessor& processor) {
+        HeightFormat format = data.config.heightFormat;
+        if (format == HeightFormat::FLOAT32) {
+            return;
+        }
+        
+        StageTimer timer(&data.profile, GenerationStage::ENCODE, processor.getThreadCount());
+        const uint32_t count = static_cast<uint32_t>(data.heightMap.size());
+        data.heightSamples.resize(count);
+        addStageBytes(&data.profile, GenerationStage::ENCODE, size_t(count) * sizeof(uint16_t));
+        processor.parallelFor1DChunked(count, 16384,
+            [&](uint32_t startIdx, uint32_t endIdx) {
+                encodeHeights(format, data.heightMap.data() + startIdx,
+                              data.heightSamples.data() + startIdx, endIdx - startIdx);
+            });
+        HeightMap().swap(data.heightMap);
+    }
+    
+public:
+    // 优化统计计算：按行带分块，每块只写自己的局部统计，合并结果与线程调度无关
+    void calculateStatistics(MapData& data, ParallelProcessor& processor) {
+        StageTimer timer(&data.profile, GenerationStage::STATISTICS, processor.getThreadCount());
         auto& stats = data.stats;
+        const uint32_t width = data.config.width;
+        const uint32_t height = data.config.height;
+        TileLayerView terrainLayer = data.terrain();
+        HeightLayerView heightLayer = data.heights();
         
-        // 为每个线程创建本地统计
-        uint32_t threadCount = m_parallelProcessor->getThreadCount();
-        std::vector<MapData::Statistics> localStats(threadCount);
+        const uint32_t rowsPerBand = std::max(1u, 16384 / std::max(1u, width));
+        const uint32_t numBands = (height + rowsPerBand - 1) / rowsPerBand;
+        std::vector<MapData::Statistics> localStats(numBands, MapData::Statistics());
+        std::vector<double> heightSums(numBands, 0.0);
+        addStageBytes(&data.profile, GenerationStage::STATISTICS,
+                      numBands * (sizeof(MapData::Statistics) + sizeof(double)));
         
-        // 初始化本地统计
         for (auto& local : localStats) {
             local.minHeight = std::numeric_limits<float>::max();
             local.maxHeight = std::numeric_limits<float>::lowest();
         }
         
         // 并行计算统计
-        m_parallelProcessor->parallelFor2DChunked(data.config.width, data.config.height, 64,
-            [&](uint32_t startX, uint32_t startY, uint32_t endX, uint32_t endY) {
-                uint32_t threadId = startY / (data.config.height / threadCount);
-                auto& local = localStats[threadId];
-                
-                float localTotalHeight = 0.0f;
-                uint32_t localCount = 0;
+        processor.parallelFor1DChunked(height, rowsPerBand,
+            [&](uint32_t startY, uint32_t endY) {
+                uint32_t band = startY / rowsPerBand;
+                auto& local = localStats[band];
+                double localTotalHeight = 0.0;
+                std::vector<float> row(width);
                 
                 for (uint32_t y = startY; y < endY; ++y) {
-                    for (uint32_t x = startX; x < endX; ++x) {
-                        uint32_t idx = y * data.config.width + x;
-                        float height = data.heightMap[idx];
+                    heightLayer.decode(static_cast<size_t>(y) * width, width, row.data());
+                    
+                    for (uint32_t x = 0; x < width; ++x) {
+                        size_t idx = static_cast<size_t>(y) * width + x;
+                        float height = row[x];
                         
                         localTotalHeight += height;
                         local.minHeight = std::min(local.minHeight, height);
                         local.maxHeight = std::max(local.maxHeight, height);
-                        localCount++;
                         
-                        TerrainType terrain = static_cast<TerrainType>(data.terrainMap[idx]);
+                        TerrainType terrain = terrainLayer.terrain(idx);
                         
                         switch (terrain) {
                             case TerrainType::DEEP_OCEAN:
@@ -1531,18 +2255,17 @@ private:
                     }
                 }
                 
-                // 计算本地平均高度
-                if (localCount > 0) {
-                    local.averageHeight = localTotalHeight / localCount;
-                }
+                heightSums[band] = localTotalHeight;
             });
         
         // 合并统计结果
         stats = MapData::Statistics();
-        float totalWeightedHeight = 0.0f;
-        uint32_t totalCount = 0;
+        stats.minHeight = std::numeric_limits<float>::max();
+        stats.maxHeight = std::numeric_limits<float>::lowest();
+        double totalHeight = 0.0;
         
-        for (const auto& local : localStats) {
+        for (uint32_t band = 0; band < numBands; ++band) {
+            const auto& local = localStats[band];
             stats.waterTiles += local.waterTiles;
             stats.landTiles += local.landTiles;
             stats.forestTiles += local.forestTiles;
@@ -1551,16 +2274,16 @@ private:
             
             stats.minHeight = std::min(stats.minHeight, local.minHeight);
             stats.maxHeight = std::max(stats.maxHeight, local.maxHeight);
-            
-            uint32_t localCount = local.waterTiles + local.landTiles;
-            totalWeightedHeight += local.averageHeight * localCount;
-            totalCount += localCount;
+            totalHeight += heightSums[band];
         }
         
+        size_t totalCount = static_cast<size_t>(width) * height;
         if (totalCount > 0) {
-            stats.averageHeight = totalWeightedHeight / totalCount;
+            stats.averageHeight = static_cast<float>(totalHeight / totalCount);
         } else {
             stats.averageHeight = 0.0f;
+            stats.minHeight = 0.0f;
+            stats.maxHeight = 0.0f;
         }
     }
 };
@@ -1581,23 +2304,71 @@ MapGeneratorInternal::generateBatch(const MapConfig& baseConfig, uint32_t count)
     return m_impl->generateBatch(baseConfig, count);
 }
 
+uint32_t MapGeneratorInternal::generateBatchStreaming(const MapConfig& baseConfig, uint32_t count,
+                                                      const MapReadyCallback& onMapReady,
+                                                      uint32_t maxInFlight) {
+    return m_impl->generateBatchStreaming(baseConfig, count, onMapReady, maxInFlight);
+}
+
 HeightMap MapGeneratorInternal::generateHeightmapOnly(const MapConfig& config) {
-    return m_impl->generateHeightmapOnly(config);
+    return m_impl->generateHeightmapOnly(config, m_impl->prepare(config));
 }
 
 TileMap MapGeneratorInternal::generateTerrainOnly(const HeightMap& heightmap, 
                                                  const MapConfig& config) {
-    return m_impl->generateTerrainOnly(heightmap, config);
+    return m_impl->generateTerrainOnly<uint32_t>(heightmap, config, m_impl->prepare(config));
+}
+
+CompactTileMap MapGeneratorInternal::generateCompactTerrainOnly(const HeightMap& heightmap,
+                                                               const MapConfig& config) {
+    return m_impl->generateTerrainOnly<uint8_t>(heightmap, config, m_impl->prepare(config));
 }
 
 void MapGeneratorInternal::applyErosion(HeightMap& heightmap, const MapConfig& config,
                                        const ErosionParams& params) {
-    m_impl->applyErosion(heightmap, config, params);
+    std::shared_ptr<ParallelProcessor> processor = m_impl->prepare(config);
+    m_impl->applyErosion(heightmap, config, params, *processor);
 }
 
 void MapGeneratorInternal::generateRivers(TileMap& terrainMap, const HeightMap& heightmap,
                                          const MapConfig& config, const RiverParams& params) {
-    m_impl->generateRivers(terrainMap, heightmap, config, params);
+    m_impl->generateRivers(terrainMap, heightmap, config, params, m_impl->prepare(config));
+}
+
+void MapGeneratorInternal::generateRivers(CompactTileMap& terrainMap, const HeightMap& heightmap,
+                                         const MapConfig& config, const RiverParams& params) {
+    m_impl->generateRivers(terrainMap, heightmap, config, params, m_impl->prepare(config));
+}
+
+void MapGeneratorInternal::generateLakes(TileMap& terrainMap, const HeightMap& heightmap,
+                                        const MapConfig& config, const RiverParams& params) {
+    m_impl->generateLakes(terrainMap, heightmap, config, params, m_impl->prepare(config));
+}
+
+void MapGeneratorInternal::calculateStatistics(MapData& data) {
+    m_impl->calculateStatistics(data, *m_impl->prepare(data.config));
+}
+
+std::shared_ptr<MapData> MapGeneratorInternal::generateChunk(int32_t chunkX, int32_t chunkY,
+                                                             uint32_t chunkSize,
+                                                             const MapConfig& config) {
+    return m_impl->generateChunk(chunkX, chunkY, chunkSize, config);
+}
+
+MapCacheStats MapGeneratorInternal::cacheStats() const {
+    return m_impl->cacheStats();
+}
+
+void MapGeneratorInternal::setCacheBudget(size_t bytes) {
+    m_impl->setCacheBudget(bytes);
+}
+
+void MapGeneratorInternal::clearCache() {
+    m_impl->clearCaches();
+}
+
+MapScratchStats MapGeneratorInternal::scratchStats() const {
+    return m_impl->scratchPool().stats();
 }
 
 } // namespace internal
@@ -20,16 +20,41 @@ public:
     std::vector<std::shared_ptr<MapData>> generateBatch(
         const MapConfig& baseConfig, uint32_t count);
     
+    // 流式批量生成，地图完成即回调，结果不进入缓存
+    uint32_t generateBatchStreaming(const MapConfig& baseConfig, uint32_t count,
+                                    const MapReadyCallback& onMapReady, uint32_t maxInFlight);
+    
     // 分步骤生成
     HeightMap generateHeightmapOnly(const MapConfig& config);
     TileMap generateTerrainOnly(const HeightMap& heightmap,
                                const MapConfig& config);
+    CompactTileMap generateCompactTerrainOnly(const HeightMap& heightmap,
+                                             const MapConfig& config);
     
     // 高级功能
     void applyErosion(HeightMap& heightmap, const MapConfig& config,
                       const ErosionParams& params);
     void generateRivers(TileMap& terrainMap, const HeightMap& heightmap,
                        const MapConfig& config, const RiverParams& params);
+    void generateRivers(CompactTileMap& terrainMap, const HeightMap& heightmap,
+                       const MapConfig& config, const RiverParams& params);
+    // 单独运行湖泊阶段（TRACED模型），随机序列从种子开始
+    void generateLakes(TileMap& terrainMap, const HeightMap& heightmap,
+                       const MapConfig& config, const RiverParams& params);
+    // 按data中的高度和地形重新计算统计信息
+    void calculateStatistics(MapData& data);
+    
+    // 分块生成：chunkSize x chunkSize的块，左上角位于世界坐标(chunkX, chunkY) * chunkSize
+    std::shared_ptr<MapData> generateChunk(int32_t chunkX, int32_t chunkY, uint32_t chunkSize,
+                                           const MapConfig& config);
+    
+    // 结果缓存
+    MapCacheStats cacheStats() const;
+    void setCacheBudget(size_t bytes);
+    void clearCache();
+    
+    // 临时缓冲区池
+    MapScratchStats scratchStats() const;
     
 private:
     class Impl;
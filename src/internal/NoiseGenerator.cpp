@@ -1,12 +1,16 @@
 #define _USE_MATH_DEFINES
 #include "NoiseGenerator.h"
 #include "ParallelUtils.h"
+#include "NoiseKernels.h"
+#include "ScratchPool.h"
+#include "Smoothing.h"
 #include <algorithm>
 #include <cmath>
 #include <queue>
 #include <random>
 #include <functional>
 #include <set>
+#include <limits>
 
 namespace MapGenerator {
 namespace internal {
@@ -38,52 +42,26 @@ public:
         }
     }
     
+    // z为整数时三维噪声退化为二维切片，自动走二维路径
     float noise(float x, float y, float z = 0) const {
-        int X = (int)floor(x) & 255;
-        int Y = (int)floor(y) & 255;
-        int Z = (int)floor(z) & 255;
-
-        x -= floor(x);
-        y -= floor(y);
-        z -= floor(z);
-
-        float u = fade(x);
-        float v = fade(y);
-        float w = fade(z);
-
-        int A = p[X] + Y;
-        int AA = p[A] + Z;
-        int AB = p[A + 1] + Z;
-        int B = p[X + 1] + Y;
-        int BA = p[B] + Z;
-        int BB = p[B + 1] + Z;
-
-        // 修正：使用正确的梯度计算
-        return lerp(w, lerp(v, lerp(u, grad3(p[AA], x, y, z),
-                                       grad3(p[BA], x - 1, y, z)),
-                               lerp(u, grad3(p[AB], x, y - 1, z),
-                                       grad3(p[BB], x - 1, y - 1, z))),
-                       lerp(v, lerp(u, grad3(p[AA + 1], x, y, z - 1),
-                                       grad3(p[BA + 1], x - 1, y, z - 1)),
-                               lerp(u, grad3(p[AB + 1], x, y - 1, z - 1),
-                                       grad3(p[BB + 1], x - 1, y - 1, z - 1))));
+        if (std::fabs(z) < 16777216.0f && z == static_cast<float>(static_cast<int32_t>(z))) {
+            return perlinNoise2DScalar(p, x, y, static_cast<int32_t>(z));
+        }
+        return perlinNoiseScalar(p, x, y, z);
     }
-    
-private:
-    static float fade(float t) {
-        return t * t * t * (t * (t * 6 - 15) + 10);
+
+    // 二维柏林噪声，layer为整数切片编号
+    float noise2D(float x, float y, int layer = 0) const {
+        return perlinNoise2DScalar(p, x, y, layer);
     }
-    
-    static float lerp(float t, float a, float b) {
-        return a + t * (b - a);
+
+    // 批量求值同一z层上的一组采样点，按CPU指令集选择SIMD内核
+    void noiseBatch(const float* xs, const float* ys, float z, float* out, size_t n) const {
+        perlinNoiseBatch(p, xs, ys, z, out, n);
     }
-    
-    // 使用原始的Perlin噪声梯度计算
-    static float grad3(int hash, float x, float y, float z) {
-        int h = hash & 15;                      // 将低4位作为梯度选择
-        float u = h < 8 ? x : y;                 // 根据第0位选择x或y
-        float v = h < 4 ? y : (h == 12 || h == 14 ? x : z); // 根据第1-2位选择
-        return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v); // 根据低2位决定符号
+
+    void noise2DBatch(const float* xs, const float* ys, int layer, float* out, size_t n) const {
+        perlinNoise2DBatch(p, xs, ys, layer, out, n);
     }
 };
 
@@ -181,244 +159,313 @@ private:
 };
 
 // Worley噪声（细胞噪声）
+// 每个单位格内的特征点由格点坐标哈希得到，不存储网格，任意频率下都没有回绕接缝；
+// period大于0时格点坐标按周期取模，生成的噪声以period格为周期无缝平铺
 class WorleyNoise {
-private:
-    struct Point {
-        float x, y;
-        Point(float x = 0, float y = 0) : x(x), y(y) {}
-    };
-    
-    std::vector<std::vector<Point>> grid;
-    int gridSize;
-    
 public:
-    WorleyNoise(uint32_t seed, int gridSize = 10) : gridSize(gridSize) {
-        std::mt19937 rng(seed);
-        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-        
-        grid.resize(gridSize);
-        for (auto& row : grid) {
-            row.resize(gridSize);
-            for (auto& point : row) {
-                point.x = dist(rng);
-                point.y = dist(rng);
-            }
-        }
-    }
-    
-    float noise(float x, float y, int feature = 0) const {
-        // 归一化到[0,1]
-        x = fmod(fabs(x), 1.0f);
-        y = fmod(fabs(y), 1.0f);
-        
-        int cellX = (int)(x * gridSize) % gridSize;
-        int cellY = (int)(y * gridSize) % gridSize;
-        
-        std::vector<float> distances;
-        
-        // 检查当前单元格和相邻单元格
+    explicit WorleyNoise(uint32_t seed) : m_seed(seed) {}
+
+    // 计算最近(F1)与次近(F2)特征点的距离，单位为格
+    void distances(float x, float y, uint32_t layer, uint32_t period, float& f1, float& f2) const {
+        int cellX = static_cast<int>(std::floor(x));
+        int cellY = static_cast<int>(std::floor(y));
+        float fx = x - cellX;
+        float fy = y - cellY;
+
+        // 固定大小的F1/F2跟踪，比较平方距离
+        float d1 = std::numeric_limits<float>::max();
+        float d2 = std::numeric_limits<float>::max();
+
         for (int dy = -1; dy <= 1; dy++) {
             for (int dx = -1; dx <= 1; dx++) {
-                int nx = (cellX + dx + gridSize) % gridSize;
-                int ny = (cellY + dy + gridSize) % gridSize;
-                
-                float pointX = grid[ny][nx].x + dx;
-                float pointY = grid[ny][nx].y + dy;
-                
-                float distance = sqrt(pow(x * gridSize - (cellX + pointX), 2) + 
-                                      pow(y * gridSize - (cellY + pointY), 2));
-                distances.push_back(distance);
+                uint32_t h = hashCell(cellX + dx, cellY + dy, layer, period);
+                float px = dx + (h & 0xFFFF) * (1.0f / 65536.0f) - fx;
+                float py = dy + (h >> 16) * (1.0f / 65536.0f) - fy;
+                float d = px * px + py * py;
+
+                if (d < d1) {
+                    d2 = d1;
+                    d1 = d;
+                } else if (d < d2) {
+                    d2 = d;
+                }
             }
         }
-        
-        std::sort(distances.begin(), distances.end());
-        
-        if (feature < distances.size()) {
-            return 1.0f - distances[feature] / (sqrt(2.0f) * gridSize);
+
+        f1 = std::sqrt(d1);
+        f2 = std::sqrt(d2);
+    }
+
+    // feature为0时取F1，否则取F2；结果为1 - 距离，特征点处为1，一格以外为0
+    float noise(float x, float y, int feature = 0, uint32_t layer = 0, uint32_t period = 0) const {
+        float f1, f2;
+        distances(x, y, layer, period, f1, f2);
+        float distance = feature == 0 ? f1 : f2;
+        return std::clamp(1.0f - distance, 0.0f, 1.0f);
+    }
+
+private:
+    uint32_t hashCell(int cellX, int cellY, uint32_t layer, uint32_t period) const {
+        if (period > 0) {
+            int p = static_cast<int>(period);
+            cellX = ((cellX % p) + p) % p;
+            cellY = ((cellY % p) + p) % p;
         }
-        return 0.0f;
+
+        // 整数混合哈希（lowbias32）
+        uint32_t h = static_cast<uint32_t>(cellX) * 0x8da6b343u
+                   ^ static_cast<uint32_t>(cellY) * 0xd8163841u
+                   ^ (m_seed + layer * 0x9e3779b9u);
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return h;
     }
+
+    uint32_t m_seed;
 };
 
 // NoiseGenerator::Impl 实现
 class NoiseGenerator::Impl {
 private:
+    // 融合高度场管线的块边长，块内的批量缓冲区放在栈上
+    static constexpr uint32_t kFusedTileSize = 64;
+
     std::mt19937 m_rng;
     uint32_t m_seed;
     PerlinNoiseImp m_perlin;
     SimplexNoiseImpl m_simplex;
-    std::unique_ptr<ParallelProcessor> m_parallelProcessor;
+    WorleyNoise m_worley;
+    std::shared_ptr<ParallelProcessor> m_parallelProcessor;
+    std::shared_ptr<ScratchPool> m_scratch;
 
 public:
-    Impl(uint32_t seed) 
-        : m_seed(seed), m_rng(seed), m_perlin(seed), m_simplex(seed) 
-        , m_parallelProcessor(std::make_unique<ParallelProcessor>(std::thread::hardware_concurrency()))
+    Impl(uint32_t seed, std::shared_ptr<ParallelProcessor> processor,
+         std::shared_ptr<ScratchPool> scratch) 
+        : m_seed(seed), m_rng(seed), m_perlin(seed), m_simplex(seed), m_worley(seed)
+        , m_parallelProcessor(processor ? std::move(processor)
+                                        : std::make_shared<ParallelProcessor>(std::thread::hardware_concurrency()))
+        , m_scratch(scratch ? std::move(scratch) : std::make_shared<ScratchPool>())
     {
     }
     
+    void setParallelProcessor(std::shared_ptr<ParallelProcessor> processor) {
+        if (processor) {
+            m_parallelProcessor = std::move(processor);
+        }
+    }
+    
     HeightMap generateNoise(uint32_t width, uint32_t height, const NoiseParams& params) {
         HeightMap result(width * height);
-        generateNoiseParallel(result, width, height, params);
-        // 并行后处理
-        applyNoisePostProcessingParallel(result, width, height, params);
+        generateNoiseParallel(result, width, height, params, {0, 0, width, height, true});
         
         return result;
     }
 
+    HeightMap generateNoiseRegion(int32_t originX, int32_t originY, uint32_t width, uint32_t height,
+                                  uint32_t worldWidth, uint32_t worldHeight, const NoiseParams& params) {
+        HeightMap result(width * height);
+        generateNoiseParallel(result, width, height, params,
+                              {originX, originY, worldWidth, worldHeight, false});
+        return result;
+    }
+
+    // 采样区域：左上角的世界坐标和岛屿衰减参照的世界尺寸，clampWarp为真时扭曲坐标限制在世界范围内
+    struct SampleRegion {
+        int32_t originX;
+        int32_t originY;
+        uint32_t worldWidth;
+        uint32_t worldHeight;
+        bool clampWarp;
+    };
+
+    // 融合的高度场生成：按块依次计算域扭曲偏移、在扭曲后的坐标上求fBm、乘以岛屿衰减，
+    // 每个像素只写一次，不再需要额外的整图遍历和扭曲缓冲区
     void generateNoiseParallel(HeightMap& result, uint32_t width, uint32_t height,
-                              const NoiseParams& params) {
+                              const NoiseParams& params, const SampleRegion& region) {
         
-        m_parallelProcessor->parallelFor2D(width, height, [&](uint32_t x, uint32_t y) {
-            float nx = x / params.scale;
-            float ny = y / params.scale;
-            
-            float value = 0.0f;
-            float amplitude = 1.0f;
-            float frequency = 1.0f;
-            float maxValue = 0.0f;
-            
-            for (int i = 0; i < params.octaves; i++) {
-                float noiseValue = 0.0f;
-                
-                switch (params.type) {
-                    case NoiseType::PERLIN:
-                        noiseValue = m_perlin.noise(nx * frequency, ny * frequency);
-                        break;
-                    case NoiseType::SIMPLEX:
-                        noiseValue = (m_simplex.noise(nx * frequency, ny * frequency) + 1.0f) * 0.5f;
-                        break;
-                    // ... 其他噪声类型 ...
-                    default:
-                        noiseValue = m_perlin.noise(nx * frequency, ny * frequency);
-                        break;
+        m_parallelProcessor->parallelForTiles(width, height, kFusedTileSize,
+            [&](uint32_t startX, uint32_t startY, uint32_t endX, uint32_t endY) {
+            float srcX[kFusedTileSize];
+            float srcY[kFusedTileSize];
+            uint32_t count = endX - startX;
+            int32_t worldX = region.originX + static_cast<int32_t>(startX);
+
+            for (uint32_t y = startY; y < endY; ++y) {
+                float* values = result.data() + static_cast<size_t>(y) * width + startX;
+                int32_t worldY = region.originY + static_cast<int32_t>(y);
+
+                // 1. 采样坐标（启用域扭曲时为扭曲后的源坐标）
+                if (params.domainWarp.enabled) {
+                    computeWarpedCoords(worldX, worldY, count, region, params.domainWarp, srcX, srcY);
+                } else {
+                    for (uint32_t k = 0; k < count; ++k) {
+                        srcX[k] = static_cast<float>(worldX + static_cast<int32_t>(k));
+                        srcY[k] = static_cast<float>(worldY);
+                    }
+                }
+
+                // 2. fBm
+                sampleFbm(params, srcX, srcY, values, count);
+
+                // 3. 岛屿衰减
+                if (params.islandMode) {
+                    for (uint32_t k = 0; k < count; ++k) {
+                        float dx = (srcX[k] / static_cast<float>(region.worldWidth)) - 0.5f;
+                        float dy = (srcY[k] / static_cast<float>(region.worldHeight)) - 0.5f;
+                        float distance = sqrt(dx * dx + dy * dy) * 2.0f;
+
+                        float falloff = 1.0f - distance;
+                        falloff = std::max(0.0f, falloff);
+
+                        values[k] *= falloff;
+                    }
                 }
-                
-                value += noiseValue * amplitude;
-                maxValue += amplitude;
-                amplitude *= params.persistence;
-                frequency *= params.lacunarity;
-            }
-            
-            if (maxValue > 0) {
-                value /= maxValue;
             }
-            
-            result[y * width + x] = value;
         });
     }
 
-    void applyNoisePostProcessingParallel(HeightMap& noise, uint32_t width, uint32_t height,
-                                         const NoiseParams& params) {
-        
-        // 并行应用岛模式
-        if (params.islandMode) {
-            m_parallelProcessor->parallelFor2D(width, height, [&](uint32_t x, uint32_t y) {
-                float dx = (x / static_cast<float>(width)) - 0.5f;
-                float dy = (y / static_cast<float>(height)) - 0.5f;
-                float distance = sqrt(dx * dx + dy * dy) * 2.0f;
-                
-                float falloff = 1.0f - distance;
-                falloff = std::max(0.0f, falloff);
-                
-                noise[y * width + x] *= falloff;
-            });
+    // 在一组像素坐标上求fBm，结果按振幅和归一化
+    void sampleFbm(const NoiseParams& params, const float* srcX, const float* srcY,
+                   float* values, uint32_t count) const {
+        float xs[kFusedTileSize];
+        float ys[kFusedTileSize];
+        float samples[kFusedTileSize];
+
+        std::fill(values, values + count, 0.0f);
+
+        float amplitude = 1.0f;
+        float frequency = 1.0f;
+        float maxValue = 0.0f;
+
+        for (int i = 0; i < params.octaves; i++) {
+            uint32_t period = octavePeriod(params.tilePeriod, frequency);
+            for (uint32_t k = 0; k < count; ++k) {
+                xs[k] = srcX[k] / params.scale * frequency;
+                ys[k] = srcY[k] / params.scale * frequency;
+            }
+
+            sampleNoiseBatch(params.type, i, period, xs, ys, samples, count);
+
+            for (uint32_t k = 0; k < count; ++k) {
+                values[k] += samples[k] * amplitude;
+            }
+            maxValue += amplitude;
+            amplitude *= params.persistence;
+            frequency *= params.lacunarity;
         }
-        
-        // 并行应用域扭曲
-        if (params.domainWarp.enabled) {
-            applyDomainWarpParallel(noise, width, height, params.domainWarp);
+
+        if (maxValue > 0) {
+            for (uint32_t k = 0; k < count; ++k) {
+                values[k] /= maxValue;
+            }
         }
     }
-    
-    void applyDomainWarpParallel(HeightMap& heightmap, uint32_t width, uint32_t height,
-                                const NoiseParams::DomainWarp& warp) {
-        
-        HeightMap warped(width * height);
-        
-        m_parallelProcessor->parallelFor2D(width, height, [&](uint32_t x, uint32_t y) {
-            float nx = x / warp.frequency;
-            float ny = y / warp.frequency;
-            
-            // 计算扭曲偏移
-            float dx = m_perlin.noise(nx, ny, 0.5f) * 2.0f - 1.0f;
-            float dy = m_perlin.noise(nx + 5.2f, ny + 1.3f, 0.5f) * 2.0f - 1.0f;
-            
-            // 应用倍频扭曲
-            if (warp.octaves > 1) {
-                float amplitude = 0.5f;
-                float frequency = 2.0f;
-                
-                for (uint32_t i = 1; i < warp.octaves; i++) {
-                    dx += m_perlin.noise(nx * frequency, ny * frequency, 0.5f + i) * 
-                          amplitude * 2.0f - amplitude;
-                    dy += m_perlin.noise(nx * frequency + 5.2f, ny * frequency + 1.3f, 0.5f + i) * 
-                          amplitude * 2.0f - amplitude;
-                    amplitude *= 0.5f;
-                    frequency *= 2.0f;
+
+    // 计算一段行上的域扭曲源坐标，(worldX, worldY)为行段起点的世界坐标
+    void computeWarpedCoords(int32_t worldX, int32_t worldY, uint32_t count,
+                             const SampleRegion& region,
+                             const NoiseParams::DomainWarp& warp,
+                             float* srcX, float* srcY) const {
+        float xs[kFusedTileSize];
+        float ys[kFusedTileSize];
+        float samples[kFusedTileSize];
+        float ny = worldY / warp.frequency;
+
+        // 计算扭曲偏移
+        for (uint32_t k = 0; k < count; ++k) {
+            xs[k] = (worldX + static_cast<int32_t>(k)) / warp.frequency;
+            ys[k] = ny;
+        }
+        m_perlin.noise2DBatch(xs, ys, 1, samples, count);
+        for (uint32_t k = 0; k < count; ++k) {
+            srcX[k] = samples[k] * 2.0f - 1.0f;
+            xs[k] = (worldX + static_cast<int32_t>(k)) / warp.frequency + 5.2f;
+            ys[k] = ny + 1.3f;
+        }
+        m_perlin.noise2DBatch(xs, ys, 1, samples, count);
+        for (uint32_t k = 0; k < count; ++k) {
+            srcY[k] = samples[k] * 2.0f - 1.0f;
+        }
+
+        // 应用倍频扭曲
+        if (warp.octaves > 1) {
+            float amplitude = 0.5f;
+            float frequency = 2.0f;
+
+            for (uint32_t i = 1; i < warp.octaves; i++) {
+                for (uint32_t k = 0; k < count; ++k) {
+                    xs[k] = (worldX + static_cast<int32_t>(k)) / warp.frequency * frequency;
+                    ys[k] = ny * frequency;
+                }
+                m_perlin.noise2DBatch(xs, ys, 1 + i, samples, count);
+                for (uint32_t k = 0; k < count; ++k) {
+                    srcX[k] += samples[k] * amplitude * 2.0f - amplitude;
+                    xs[k] += 5.2f;
+                    ys[k] += 1.3f;
                 }
+                m_perlin.noise2DBatch(xs, ys, 1 + i, samples, count);
+                for (uint32_t k = 0; k < count; ++k) {
+                    srcY[k] += samples[k] * amplitude * 2.0f - amplitude;
+                }
+                amplitude *= 0.5f;
+                frequency *= 2.0f;
             }
-            
-            // 计算源坐标
-            float srcX = x + dx * warp.strength;
-            float srcY = y + dy * warp.strength;
-            
-            // 双线性插值
-            srcX = std::clamp(srcX, 0.0f, static_cast<float>(width - 1));
-            srcY = std::clamp(srcY, 0.0f, static_cast<float>(height - 1));
-            
-            int x1 = static_cast<int>(srcX);
-            int y1 = static_cast<int>(srcY);
-            int x2 = std::min(x1 + 1, static_cast<int>(width - 1));
-            int y2 = std::min(y1 + 1, static_cast<int>(height - 1));
-            
-            float tx = srcX - x1;
-            float ty = srcY - y1;
-            
-            float v1 = heightmap[y1 * width + x1];
-            float v2 = heightmap[y1 * width + x2];
-            float v3 = heightmap[y2 * width + x1];
-            float v4 = heightmap[y2 * width + x2];
-            
-            float vx1 = v1 * (1 - tx) + v2 * tx;
-            float vx2 = v3 * (1 - tx) + v4 * tx;
-            
-            warped[y * width + x] = vx1 * (1 - ty) + vx2 * ty;
-        });
-        
-        heightmap = std::move(warped);
+        }
+
+        // 偏移转换为源坐标；整图生成时限制在地图范围内，分块的无限世界不做限制
+        for (uint32_t k = 0; k < count; ++k) {
+            srcX[k] = (worldX + static_cast<int32_t>(k)) + srcX[k] * warp.strength;
+            srcY[k] = worldY + srcY[k] * warp.strength;
+        }
+        if (region.clampWarp) {
+            for (uint32_t k = 0; k < count; ++k) {
+                srcX[k] = std::clamp(srcX[k], 0.0f, static_cast<float>(region.worldWidth - 1));
+                srcY[k] = std::clamp(srcY[k], 0.0f, static_cast<float>(region.worldHeight - 1));
+            }
+        }
     }
-    
+
+    // 当前倍频下的平铺周期（格数），0表示不平铺
+    static uint32_t octavePeriod(uint32_t tilePeriod, float frequency) {
+        if (tilePeriod == 0) return 0;
+        return std::max(1u, static_cast<uint32_t>(std::lround(tilePeriod * frequency)));
+    }
+
+    // 按噪声类型批量采样，octave用于区分各倍频的特征点
+    void sampleNoiseBatch(NoiseType type, int octave, uint32_t period, const float* xs,
+                          const float* ys, float* out, uint32_t count) const {
+        switch (type) {
+            case NoiseType::SIMPLEX:
+                for (uint32_t k = 0; k < count; ++k) {
+                    out[k] = (m_simplex.noise(xs[k], ys[k]) + 1.0f) * 0.5f;
+                }
+                break;
+            case NoiseType::PERLIN_2D:
+                m_perlin.noise2DBatch(xs, ys, 0, out, count);
+                break;
+            case NoiseType::WORLEY:
+                for (uint32_t k = 0; k < count; ++k) {
+                    out[k] = m_worley.noise(xs[k], ys[k], 0, static_cast<uint32_t>(octave), period);
+                }
+                break;
+            // ... 其他噪声类型 ...
+            case NoiseType::PERLIN:
+            default:
+                m_perlin.noiseBatch(xs, ys, 0.0f, out, count);
+                break;
+        }
+    }
+
     void applySmoothing(HeightMap& heightmap, uint32_t width, uint32_t height,
                        uint32_t radius) {
-        HeightMap smoothed = heightmap;
-        
-        // 并行平滑
-        m_parallelProcessor->parallelFor2DChunked(width, height, 64,
-            [&](uint32_t startX, uint32_t startY, uint32_t endX, uint32_t endY) {
-                for (uint32_t y = startY; y < endY; ++y) {
-                    for (uint32_t x = startX; x < endX; ++x) {
-                        // 边界检查
-                        if (x < radius || x >= width - radius || 
-                            y < radius || y >= height - radius) {
-                            continue;
-                        }
-                        
-                        float sum = 0.0f;
-                        int count = 0;
-                        
-                        for (int dy = -static_cast<int>(radius); dy <= static_cast<int>(radius); dy++) {
-                            for (int dx = -static_cast<int>(radius); dx <= static_cast<int>(radius); dx++) {
-                                sum += heightmap[(y + dy) * width + (x + dx)];
-                                count++;
-                            }
-                        }
-                        
-                        smoothed[y * width + x] = sum / count;
-                    }
-                }
-            });
-        
-        heightmap = std::move(smoothed);
+        applyBoxBlur(heightmap, width, height, radius, *m_scratch, *m_parallelProcessor);
+    }
+
+    void applyGaussianSmoothing(HeightMap& heightmap, uint32_t width, uint32_t height, float sigma) {
+        applyGaussianBlur(heightmap, width, height, sigma, *m_scratch, *m_parallelProcessor);
     }
     
     HeightMap generateLayeredNoise(uint32_t width, uint32_t height,
@@ -494,23 +541,26 @@ public:
     
     HeightMap generateWorleyNoise(uint32_t width, uint32_t height,
                                  const NoiseParams& params) {
-        WorleyNoise worley(m_seed);
         HeightMap result(width * height);
         
-        for (uint32_t y = 0; y < height; y++) {
-            for (uint32_t x = 0; x < width; x++) {
+        m_parallelProcessor->parallelForRowSpans(width, height,
+            [&](uint32_t y, uint32_t startX, uint32_t endX) {
+            float ny = y / params.scale;
+
+            for (uint32_t x = startX; x < endX; ++x) {
                 float nx = x / params.scale;
-                float ny = y / params.scale;
                 
-                float value = worley.noise(nx, ny, 0);
+                float value = m_worley.noise(nx, ny, 0, 0, params.tilePeriod);
                 
-                // 应用倍频
+                // 应用倍频，每个倍频使用独立的特征点层
                 if (params.octaves > 1) {
                     float amplitude = params.persistence;
                     float frequency = params.lacunarity;
                     
                     for (int i = 1; i < params.octaves; i++) {
-                        value += worley.noise(nx * frequency, ny * frequency, i) * amplitude;
+                        value += m_worley.noise(nx * frequency, ny * frequency, 0,
+                                                static_cast<uint32_t>(i),
+                                                octavePeriod(params.tilePeriod, frequency)) * amplitude;
                         amplitude *= params.persistence;
                         frequency *= params.lacunarity;
                     }
@@ -518,7 +568,7 @@ public:
                 
                 result[y * width + x] = value;
             }
-        }
+        });
         
         return result;
     }
@@ -527,7 +577,8 @@ public:
                         const NoiseParams::DomainWarp& warp) {
         if (!warp.enabled) return;
         
-        HeightMap warped = heightmap;
+        // 每个格子都会写入，临时缓冲区无需初始化
+        HeightMap warped = m_scratch->acquireUninitialized<float>(heightmap.size());
         
         for (uint32_t y = 0; y < height; y++) {
             for (uint32_t x = 0; x < width; x++) {
@@ -535,8 +586,8 @@ public:
                 float ny = y / warp.frequency;
                 
                 // 计算扭曲偏移
-                float dx = m_perlin.noise(nx, ny, 0.5f) * 2.0f - 1.0f;
-                float dy = m_perlin.noise(nx + 5.2f, ny + 1.3f, 0.5f) * 2.0f - 1.0f;
+                float dx = m_perlin.noise2D(nx, ny, 1) * 2.0f - 1.0f;
+                float dy = m_perlin.noise2D(nx + 5.2f, ny + 1.3f, 1) * 2.0f - 1.0f;
                 
                 // 应用倍频扭曲
                 if (warp.octaves > 1) {
@@ -544,9 +595,9 @@ public:
                     float frequency = 2.0f;
                     
                     for (uint32_t i = 1; i < warp.octaves; i++) {
-                        dx += m_perlin.noise(nx * frequency, ny * frequency, 0.5f + i) * 
+                        dx += m_perlin.noise2D(nx * frequency, ny * frequency, 1 + i) * 
                               amplitude * 2.0f - amplitude;
-                        dy += m_perlin.noise(nx * frequency + 5.2f, ny * frequency + 1.3f, 0.5f + i) * 
+                        dy += m_perlin.noise2D(nx * frequency + 5.2f, ny * frequency + 1.3f, 1 + i) * 
                               amplitude * 2.0f - amplitude;
                         amplitude *= 0.5f;
                         frequency *= 2.0f;
@@ -581,7 +632,8 @@ public:
             }
         }
         
-        heightmap = std::move(warped);
+        std::copy(warped.begin(), warped.end(), heightmap.begin());
+        m_scratch->release(std::move(warped));
     }
     
     void applyErosion(HeightMap& heightmap, uint32_t width, uint32_t height,
@@ -610,6 +662,14 @@ public:
         return m_perlin.noise(x, y, z);
     }
 
+    void applyPerlinNoiseBatch(const float* xs, const float* ys, float z, float* out, size_t n) {
+        m_perlin.noiseBatch(xs, ys, z, out, n);
+    }
+
+    void applyPerlinNoise2DBatch(const float* xs, const float* ys, int layer, float* out, size_t n) {
+        m_perlin.noise2DBatch(xs, ys, layer, out, n);
+    }
+
     
 private:
     void generatePerlinNoise(HeightMap& result, uint32_t width, uint32_t height,
@@ -744,8 +804,8 @@ private:
     
     void applyHydraulicErosion(HeightMap& heightmap, uint32_t width, uint32_t height,
                               const ErosionParams& params) {
-        std::vector<float> water(heightmap.size(), 0.0f);
-        std::vector<float> sediment(heightmap.size(), 0.0f);
+        std::vector<float> water = m_scratch->acquire<float>(heightmap.size());
+        std::vector<float> sediment = m_scratch->acquire<float>(heightmap.size());
         
         for (uint32_t iter = 0; iter < params.iterations; iter++) {
             // 模拟降雨
@@ -814,11 +874,14 @@ private:
                 }
             }
         }
+        
+        m_scratch->release(std::move(water));
+        m_scratch->release(std::move(sediment));
     }
     
     void applyThermalErosion(HeightMap& heightmap, uint32_t width, uint32_t height,
                             const ErosionParams& params) {
-        std::vector<float> changes(heightmap.size(), 0.0f);
+        std::vector<float> changes = m_scratch->acquire<float>(heightmap.size());
         
         for (uint32_t iter = 0; iter < params.iterations; iter++) {
             for (uint32_t y = 1; y < height - 1; y++) {
@@ -878,6 +941,8 @@ private:
                 changes[i] = 0.0f;
             }
         }
+        
+        m_scratch->release(std::move(changes));
     }
 };
 
@@ -931,12 +996,17 @@ const int SimplexNoiseImpl::simplex[64][4] = {
 };
 
 // NoiseGenerator公共接口实现
-NoiseGenerator::NoiseGenerator(uint32_t seed) 
-    : m_impl(std::make_unique<Impl>(seed)) {
+NoiseGenerator::NoiseGenerator(uint32_t seed, std::shared_ptr<ParallelProcessor> processor,
+                               std::shared_ptr<ScratchPool> scratch) 
+    : m_impl(std::make_unique<Impl>(seed, std::move(processor), std::move(scratch))) {
 }
 
 NoiseGenerator::~NoiseGenerator() = default;
 
+void NoiseGenerator::setParallelProcessor(std::shared_ptr<ParallelProcessor> processor) {
+    m_impl->setParallelProcessor(std::move(processor));
+}
+
 HeightMap NoiseGenerator::generateHeightMap(uint32_t width, uint32_t height, 
                                            const NoiseParams& params) {
     // 如果有分层，使用分层噪声
@@ -953,6 +1023,14 @@ HeightMap NoiseGenerator::generateNoise(uint32_t width, uint32_t height,
     return m_impl->generateNoise(width, height, params);
 }
 
+HeightMap NoiseGenerator::generateNoiseRegion(int32_t originX, int32_t originY,
+                                              uint32_t width, uint32_t height,
+                                              uint32_t worldWidth, uint32_t worldHeight,
+                                              const NoiseParams& params) {
+    return m_impl->generateNoiseRegion(originX, originY, width, height,
+                                       worldWidth, worldHeight, params);
+}
+
 HeightMap NoiseGenerator::generateLayeredNoise(uint32_t width, uint32_t height,
                                               const std::vector<NoiseParams::NoiseLayer>& layers) {
     return m_impl->generateLayeredNoise(width, height, layers);
@@ -988,6 +1066,11 @@ void NoiseGenerator::applySmoothing(HeightMap& heightmap, uint32_t width, uint32
     m_impl->applySmoothing(heightmap, width, height, radius);
 }
 
+void NoiseGenerator::applyGaussianSmoothing(HeightMap& heightmap, uint32_t width, uint32_t height,
+                                           float sigma) {
+    m_impl->applyGaussianSmoothing(heightmap, width, height, sigma);
+}
+
 void NoiseGenerator::applyTerracing(HeightMap& heightmap, uint32_t width, uint32_t height,
                                    uint32_t levels) {
     m_impl->applyTerracing(heightmap, width, height, levels);
@@ -998,5 +1081,17 @@ float NoiseGenerator::applyPerlinNoise(float x, float y, float z)
     return m_impl->applyPerlinNoise(x, y, z);
 }
 
+void NoiseGenerator::applyPerlinNoiseBatch(const float* xs, const float* ys, float z,
+                                           float* out, size_t n)
+{
+    m_impl->applyPerlinNoiseBatch(xs, ys, z, out, n);
+}
+
+void NoiseGenerator::applyPerlinNoise2DBatch(const float* xs, const float* ys, int layer,
+                                             float* out, size_t n)
+{
+    m_impl->applyPerlinNoise2DBatch(xs, ys, layer, out, n);
+}
+
 } // namespace internal
 } // namespace MapGenerator
@@ -3,15 +3,25 @@
 #define MAPGENERATOR_INTERNAL_NOISEGENERATOR_H
 
 #include "CommonTypes.h"
+#include <memory>
 
 namespace MapGenerator {
 namespace internal {
 
+class ParallelProcessor;
+class ScratchPool;
+
 class NoiseGenerator {
 public:
-    explicit NoiseGenerator(uint32_t seed = 12345);
+    // processor为空时按需创建自己的并行处理器，scratch为空时使用自己的临时缓冲区池
+    explicit NoiseGenerator(uint32_t seed = 12345,
+                            std::shared_ptr<ParallelProcessor> processor = nullptr,
+                            std::shared_ptr<ScratchPool> scratch = nullptr);
     ~NoiseGenerator();
     
+    // 与生成引擎共享并行处理器，避免每个噪声生成器各自创建线程
+    void setParallelProcessor(std::shared_ptr<ParallelProcessor> processor);
+    
     // 生成高度图
     HeightMap generateHeightMap(uint32_t width, uint32_t height, 
                                const NoiseParams& params);
@@ -20,6 +30,14 @@ public:
     HeightMap generateNoise(uint32_t width, uint32_t height,
                            const NoiseParams& params);
     
+    // 生成世界坐标中的一块区域：(originX, originY)为区域左上角的世界坐标，
+    // 岛屿衰减以worldWidth x worldHeight为参照，域扭曲不限制在地图范围内；
+    // 同一世界坐标在任何区域中的结果逐位相同，用于无缝分块
+    HeightMap generateNoiseRegion(int32_t originX, int32_t originY,
+                                  uint32_t width, uint32_t height,
+                                  uint32_t worldWidth, uint32_t worldHeight,
+                                  const NoiseParams& params);
+    
     // 多频混合噪声
     HeightMap generateLayeredNoise(uint32_t width, uint32_t height,
                                   const std::vector<NoiseParams::NoiseLayer>& layers);
@@ -39,12 +57,22 @@ public:
     // 后处理
     void applyErosion(HeightMap& heightmap, uint32_t width, uint32_t height,
                      const ErosionParams& params);
+    // 盒式平滑，边界格子按图内的邻居求平均
     void applySmoothing(HeightMap& heightmap, uint32_t width, uint32_t height,
                        uint32_t radius = 1);
+    // 近似高斯平滑（三次盒式平滑），每格开销与sigma无关
+    void applyGaussianSmoothing(HeightMap& heightmap, uint32_t width, uint32_t height,
+                                float sigma);
     void applyTerracing(HeightMap& heightmap, uint32_t width, uint32_t height,
                        uint32_t levels);
 
     float applyPerlinNoise(float x, float y, float z = 0);
+
+    // 批量柏林噪声：out[i] = applyPerlinNoise(xs[i], ys[i], z)，结果与逐点调用一致
+    void applyPerlinNoiseBatch(const float* xs, const float* ys, float z, float* out, size_t n);
+
+    // 批量二维柏林噪声，layer为整数切片，等同于applyPerlinNoiseBatch(xs, ys, layer, ...)
+    void applyPerlinNoise2DBatch(const float* xs, const float* ys, int layer, float* out, size_t n);
     
 private:
     class Impl;
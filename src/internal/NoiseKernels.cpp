@@ -0,0 +1,440 @@
+// src/internal/NoiseKernels.cpp
+#include "NoiseKernels.h"
+#include "SimdTarget.h"
+
+namespace MapGenerator {
+namespace internal {
+
+namespace {
+
+void perlinBatchScalar(const int* perm, const float* xs, const float* ys, float z,
+                       float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = perlinNoiseScalar(perm, xs[i], ys[i], z);
+    }
+}
+
+void perlin2DBatchScalar(const int* perm, const float* xs, const float* ys, int layer,
+                         float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = perlinNoise2DScalar(perm, xs[i], ys[i], layer);
+    }
+}
+
+#if MG_SIMD_X86
+
+// ---- SSE4.1：4路，排列表查找逐通道完成 ----
+
+MG_TARGET_SSE41 inline __m128 fade4(__m128 t) {
+    __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+    __m128 inner = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f));
+    inner = _mm_add_ps(_mm_mul_ps(t, inner), _mm_set1_ps(10.0f));
+    return _mm_mul_ps(t3, inner);
+}
+
+MG_TARGET_SSE41 inline __m128 lerp4(__m128 t, __m128 a, __m128 b) {
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+MG_TARGET_SSE41 inline __m128 grad4(__m128i hash, __m128 x, __m128 y, __m128 z) {
+    __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+    __m128 hLt8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+    __m128 hLt4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    __m128 hIsX = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+                                                _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+
+    __m128 u = _mm_blendv_ps(y, x, hLt8);
+    __m128 v = _mm_blendv_ps(_mm_blendv_ps(z, x, hIsX), y, hLt4);
+
+    // 低2位决定符号，直接翻转符号位
+    __m128 signU = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+    __m128 signV = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+    return _mm_add_ps(_mm_xor_ps(u, signU), _mm_xor_ps(v, signV));
+}
+
+MG_TARGET_SSE41 void perlinBatchSse41(const int* perm, const float* xs, const float* ys,
+                                      float z, float* out, size_t n) {
+    // z 对整批相同，预先计算
+    float zFloor = std::floor(z);
+    int Z = (int)zFloor & 255;
+    float zf = z - zFloor;
+    float wScalar = zf * zf * zf * (zf * (zf * 6 - 15) + 10);
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 vz = _mm_set1_ps(zf);
+    const __m128 vz1 = _mm_set1_ps(zf - 1);
+    const __m128 w = _mm_set1_ps(wScalar);
+    const __m128i mask255 = _mm_set1_epi32(255);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        __m128 fx = _mm_floor_ps(x);
+        __m128 fy = _mm_floor_ps(y);
+
+        alignas(16) int X[4];
+        alignas(16) int Y[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(X), _mm_and_si128(_mm_cvttps_epi32(fx), mask255));
+        _mm_store_si128(reinterpret_cast<__m128i*>(Y), _mm_and_si128(_mm_cvttps_epi32(fy), mask255));
+
+        x = _mm_sub_ps(x, fx);
+        y = _mm_sub_ps(y, fy);
+        __m128 u = fade4(x);
+        __m128 v = fade4(y);
+
+        alignas(16) int h[8][4];
+        for (int lane = 0; lane < 4; ++lane) {
+            int A = perm[X[lane]] + Y[lane];
+            int AA = perm[A] + Z;
+            int AB = perm[A + 1] + Z;
+            int B = perm[X[lane] + 1] + Y[lane];
+            int BA = perm[B] + Z;
+            int BB = perm[B + 1] + Z;
+            h[0][lane] = perm[AA];
+            h[1][lane] = perm[BA];
+            h[2][lane] = perm[AB];
+            h[3][lane] = perm[BB];
+            h[4][lane] = perm[AA + 1];
+            h[5][lane] = perm[BA + 1];
+            h[6][lane] = perm[AB + 1];
+            h[7][lane] = perm[BB + 1];
+        }
+
+        __m128 x1 = _mm_sub_ps(x, one);
+        __m128 y1 = _mm_sub_ps(y, one);
+        auto load = [&](int k) { return _mm_load_si128(reinterpret_cast<const __m128i*>(h[k])); };
+
+        __m128 result = lerp4(w,
+            lerp4(v, lerp4(u, grad4(load(0), x, y, vz), grad4(load(1), x1, y, vz)),
+                     lerp4(u, grad4(load(2), x, y1, vz), grad4(load(3), x1, y1, vz))),
+            lerp4(v, lerp4(u, grad4(load(4), x, y, vz1), grad4(load(5), x1, y, vz1)),
+                     lerp4(u, grad4(load(6), x, y1, vz1), grad4(load(7), x1, y1, vz1))));
+        _mm_storeu_ps(out + i, result);
+    }
+
+    perlinBatchScalar(perm, xs + i, ys + i, z, out + i, n - i);
+}
+
+MG_TARGET_SSE41 void perlin2DBatchSse41(const int* perm, const float* xs, const float* ys,
+                                        int layer, float* out, size_t n) {
+    const int Z = layer & 255;
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128i mask255 = _mm_set1_epi32(255);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        __m128 fx = _mm_floor_ps(x);
+        __m128 fy = _mm_floor_ps(y);
+
+        alignas(16) int X[4];
+        alignas(16) int Y[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(X), _mm_and_si128(_mm_cvttps_epi32(fx), mask255));
+        _mm_store_si128(reinterpret_cast<__m128i*>(Y), _mm_and_si128(_mm_cvttps_epi32(fy), mask255));
+
+        x = _mm_sub_ps(x, fx);
+        y = _mm_sub_ps(y, fy);
+        __m128 u = fade4(x);
+        __m128 v = fade4(y);
+
+        // 4个角点的梯度分量逐通道查表
+        alignas(16) float gx[4][4];
+        alignas(16) float gy[4][4];
+        for (int lane = 0; lane < 4; ++lane) {
+            int A = perm[X[lane]] + Y[lane];
+            int B = perm[X[lane] + 1] + Y[lane];
+            const int hashes[4] = {perm[perm[A] + Z], perm[perm[B] + Z],
+                                   perm[perm[A + 1] + Z], perm[perm[B + 1] + Z]};
+            for (int c = 0; c < 4; ++c) {
+                gx[c][lane] = kPerlinGrad2[hashes[c] & 15][0];
+                gy[c][lane] = kPerlinGrad2[hashes[c] & 15][1];
+            }
+        }
+
+        __m128 x1 = _mm_sub_ps(x, one);
+        __m128 y1 = _mm_sub_ps(y, one);
+        auto grad = [&](int c, __m128 px, __m128 py) {
+            return _mm_add_ps(_mm_mul_ps(_mm_load_ps(gx[c]), px), _mm_mul_ps(_mm_load_ps(gy[c]), py));
+        };
+
+        __m128 result = lerp4(v, lerp4(u, grad(0, x, y), grad(1, x1, y)),
+                                 lerp4(u, grad(2, x, y1), grad(3, x1, y1)));
+        _mm_storeu_ps(out + i, result);
+    }
+
+    perlin2DBatchScalar(perm, xs + i, ys + i, layer, out + i, n - i);
+}
+
+// ---- AVX2：8路，排列表查找使用gather ----
+
+MG_TARGET_AVX2 inline __m256 fade8(__m256 t) {
+    __m256 t3 = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+    __m256 inner = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f));
+    inner = _mm256_add_ps(_mm256_mul_ps(t, inner), _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(t3, inner);
+}
+
+MG_TARGET_AVX2 inline __m256 lerp8(__m256 t, __m256 a, __m256 b) {
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+MG_TARGET_AVX2 inline __m256 grad8(__m256i hash, __m256 x, __m256 y, __m256 z) {
+    __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+    __m256 hLt8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+    __m256 hLt4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    __m256 hIsX = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)),
+                                                      _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+
+    __m256 u = _mm256_blendv_ps(y, x, hLt8);
+    __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, hIsX), y, hLt4);
+
+    __m256 signU = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+    __m256 signV = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+    return _mm256_add_ps(_mm256_xor_ps(u, signU), _mm256_xor_ps(v, signV));
+}
+
+MG_TARGET_AVX2 inline __m256i lookup8(const int* perm, __m256i idx) {
+    return _mm256_i32gather_epi32(perm, idx, 4);
+}
+
+MG_TARGET_AVX2 void perlinBatchAvx2(const int* perm, const float* xs, const float* ys,
+                                    float z, float* out, size_t n) {
+    float zFloor = std::floor(z);
+    int zInt = (int)zFloor & 255;
+    float zf = z - zFloor;
+    float wScalar = zf * zf * zf * (zf * (zf * 6 - 15) + 10);
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 vz = _mm256_set1_ps(zf);
+    const __m256 vz1 = _mm256_set1_ps(zf - 1);
+    const __m256 w = _mm256_set1_ps(wScalar);
+    const __m256i Z = _mm256_set1_epi32(zInt);
+    const __m256i oneI = _mm256_set1_epi32(1);
+    const __m256i mask255 = _mm256_set1_epi32(255);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 fx = _mm256_floor_ps(x);
+        __m256 fy = _mm256_floor_ps(y);
+        __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(fx), mask255);
+        __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(fy), mask255);
+
+        x = _mm256_sub_ps(x, fx);
+        y = _mm256_sub_ps(y, fy);
+        __m256 u = fade8(x);
+        __m256 v = fade8(y);
+
+        __m256i A = _mm256_add_epi32(lookup8(perm, X), Y);
+        __m256i AA = _mm256_add_epi32(lookup8(perm, A), Z);
+        __m256i AB = _mm256_add_epi32(lookup8(perm, _mm256_add_epi32(A, oneI)), Z);
+        __m256i B = _mm256_add_epi32(lookup8(perm, _mm256_add_epi32(X, oneI)), Y);
+        __m256i BA = _mm256_add_epi32(lookup8(perm, B), Z);
+        __m256i BB = _mm256_add_epi32(lookup8(perm, _mm256_add_epi32(B, oneI)), Z);
+
+        __m256 x1 = _mm256_sub_ps(x, one);
+        __m256 y1 = _mm256_sub_ps(y, one);
+
+        __m256 result = lerp8(w,
+            lerp8(v, lerp8(u, grad8(lookup8(perm, AA), x, y, vz),
+                              grad8(lookup8(perm, BA), x1, y, vz)),
+                     lerp8(u, grad8(lookup8(perm, AB), x, y1, vz),
+                              grad8(lookup8(perm, BB), x1, y1, vz))),
+            lerp8(v, lerp8(u, grad8(lookup8(perm, _mm256_add_epi32(AA, oneI)), x, y, vz1),
+                              grad8(lookup8(perm, _mm256_add_epi32(BA, oneI)), x1, y, vz1)),
+                     lerp8(u, grad8(lookup8(perm, _mm256_add_epi32(AB, oneI)), x, y1, vz1),
+                              grad8(lookup8(perm, _mm256_add_epi32(BB, oneI)), x1, y1, vz1))));
+        _mm256_storeu_ps(out + i, result);
+    }
+
+    perlinBatchScalar(perm, xs + i, ys + i, z, out + i, n - i);
+}
+
+// 16项梯度表查找：两次寄存器内置换，按第3位选择高低半表
+MG_TARGET_AVX2 inline __m256 gradTable8(__m256 low, __m256 high, __m256i h) {
+    __m256 fromLow = _mm256_permutevar8x32_ps(low, h);
+    __m256 fromHigh = _mm256_permutevar8x32_ps(high, h);
+    return _mm256_blendv_ps(fromLow, fromHigh, _mm256_castsi256_ps(_mm256_slli_epi32(h, 28)));
+}
+
+MG_TARGET_AVX2 inline __m256 grad2D8(__m256 gradXLow, __m256 gradXHigh,
+                                      __m256 gradYLow, __m256 gradYHigh,
+                                      __m256i hash, __m256 x, __m256 y) {
+    __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+    return _mm256_add_ps(_mm256_mul_ps(gradTable8(gradXLow, gradXHigh, h), x),
+                         _mm256_mul_ps(gradTable8(gradYLow, gradYHigh, h), y));
+}
+
+MG_TARGET_AVX2 void perlin2DBatchAvx2(const int* perm, const float* xs, const float* ys,
+                                      int layer, float* out, size_t n) {
+    alignas(32) float gradX[16];
+    alignas(32) float gradY[16];
+    for (int h = 0; h < 16; ++h) {
+        gradX[h] = kPerlinGrad2[h][0];
+        gradY[h] = kPerlinGrad2[h][1];
+    }
+    const __m256 gradXLow = _mm256_load_ps(gradX);
+    const __m256 gradXHigh = _mm256_load_ps(gradX + 8);
+    const __m256 gradYLow = _mm256_load_ps(gradY);
+    const __m256 gradYHigh = _mm256_load_ps(gradY + 8);
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256i Z = _mm256_set1_epi32(layer & 255);
+    const __m256i oneI = _mm256_set1_epi32(1);
+    const __m256i mask255 = _mm256_set1_epi32(255);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 fx = _mm256_floor_ps(x);
+        __m256 fy = _mm256_floor_ps(y);
+        __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(fx), mask255);
+        __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(fy), mask255);
+
+        x = _mm256_sub_ps(x, fx);
+        y = _mm256_sub_ps(y, fy);
+        __m256 u = fade8(x);
+        __m256 v = fade8(y);
+
+        __m256i A = _mm256_add_epi32(lookup8(perm, X), Y);
+        __m256i B = _mm256_add_epi32(lookup8(perm, _mm256_add_epi32(X, oneI)), Y);
+        __m256i hAA = lookup8(perm, _mm256_add_epi32(lookup8(perm, A), Z));
+        __m256i hBA = lookup8(perm, _mm256_add_epi32(lookup8(perm, B), Z));
+        __m256i hAB = lookup8(perm, _mm256_add_epi32(lookup8(perm, _mm256_add_epi32(A, oneI)), Z));
+        __m256i hBB = lookup8(perm, _mm256_add_epi32(lookup8(perm, _mm256_add_epi32(B, oneI)), Z));
+
+        __m256 x1 = _mm256_sub_ps(x, one);
+        __m256 y1 = _mm256_sub_ps(y, one);
+
+        __m256 result = lerp8(v,
+            lerp8(u, grad2D8(gradXLow, gradXHigh, gradYLow, gradYHigh, hAA, x, y),
+                     grad2D8(gradXLow, gradXHigh, gradYLow, gradYHigh, hBA, x1, y)),
+            lerp8(u, grad2D8(gradXLow, gradXHigh, gradYLow, gradYHigh, hAB, x, y1),
+                     grad2D8(gradXLow, gradXHigh, gradYLow, gradYHigh, hBB, x1, y1)));
+        _mm256_storeu_ps(out + i, result);
+    }
+
+    perlin2DBatchScalar(perm, xs + i, ys + i, layer, out + i, n - i);
+}
+
+SimdLevel queryCpu() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    if (maxLeaf < 1) return SimdLevel::SCALAR;
+
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx) {
+        // 操作系统需保存YMM寄存器状态
+        unsigned long long xcr0 = _xgetbv(0);
+        if ((xcr0 & 0x6) == 0x6) {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+    }
+
+    if (avx2) return SimdLevel::AVX2;
+    if (sse41) return SimdLevel::SSE41;
+    return SimdLevel::SCALAR;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return SimdLevel::SSE41;
+    return SimdLevel::SCALAR;
+#endif
+}
+
+#endif // MG_SIMD_X86
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+#if MG_SIMD_X86
+    static const SimdLevel level = queryCpu();
+    return level;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::SSE41: return "sse4.1";
+        default: return "scalar";
+    }
+}
+
+void perlinNoise2DBatch(SimdLevel level, const int* perm, const float* xs, const float* ys,
+                        int layer, float* out, size_t n) {
+    SimdLevel supported = detectSimdLevel();
+    if (static_cast<int>(level) > static_cast<int>(supported)) {
+        level = supported;
+    }
+
+    switch (level) {
+#if MG_SIMD_X86
+        case SimdLevel::AVX2:
+            perlin2DBatchAvx2(perm, xs, ys, layer, out, n);
+            break;
+        case SimdLevel::SSE41:
+            perlin2DBatchSse41(perm, xs, ys, layer, out, n);
+            break;
+#endif
+        default:
+            perlin2DBatchScalar(perm, xs, ys, layer, out, n);
+            break;
+    }
+}
+
+void perlinNoise2DBatch(const int* perm, const float* xs, const float* ys, int layer,
+                        float* out, size_t n) {
+    perlinNoise2DBatch(detectSimdLevel(), perm, xs, ys, layer, out, n);
+}
+
+void perlinNoiseBatch(SimdLevel level, const int* perm, const float* xs, const float* ys,
+                      float z, float* out, size_t n) {
+    // 整数z层上三维噪声退化为二维，只需4个角点
+    float zFloor = std::floor(z);
+    if (z == zFloor && std::fabs(z) < 16777216.0f) {
+        perlinNoise2DBatch(level, perm, xs, ys, static_cast<int>(zFloor), out, n);
+        return;
+    }
+
+    SimdLevel supported = detectSimdLevel();
+    if (static_cast<int>(level) > static_cast<int>(supported)) {
+        level = supported;
+    }
+
+    switch (level) {
+#if MG_SIMD_X86
+        case SimdLevel::AVX2:
+            perlinBatchAvx2(perm, xs, ys, z, out, n);
+            break;
+        case SimdLevel::SSE41:
+            perlinBatchSse41(perm, xs, ys, z, out, n);
+            break;
+#endif
+        default:
+            perlinBatchScalar(perm, xs, ys, z, out, n);
+            break;
+    }
+}
+
+void perlinNoiseBatch(const int* perm, const float* xs, const float* ys, float z,
+                      float* out, size_t n) {
+    perlinNoiseBatch(detectSimdLevel(), perm, xs, ys, z, out, n);
+}
+
+} // namespace internal
+} // namespace MapGenerator
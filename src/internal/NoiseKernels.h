@@ -0,0 +1,118 @@
+// src/internal/NoiseKernels.h
+#ifndef MAPGENERATOR_INTERNAL_NOISEKERNELS_H
+#define MAPGENERATOR_INTERNAL_NOISEKERNELS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace MapGenerator {
+namespace internal {
+
+// 批量噪声内核可用的指令集级别
+enum class SimdLevel {
+    SCALAR,
+    SSE41,
+    AVX2
+};
+
+// 运行时检测当前CPU支持的最高级别（结果缓存）
+SimdLevel detectSimdLevel();
+const char* simdLevelName(SimdLevel level);
+
+// 单点柏林噪声，perm为512项排列表；批量内核与其逐位一致
+inline float perlinNoiseScalar(const int* perm, float x, float y, float z) {
+    auto fade = [](float t) { return t * t * t * (t * (t * 6 - 15) + 10); };
+    auto lerp = [](float t, float a, float b) { return a + t * (b - a); };
+    auto grad3 = [](int hash, float gx, float gy, float gz) {
+        int h = hash & 15;                       // 将低4位作为梯度选择
+        float u = h < 8 ? gx : gy;               // 根据第0位选择x或y
+        float v = h < 4 ? gy : (h == 12 || h == 14 ? gx : gz); // 根据第1-2位选择
+        return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v); // 根据低2位决定符号
+    };
+
+    int X = (int)std::floor(x) & 255;
+    int Y = (int)std::floor(y) & 255;
+    int Z = (int)std::floor(z) & 255;
+
+    x -= std::floor(x);
+    y -= std::floor(y);
+    z -= std::floor(z);
+
+    float u = fade(x);
+    float v = fade(y);
+    float w = fade(z);
+
+    int A = perm[X] + Y;
+    int AA = perm[A] + Z;
+    int AB = perm[A + 1] + Z;
+    int B = perm[X + 1] + Y;
+    int BA = perm[B] + Z;
+    int BB = perm[B + 1] + Z;
+
+    return lerp(w, lerp(v, lerp(u, grad3(perm[AA], x, y, z),
+                                   grad3(perm[BA], x - 1, y, z)),
+                           lerp(u, grad3(perm[AB], x, y - 1, z),
+                                   grad3(perm[BB], x - 1, y - 1, z))),
+                   lerp(v, lerp(u, grad3(perm[AA + 1], x, y, z - 1),
+                                   grad3(perm[BA + 1], x - 1, y, z - 1)),
+                           lerp(u, grad3(perm[AB + 1], x, y - 1, z - 1),
+                                   grad3(perm[BB + 1], x - 1, y - 1, z - 1))));
+}
+
+// 二维梯度表：与三维梯度在z=0切片上取值相同
+constexpr float kPerlinGrad2[16][2] = {
+    { 1,  1}, {-1,  1}, { 1, -1}, {-1, -1},
+    { 1,  0}, {-1,  0}, { 1,  0}, {-1,  0},
+    { 0,  1}, { 0, -1}, { 0,  1}, { 0, -1},
+    { 1,  1}, { 0, -1}, {-1,  1}, { 0, -1}
+};
+
+// 二维柏林噪声：只有4个角点和两级插值，layer选择互不相关的整数切片
+// 与perlinNoiseScalar(perm, x, y, layer)数值相等（仅±0的符号可能不同）
+inline float perlinNoise2DScalar(const int* perm, float x, float y, int layer) {
+    auto fade = [](float t) { return t * t * t * (t * (t * 6 - 15) + 10); };
+    auto lerp = [](float t, float a, float b) { return a + t * (b - a); };
+    auto grad2 = [](int hash, float gx, float gy) {
+        const float* g = kPerlinGrad2[hash & 15];
+        return g[0] * gx + g[1] * gy;
+    };
+
+    int X = (int)std::floor(x) & 255;
+    int Y = (int)std::floor(y) & 255;
+    int Z = layer & 255;
+
+    x -= std::floor(x);
+    y -= std::floor(y);
+
+    float u = fade(x);
+    float v = fade(y);
+
+    int A = perm[X] + Y;
+    int B = perm[X + 1] + Y;
+
+    return lerp(v, lerp(u, grad2(perm[perm[A] + Z], x, y),
+                           grad2(perm[perm[B] + Z], x - 1, y)),
+                   lerp(u, grad2(perm[perm[A + 1] + Z], x, y - 1),
+                           grad2(perm[perm[B + 1] + Z], x - 1, y - 1)));
+}
+
+// 批量柏林噪声：out[i] = perlinNoiseScalar(perm, xs[i], ys[i], z)
+// 按检测到的指令集分派，结果与标量实现逐位一致；z为整数时走二维路径（数值相等）
+void perlinNoiseBatch(const int* perm, const float* xs, const float* ys, float z,
+                      float* out, size_t n);
+
+// 指定指令集级别的版本，级别高于CPU支持时退回到可用的最高级别
+void perlinNoiseBatch(SimdLevel level, const int* perm, const float* xs, const float* ys,
+                      float z, float* out, size_t n);
+
+// 批量二维柏林噪声：out[i] = perlinNoise2DScalar(perm, xs[i], ys[i], layer)
+void perlinNoise2DBatch(const int* perm, const float* xs, const float* ys, int layer,
+                        float* out, size_t n);
+void perlinNoise2DBatch(SimdLevel level, const int* perm, const float* xs, const float* ys,
+                        int layer, float* out, size_t n);
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_NOISEKERNELS_H
@@ -1,25 +1,41 @@
 // src/internal/ParallelUtils.cpp
 #include "ParallelUtils.h"
 #include <algorithm>
+#include <iterator>
 
 namespace MapGenerator {
 namespace internal {
 
-ParallelProcessor::ParallelProcessor(uint32_t threadCount) 
+namespace {
+    // 当前线程所属的处理器及其队列编号（非工作线程为空）
+    thread_local ParallelProcessor* t_currentProcessor = nullptr;
+    thread_local uint32_t t_currentQueue = 0;
+
+    constexpr uint32_t kNoQueue = std::numeric_limits<uint32_t>::max();
+}
+
+ParallelProcessor::ParallelProcessor(uint32_t threadCount)
     : m_threadCount(std::max(1u, threadCount)) {
-    
-    m_tasks.resize(m_threadCount);
-    
-    // 创建工作线程
-    for (uint32_t i = 0; i < m_threadCount; ++i) {
+
+    // 调用线程也参与计算，因此只需创建 threadCount - 1 个常驻工作线程
+    uint32_t workerCount = m_threadCount - 1;
+    m_queues.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    for (uint32_t i = 0; i < workerCount; ++i) {
         m_workers.emplace_back(&ParallelProcessor::workerThread, this, i);
     }
 }
 
 ParallelProcessor::~ParallelProcessor() {
-    m_stop = true;
-    m_condition.notify_all();
-    
+    {
+        std::lock_guard<std::mutex> lock(m_parkMutex);
+        m_stop = true;
+    }
+    m_parkCondition.notify_all();
+
     for (auto& worker : m_workers) {
         if (worker.joinable()) {
             worker.join();
@@ -28,29 +44,140 @@ ParallelProcessor::~ParallelProcessor() {
 }
 
 void ParallelProcessor::workerThread(uint32_t threadId) {
-    while (!m_stop) {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_condition.wait(lock, [&]() {
-            return m_stop || m_tasks[threadId].valid;
+    t_currentProcessor = this;
+    t_currentQueue = threadId;
+
+    while (true) {
+        if (tryRunTask(threadId)) {
+            continue;
+        }
+
+        // 没有可执行的任务时休眠，而不是忙等
+        std::unique_lock<std::mutex> lock(m_parkMutex);
+        m_parkCondition.wait(lock, [&]() {
+            return m_stop || m_pendingTasks.load(std::memory_order_acquire) > 0;
         });
-        
+
         if (m_stop) return;
-        
-        if (m_tasks[threadId].valid) {
-            Task task = std::move(m_tasks[threadId]);
-            m_tasks[threadId].valid = false;
-            lock.unlock();
-            
-            task.func();
+    }
+}
+
+void ParallelProcessor::submit(const void* group, std::function<void()> task) {
+    // 工作线程提交的任务放入自己的队列，外部线程轮流分配
+    uint32_t queueIdx = (t_currentProcessor == this)
+        ? t_currentQueue
+        : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+    {
+        std::lock_guard<std::mutex> lock(m_queues[queueIdx]->mutex);
+        m_queues[queueIdx]->tasks.push_back({group, std::move(task)});
+    }
+    m_pendingTasks.fetch_add(1, std::memory_order_release);
+}
+
+bool ParallelProcessor::tryRunTask(uint32_t ownQueue, const void* group) {
+    std::function<void()> task;
+
+    // 先从自己的队列尾部取
+    if (ownQueue != kNoQueue) {
+        WorkerQueue& queue = *m_queues[ownQueue];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (auto it = queue.tasks.rbegin(); it != queue.tasks.rend(); ++it) {
+            if (!group || it->group == group) {
+                task = std::move(it->run);
+                queue.tasks.erase(std::next(it).base());
+                break;
+            }
         }
     }
+
+    // 再从其他队列头部窃取
+    if (!task) {
+        uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+        uint32_t start = (ownQueue != kNoQueue) ? ownQueue + 1
+                                                : m_nextQueue.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < queueCount && !task; ++i) {
+            WorkerQueue& queue = *m_queues[(start + i) % queueCount];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            for (auto it = queue.tasks.begin(); it != queue.tasks.end(); ++it) {
+                if (!group || it->group == group) {
+                    task = std::move(it->run);
+                    queue.tasks.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!task) {
+        return false;
+    }
+
+    m_pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
 }
 
-void ParallelProcessor::parallelFor1D(uint32_t count, 
+void ParallelProcessor::runChunks(uint32_t numChunks, const std::function<void(uint32_t)>& body) {
+    if (numChunks == 0) return;
+
+    uint32_t helperCount = std::min(numChunks, m_threadCount) - 1;
+    if (helperCount == 0 || m_workers.empty()) {
+        for (uint32_t i = 0; i < numChunks; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    // 使用原子计数器实现无锁分块分发，助手任务只负责领取分块
+    std::atomic<uint32_t> nextChunk{0};
+    std::atomic<uint32_t> activeHelpers{helperCount};
+
+    auto drain = [&]() {
+        while (true) {
+            uint32_t chunkIdx = nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunkIdx >= numChunks) break;
+            body(chunkIdx);
+        }
+    };
+
+    // 以本次调用的计数器地址作为任务组标记，返回前本组任务都已执行完
+    const void* group = &activeHelpers;
+    for (uint32_t h = 0; h < helperCount; ++h) {
+        submit(group, [&]() {
+            drain();
+            if (activeHelpers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(m_parkMutex);
+                m_parkCondition.notify_all();
+            }
+        });
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_parkMutex);
+    }
+    m_parkCondition.notify_all();
+
+    // 调用线程也参与工作
+    drain();
+
+    // 等待助手任务结束；期间只执行本组尚未被领取的助手任务，不会接手其他调用的任务
+    // （例如批量生成的整条通道），因此等待时间只取决于本次调用。本组任务都在此前提交，
+    // 队列中找不到时说明都已被领取，嵌套调用也不会死锁
+    uint32_t ownQueue = (t_currentProcessor == this) ? t_currentQueue : kNoQueue;
+    while (tryRunTask(ownQueue, group)) {
+    }
+
+    std::unique_lock<std::mutex> lock(m_parkMutex);
+    m_parkCondition.wait(lock, [&]() {
+        return activeHelpers.load(std::memory_order_acquire) == 0;
+    });
+}
+
+void ParallelProcessor::parallelFor1D(uint32_t count,
                                      std::function<void(uint32_t, uint32_t)> func) {
-    
+
     if (count == 0) return;
-    
+
     // 小数组串行处理
     if (count < 1000 || m_threadCount == 1) {
         for (uint32_t i = 0; i < count; ++i) {
@@ -58,89 +185,50 @@ void ParallelProcessor::parallelFor1D(uint32_t count,
         }
         return;
     }
-    
+
     // 计算每个线程处理的范围
     uint32_t itemsPerThread = (count + m_threadCount - 1) / m_threadCount;
-    
-    std::vector<std::thread> threads;
-    threads.reserve(m_threadCount);
-    
-    for (uint32_t t = 0; t < m_threadCount; ++t) {
-        uint32_t startIdx = t * itemsPerThread;
+    uint32_t numRanges = (count + itemsPerThread - 1) / itemsPerThread;
+
+    runChunks(numRanges, [&](uint32_t rangeIdx) {
+        uint32_t startIdx = rangeIdx * itemsPerThread;
         uint32_t endIdx = std::min(startIdx + itemsPerThread, count);
-        
-        if (startIdx < count) {
-            threads.emplace_back([=, &func]() {
-                for (uint32_t i = startIdx; i < endIdx; ++i) {
-                    func(i, i + 1);
-                }
-            });
+        for (uint32_t i = startIdx; i < endIdx; ++i) {
+            func(i, i + 1);
         }
-    }
-    
-    for (auto& thread : threads) {
-        thread.join();
-    }
+    });
 }
 
 void ParallelProcessor::parallelFor1DChunked(uint32_t count, uint32_t chunkSize,
                                            std::function<void(uint32_t, uint32_t)> func) {
-    
+
     if (count == 0) return;
-    
+
     // 调整块大小，确保块数适当
     if (chunkSize == 0) {
         chunkSize = std::max<uint32_t>(1, count / (m_threadCount * 4));
     }
-    
+
     uint32_t numChunks = (count + chunkSize - 1) / chunkSize;
-    
+
     if (numChunks <= 1) {
         func(0, count);
         return;
     }
-    
-    // 使用原子计数器实现无锁任务分发
-    std::atomic<uint32_t> nextChunk{0};
-    
-    auto worker = [&]() {
-        while (true) {
-            uint32_t chunkIdx = nextChunk.fetch_add(1);
-            if (chunkIdx >= numChunks) break;
-            
-            uint32_t startIdx = chunkIdx * chunkSize;
-            uint32_t endIdx = std::min(startIdx + chunkSize, count);
-            
-            func(startIdx, endIdx);
-        }
-    };
-    
-    // 确定工作线程数
-    uint32_t numWorkers = std::min(numChunks, m_threadCount);
-    
-    std::vector<std::thread> workers;
-    workers.reserve(numWorkers - 1);
-    
-    // 启动工作线程
-    for (uint32_t t = 0; t < numWorkers - 1; ++t) {
-        workers.emplace_back(worker);
-    }
-    
-    // 主线程也参与工作
-    worker();
-    
-    // 等待工作线程完成
-    for (auto& worker : workers) {
-        worker.join();
-    }
+
+    runChunks(numChunks, [&](uint32_t chunkIdx) {
+        uint32_t startIdx = chunkIdx * chunkSize;
+        uint32_t endIdx = std::min(startIdx + chunkSize, count);
+        func(startIdx, endIdx);
+    });
 }
 
 void ParallelProcessor::parallelFor2D(uint32_t width, uint32_t height,
                                      std::function<void(uint32_t, uint32_t)> func) {
-    
+
     // 1. 计算总任务数
     size_t totalPixels = static_cast<size_t>(width) * height;
-    
+
     // 2. 根据任务大小决定是否并行
     if (totalPixels < 1000) {  // 小任务串行处理
         for (uint32_t y = 0; y < height; ++y) {
@@ -150,151 +238,63 @@ void ParallelProcessor::parallelFor2D(uint32_t width, uint32_t height,
         }
         return;
     }
-    
-    // 3. 计算最优的工作线程数
-    uint32_t effectiveThreads = std::min(m_threadCount, 
-                                        static_cast<uint32_t>(totalPixels / 1000));
-    effectiveThreads = std::max(effectiveThreads, 1u);
-    
-    // 4. 使用更细粒度的任务分片（按块而不是按行）
+
+    // 3. 使用更细粒度的任务分片（按块而不是按行）
     const uint32_t optimalChunkSize = 16; // 16x16的块，利于缓存
-    
-    // 5. 任务队列实现（无锁或细粒度锁）
-    struct TaskRange {
-        uint32_t startX, endX, startY, endY;
-    };
-    
-    std::vector<TaskRange> tasks;
-    
-    // 生成任务块
-    for (uint32_t y = 0; y < height; y += optimalChunkSize) {
-        for (uint32_t x = 0; x < width; x += optimalChunkSize) {
-            TaskRange task;
-            task.startX = x;
-            task.startY = y;
-            task.endX = std::min(x + optimalChunkSize, width);
-            task.endY = std::min(y + optimalChunkSize, height);
-            tasks.push_back(task);
-        }
-    }
-    
-    // 6. 使用原子计数器实现无锁任务分发
-    std::atomic<size_t> nextTask{0};
-    
-    // 7. 创建工作线程
-    std::vector<std::thread> workers;
-    workers.reserve(effectiveThreads);
-    
-    auto workerFunc = [&]() {
-        while (true) {
-            size_t taskIndex = nextTask.fetch_add(1, std::memory_order_relaxed);
-            if (taskIndex >= tasks.size()) break;
-            
-            const auto& task = tasks[taskIndex];
-            
-            // 处理当前任务块
-            for (uint32_t y = task.startY; y < task.endY; ++y) {
-                for (uint32_t x = task.startX; x < task.endX; ++x) {
-                    func(x, y);
-                }
+    uint32_t numChunksX = (width + optimalChunkSize - 1) / optimalChunkSize;
+    uint32_t numChunksY = (height + optimalChunkSize - 1) / optimalChunkSize;
+
+    // 4. 分发到常驻工作线程
+    runChunks(numChunksX * numChunksY, [&](uint32_t chunkIdx) {
+        uint32_t startX = (chunkIdx % numChunksX) * optimalChunkSize;
+        uint32_t startY = (chunkIdx / numChunksX) * optimalChunkSize;
+        uint32_t endX = std::min(startX + optimalChunkSize, width);
+        uint32_t endY = std::min(startY + optimalChunkSize, height);
+
+        // 处理当前任务块
+        for (uint32_t y = startY; y < endY; ++y) {
+            for (uint32_t x = startX; x < endX; ++x) {
+                func(x, y);
             }
         }
-    };
-    
-    // 8. 启动工作线程
-    for (uint32_t t = 0; t < effectiveThreads; ++t) {
-        workers.emplace_back(workerFunc);
-    }
-    
-    // 9. 主线程也参与工作
-    workerFunc();
-    
-    // 10. 等待所有工作线程完成
-    for (auto& worker : workers) {
-        worker.join();
-    }
+    });
 }
 
-void ParallelProcessor::parallelFor2DChunked(uint32_t width, uint32_t height, 
+void ParallelProcessor::parallelFor2DChunked(uint32_t width, uint32_t height,
                                             uint32_t chunkSize,
                                             std::function<void(uint32_t, uint32_t, uint32_t, uint32_t)> func) {
-    
+
     uint32_t numChunksX = (width + chunkSize - 1) / chunkSize;
     uint32_t numChunksY = (height + chunkSize - 1) / chunkSize;
     uint32_t totalChunks = numChunksX * numChunksY;
-    
+
     if (totalChunks <= 1) {
         func(0, 0, width, height);
         return;
     }
-    
-    std::atomic<uint32_t> nextChunk{0};
-    std::vector<std::thread> threads;
-    
-    uint32_t numWorkerThreads = std::min(totalChunks, m_threadCount);
-    threads.reserve(numWorkerThreads);
-    
-    for (uint32_t t = 0; t < numWorkerThreads; ++t) {
-        threads.emplace_back([=, &nextChunk, &func]() {
-            while (true) {
-                uint32_t chunkIdx = nextChunk++;
-                if (chunkIdx >= totalChunks) break;
-                
-                uint32_t chunkY = chunkIdx / numChunksX;
-                uint32_t chunkX = chunkIdx % numChunksX;
-                
-                uint32_t startX = chunkX * chunkSize;
-                uint32_t startY = chunkY * chunkSize;
-                uint32_t endX = std::min(startX + chunkSize, width);
-                uint32_t endY = std::min(startY + chunkSize, height);
-                
-                func(startX, startY, endX, endY);
-            }
-        });
-    }
-    
-    for (auto& thread : threads) {
-        thread.join();
-    }
+
+    runChunks(totalChunks, [&](uint32_t chunkIdx) {
+        uint32_t chunkY = chunkIdx / numChunksX;
+        uint32_t chunkX = chunkIdx % numChunksX;
+
+        uint32_t startX = chunkX * chunkSize;
+        uint32_t startY = chunkY * chunkSize;
+        uint32_t endX = std::min(startX + chunkSize, width);
+        uint32_t endY = std::min(startY + chunkSize, height);
+
+        func(startX, startY, endX, endY);
+    });
 }
 
-void ParallelProcessor::processHeightMapParallel(const HeightMap& heightmap, 
+void ParallelProcessor::processHeightMapParallel(const HeightMap& heightmap,
                                                 uint32_t width, uint32_t height,
                                                 std::function<void(uint32_t, uint32_t, float)> func) {
-    
+
     parallelFor2D(width, height, [&](uint32_t x, uint32_t y) {
         uint32_t idx = y * width + x;
         func(x, y, heightmap[idx]);
     });
 }
 
-template<typename T>
-std::vector<T> ParallelProcessor::parallelGenerate(uint32_t count, 
-                                                   std::function<T(uint32_t)> generator) {
-    
-    std::vector<T> results(count);
-    std::vector<std::thread> threads;
-    uint32_t itemsPerThread = (count + m_threadCount - 1) / m_threadCount;
-    
-    for (uint32_t t = 0; t < m_threadCount; ++t) {
-        uint32_t startIdx = t * itemsPerThread;
-        uint32_t endIdx = std::min(startIdx + itemsPerThread, count);
-        
-        if (startIdx < count) {
-            threads.emplace_back([=, &results, &generator]() {
-                for (uint32_t i = startIdx; i < endIdx; ++i) {
-                    results[i] = generator(i);
-                }
-            });
-        }
-    }
-    
-    for (auto& thread : threads) {
-        thread.join();
-    }
-    
-    return results;
-}
-
 } // namespace internal
 } // namespace MapGenerator
@@ -5,20 +5,28 @@
 #include "MapGenerator.h"
 #include <functional>
 #include <vector>
+#include <deque>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <algorithm>
+#include <limits>
+#include <memory>
 
 namespace MapGenerator {
 namespace internal {
 
+// 并行处理器：常驻工作线程 + 每线程双端队列的工作窃取调度
+// 所有并行循环都分发到同一组线程上，调用线程也参与计算，等待时不再join而是继续执行本次调用的任务
 class ParallelProcessor {
 public:
     ParallelProcessor(uint32_t threadCount);
     ~ParallelProcessor();
 
+    ParallelProcessor(const ParallelProcessor&) = delete;
+    ParallelProcessor& operator=(const ParallelProcessor&) = delete;
+
     // 1D并行循环
     void parallelFor1D(uint32_t count, std::function<void(uint32_t, uint32_t)> func);
     void parallelFor1DChunked(uint32_t count, uint32_t chunkSize,
@@ -35,7 +43,7 @@ public:
             }
         });
     }
-    
+
     // 查找数组的最小最大值
     template<typename T>
     std::pair<T, T> parallelMinMax(const T* data, uint32_t count) {
@@ -44,47 +52,26 @@ public:
             return {T(), T()};
         }
 
-        // 每个线程的局部最小最大值
-        std::vector<T> localMins(m_threadCount, std::numeric_limits<T>::max());
-        std::vector<T> localMaxs(m_threadCount, std::numeric_limits<T>::lowest());
-
-        // 原子计数器用于任务分发
-        std::atomic<uint32_t> nextChunk{0};
+        // 每个块的局部最小最大值，避免依赖线程编号
         const uint32_t chunkSize = 1024;
         uint32_t numChunks = (count + chunkSize - 1) / chunkSize;
+        std::vector<T> localMins(numChunks, std::numeric_limits<T>::max());
+        std::vector<T> localMaxs(numChunks, std::numeric_limits<T>::lowest());
 
-        // 工作函数
-        auto worker = [&](uint32_t threadId) {
-            while (true) {
-                uint32_t chunkIdx = nextChunk.fetch_add(1);
-                if (chunkIdx >= numChunks) break;
-
-                uint32_t startIdx = chunkIdx * chunkSize;
-                uint32_t endIdx = std::min(startIdx + chunkSize, count);
+        parallelFor1DChunked(count, chunkSize, [&](uint32_t startIdx, uint32_t endIdx) {
+            uint32_t chunkIdx = startIdx / chunkSize;
+            T localMin = localMins[chunkIdx];
+            T localMax = localMaxs[chunkIdx];
 
-                T& localMin = localMins[threadId];
-                T& localMax = localMaxs[threadId];
-
-                for (uint32_t i = startIdx; i < endIdx; ++i) {
-                    T val = data[i];
-                    if (val < localMin) localMin = val;
-                    if (val > localMax) localMax = val;
-                }
+            for (uint32_t i = startIdx; i < endIdx; ++i) {
+                T val = data[i];
+                if (val < localMin) localMin = val;
+                if (val > localMax) localMax = val;
             }
-        };
 
-        // 启动工作线程
-        std::vector<std::thread> workers;
-        for (uint32_t t = 0; t < m_threadCount; ++t) {
-            workers.emplace_back(worker, t);
-        }
-
-        // 主线程也参与工作
-        worker(0);
-
-        for (auto& worker : workers) {
-            worker.join();
-        }
+            localMins[chunkIdx] = localMin;
+            localMaxs[chunkIdx] = localMax;
+        });
 
         // 合并结果
         T globalMin = *std::min_element(localMins.begin(), localMins.end());
@@ -92,7 +79,7 @@ public:
 
         return {globalMin, globalMax};
     }
-    
+
     // 归一化数组
     template<typename T>
     void parallelNormalize(T* data, uint32_t count, T minVal, T maxVal) {
@@ -117,41 +104,119 @@ public:
             }
         });
     }
-    
+
     // 2D并行处理
     void parallelFor2D(uint32_t width, uint32_t height,
                       std::function<void(uint32_t, uint32_t)> func);
-    
+
     // 分块2D并行处理
     void parallelFor2DChunked(uint32_t width, uint32_t height, uint32_t chunkSize,
                              std::function<void(uint32_t, uint32_t, uint32_t, uint32_t)> func);
-    
+
     // 并行处理高度图
     void processHeightMapParallel(const HeightMap& heightmap, uint32_t width, uint32_t height,
                                  std::function<void(uint32_t, uint32_t, float)> func);
-    
+
+    // 按行区间的2D并行循环：body(y, startX, endX)
+    // 可调用对象以模板参数传入，每行只有一次调用，内层循环可被内联和向量化
+    template<typename F>
+    void parallelForRowSpans(uint32_t width, uint32_t height, F&& body) {
+        if (width == 0 || height == 0) return;
+
+        // 每块至少约4096个像素，块数约为线程数的4倍以便负载均衡
+        uint32_t minRows = std::max<uint32_t>(1, 4096 / width);
+        uint32_t rowsPerChunk = std::max(minRows, height / (m_threadCount * 4));
+        uint32_t numChunks = (height + rowsPerChunk - 1) / rowsPerChunk;
+
+        if (numChunks <= 1 || m_threadCount == 1) {
+            for (uint32_t y = 0; y < height; ++y) {
+                body(y, 0u, width);
+            }
+            return;
+        }
+
+        runChunks(numChunks, [&](uint32_t chunkIdx) {
+            uint32_t startY = chunkIdx * rowsPerChunk;
+            uint32_t endY = std::min(startY + rowsPerChunk, height);
+            for (uint32_t y = startY; y < endY; ++y) {
+                body(y, 0u, width);
+            }
+        });
+    }
+
+    // 按块的2D并行循环：body(startX, startY, endX, endY)，适合需要邻域访问的处理
+    template<typename F>
+    void parallelForTiles(uint32_t width, uint32_t height, uint32_t tileSize, F&& body) {
+        if (width == 0 || height == 0) return;
+        if (tileSize == 0) tileSize = 64;
+
+        uint32_t numTilesX = (width + tileSize - 1) / tileSize;
+        uint32_t numTilesY = (height + tileSize - 1) / tileSize;
+        uint32_t totalTiles = numTilesX * numTilesY;
+
+        auto runTile = [&](uint32_t tileIdx) {
+            uint32_t startX = (tileIdx % numTilesX) * tileSize;
+            uint32_t startY = (tileIdx / numTilesX) * tileSize;
+            body(startX, startY,
+                 std::min(startX + tileSize, width),
+                 std::min(startY + tileSize, height));
+        };
+
+        if (totalTiles <= 1 || m_threadCount == 1) {
+            for (uint32_t i = 0; i < totalTiles; ++i) {
+                runTile(i);
+            }
+            return;
+        }
+
+        runChunks(totalTiles, runTile);
+    }
+
     // 并行生成（支持线程安全的结果收集）
     template<typename T>
-    std::vector<T> parallelGenerate(uint32_t count, std::function<T(uint32_t)> generator);
-    
+    std::vector<T> parallelGenerate(uint32_t count, std::function<T(uint32_t)> generator) {
+        std::vector<T> results(count);
+        parallelFor1DChunked(count, 0, [&](uint32_t startIdx, uint32_t endIdx) {
+            for (uint32_t i = startIdx; i < endIdx; ++i) {
+                results[i] = generator(i);
+            }
+        });
+        return results;
+    }
+
     uint32_t getThreadCount() const { return m_threadCount; }
-    
+
 private:
-    uint32_t m_threadCount;
-    std::vector<std::thread> m_workers;
-    std::atomic<bool> m_stop{false};
-    
-    // 任务队列
+    // 任务带所属runChunks调用的标记，等待中的调用线程只执行自己调用的任务
     struct Task {
-        std::function<void()> func;
-        bool valid = false;
+        const void* group;
+        std::function<void()> run;
     };
-    
-    std::vector<Task> m_tasks;
-    std::mutex m_mutex;
-    std::condition_variable m_condition;
-    
+
+    // 每个工作线程的任务队列：本线程从尾部取（LIFO），其他线程从头部窃取（FIFO）
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // 将numChunks个分块分发到工作线程执行，调用线程参与并等待全部完成
+    void runChunks(uint32_t numChunks, const std::function<void(uint32_t)>& body);
+
+    void submit(const void* group, std::function<void()> task);
+    // group为空时执行任意任务，否则只执行该组的任务
+    bool tryRunTask(uint32_t ownQueue, const void* group = nullptr);
     void workerThread(uint32_t threadId);
+
+    uint32_t m_threadCount;
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<bool> m_stop{false};
+    std::atomic<uint32_t> m_pendingTasks{0};
+    std::atomic<uint32_t> m_nextQueue{0};
+
+    // 空闲线程在此休眠，有新任务或批次完成时唤醒
+    std::mutex m_parkMutex;
+    std::condition_variable m_parkCondition;
 };
 
 } // namespace internal
@@ -0,0 +1,434 @@
+// src/internal/PipeErosion.cpp
+#include "PipeErosion.h"
+#include "SimdTarget.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace MapGenerator {
+namespace internal {
+
+namespace {
+
+// 每个任务处理的行数
+constexpr uint32_t kPipeRowsPerTask = 16;
+// 平均水深低于该值的格子视为干地，速度取0
+constexpr float kMinFlowDepth = 1e-4f;
+
+
+struct PipeConstants {
+    float rain;            // 每轮降雨量
+    float fluxGain;        // dt * g * 管道截面 / 管道长度
+    float dt;
+    float cellArea;        // 管道长度的平方
+    float dtOverArea;
+    float pipeLength;
+    float halfInvLength;   // 中心差分系数
+    float capacity;
+    float erosionRate;
+    float depositionRate;
+    float minSlope;
+    float maxSpeed;        // 速度上限：每轮最多流过一格（CFL条件）
+    float advect;          // 平流回溯距离系数：dt / 管道长度
+    float evaporation;     // 每轮蒸发后保留的水量比例
+};
+
+// SoA网格：地形b与沉积物s双缓冲，其余网格每一遍只改写本格，原地更新即可
+struct PipeGrids {
+    uint32_t width;
+    uint32_t height;
+    const float* b;
+    float* bNext;
+    float* d;
+    float* s;
+    float* sNext;
+    float* fL;
+    float* fR;
+    float* fT;
+    float* fB;
+    float* u;
+    float* v;
+};
+
+// 邻居是否在图内；缺失方向的通量恒为0
+struct Sides {
+    bool l, r, t, b;
+};
+
+constexpr Sides kInterior = {true, true, true, true};
+
+// ---- 标量单格：边界格直接调用，内部格的标量内核同样调用，向量内核与其逐位一致 ----
+
+inline void fluxCell(const PipeGrids& g, const PipeConstants& c, size_t i, Sides n) {
+    const size_t w = g.width;
+    const float depth = g.d[i] + c.rain;
+    const float h = g.b[i] + depth;
+    auto pipe = [&](float flux, size_t j) {
+        return maxSel(flux + c.fluxGain * (h - (g.b[j] + (g.d[j] + c.rain))), 0.0f);
+    };
+    const float l = n.l ? pipe(g.fL[i], i - 1) : 0.0f;
+    const float r = n.r ? pipe(g.fR[i], i + 1) : 0.0f;
+    const float t = n.t ? pipe(g.fT[i], i - w) : 0.0f;
+    const float b = n.b ? pipe(g.fB[i], i + w) : 0.0f;
+    // 流出量不超过本格水量
+    const float sum = ((l + r) + t) + b;
+    const float scale = minSel((depth * c.cellArea) / (sum * c.dt), 1.0f);
+    g.fL[i] = l * scale;
+    g.fR[i] = r * scale;
+    g.fT[i] = t * scale;
+    g.fB[i] = b * scale;
+}
+
+// 水深与速度（流入减流出），再按本格流速和地形坡度侵蚀或沉积。
+// 速度只用到本格通量，坡度只用到本遍不改写的地形，因此两步合成一遍
+inline void flowCell(const PipeGrids& g, const PipeConstants& c, size_t i, Sides n) {
+    const size_t w = g.width;
+    const float depth = g.d[i] + c.rain;
+    const float fromL = n.l ? g.fR[i - 1] : 0.0f;
+    const float fromR = n.r ? g.fL[i + 1] : 0.0f;
+    const float fromT = n.t ? g.fB[i - w] : 0.0f;
+    const float fromB = n.b ? g.fT[i + w] : 0.0f;
+    const float in = ((fromL + fromR) + fromT) + fromB;
+    const float out = ((g.fL[i] + g.fR[i]) + g.fT[i]) + g.fB[i];
+    const float next = maxSel(depth + c.dtOverArea * (in - out), 0.0f);
+    const float avg = 0.5f * (depth + next);
+    // 穿过本格的平均通量除以过水断面得到流速
+    const float wx = 0.5f * (((fromL - g.fL[i]) + g.fR[i]) - fromR);
+    const float wy = 0.5f * (((fromT - g.fT[i]) + g.fB[i]) - fromB);
+    const float denom = avg * c.pipeLength;
+    const bool wet = avg > kMinFlowDepth;
+    // 极浅的水会算出极大的速度，限到CFL上限内以免侵蚀失稳
+    const float u = minSel(maxSel(wet ? wx / denom : 0.0f, -c.maxSpeed), c.maxSpeed);
+    const float v = minSel(maxSel(wet ? wy / denom : 0.0f, -c.maxSpeed), c.maxSpeed);
+    g.d[i] = next;
+    g.u[i] = u;
+    g.v[i] = v;
+
+    const float self = g.b[i];
+    // 边界格缺失的一侧取本格高度（单侧差分）
+    const float bl = n.l ? g.b[i - 1] : self;
+    const float br = n.r ? g.b[i + 1] : self;
+    const float bt = n.t ? g.b[i - w] : self;
+    const float bb = n.b ? g.b[i + w] : self;
+    const float gx = (br - bl) * c.halfInvLength;
+    const float gy = (bb - bt) * c.halfInvLength;
+    const float g2 = gx * gx + gy * gy;
+    const float tilt = maxSel(std::sqrt(g2 / (1.0f + g2)), c.minSlope);
+    const float speed = std::sqrt(u * u + v * v);
+    const float capacity = (c.capacity * tilt) * speed;
+    // 差值为正时按侵蚀率带走地面，为负时按沉积率落回地面
+    const float diff = capacity - g.s[i];
+    // 侵蚀不把本格挖到最低的邻居以下，否则挖出的坑更陡、流速更大，侵蚀会自我放大而失稳
+    const float floor = minSel(minSel(bl, br), minSel(bt, bb));
+    const float delta = minSel((diff > 0.0f ? c.erosionRate : c.depositionRate) * diff,
+                               maxSel(self - floor, 0.0f));
+    g.bNext[i] = self - delta;
+    g.sNext[i] = g.s[i] + delta;
+}
+
+// 沉积物沿速度反向回溯取样（双线性插值），同时蒸发
+inline void advectCell(const PipeGrids& g, const PipeConstants& c, size_t i, uint32_t x, uint32_t y) {
+    const float maxX = static_cast<float>(g.width - 1);
+    const float maxY = static_cast<float>(g.height - 1);
+    const float px = minSel(maxSel(static_cast<float>(x) - g.u[i] * c.advect, 0.0f), maxX);
+    const float py = minSel(maxSel(static_cast<float>(y) - g.v[i] * c.advect, 0.0f), maxY);
+    const uint32_t x0 = static_cast<uint32_t>(px);
+    const uint32_t y0 = static_cast<uint32_t>(py);
+    const uint32_t x1 = std::min(x0 + 1, g.width - 1);
+    const uint32_t y1 = std::min(y0 + 1, g.height - 1);
+    const float tx = px - static_cast<float>(x0);
+    const float ty = py - static_cast<float>(y0);
+    const float* row0 = g.sNext + static_cast<size_t>(y0) * g.width;
+    const float* row1 = g.sNext + static_cast<size_t>(y1) * g.width;
+    const float top = row0[x0] + tx * (row0[x1] - row0[x0]);
+    const float bottom = row1[x0] + tx * (row1[x1] - row1[x0]);
+    g.s[i] = top + ty * (bottom - top);
+    g.d[i] *= c.evaporation;
+}
+
+// ---- 行内核：处理内部行[x0, x1)，所有邻居都在图内 ----
+
+void fluxRowScalar(const PipeGrids& g, const PipeConstants& c, size_t row, uint32_t x0, uint32_t x1) {
+    for (uint32_t x = x0; x < x1; ++x) fluxCell(g, c, row + x, kInterior);
+}
+
+void flowRowScalar(const PipeGrids& g, const PipeConstants& c, size_t row, uint32_t x0, uint32_t x1) {
+    for (uint32_t x = x0; x < x1; ++x) flowCell(g, c, row + x, kInterior);
+}
+
+// 平流按整行处理，回溯位置已夹到图内
+void advectRowScalar(const PipeGrids& g, const PipeConstants& c, uint32_t y, uint32_t x0, uint32_t x1) {
+    const size_t row = static_cast<size_t>(y) * g.width;
+    for (uint32_t x = x0; x < x1; ++x) advectCell(g, c, row + x, x, y);
+}
+
+#if MG_SIMD_X86
+
+// ---- AVX2：每次8格，运算顺序与标量单格相同 ----
+
+// 朝邻居j的管道：旧通量加上水面高差带来的增量，不为负
+MG_TARGET_AVX2 inline __m256 pipeFluxAvx2(const PipeGrids& g, const float* flux, size_t i, size_t j,
+                                          __m256 h, __m256 rain, __m256 gain, __m256 zero) {
+    __m256 hn = _mm256_add_ps(_mm256_loadu_ps(g.b + j), _mm256_add_ps(_mm256_loadu_ps(g.d + j), rain));
+    __m256 f = _mm256_add_ps(_mm256_loadu_ps(flux + i), _mm256_mul_ps(gain, _mm256_sub_ps(h, hn)));
+    return _mm256_max_ps(f, zero);
+}
+
+MG_TARGET_AVX2 void fluxRowAvx2(const PipeGrids& g, const PipeConstants& c,
+                                size_t row, uint32_t x0, uint32_t x1) {
+    const size_t w = g.width;
+    const __m256 rain = _mm256_set1_ps(c.rain);
+    const __m256 gain = _mm256_set1_ps(c.fluxGain);
+    const __m256 area = _mm256_set1_ps(c.cellArea);
+    const __m256 dt = _mm256_set1_ps(c.dt);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    uint32_t x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        const size_t i = row + x;
+        const __m256 depth = _mm256_add_ps(_mm256_loadu_ps(g.d + i), rain);
+        const __m256 h = _mm256_add_ps(_mm256_loadu_ps(g.b + i), depth);
+        const __m256 l = pipeFluxAvx2(g, g.fL, i, i - 1, h, rain, gain, zero);
+        const __m256 r = pipeFluxAvx2(g, g.fR, i, i + 1, h, rain, gain, zero);
+        const __m256 t = pipeFluxAvx2(g, g.fT, i, i - w, h, rain, gain, zero);
+        const __m256 b = pipeFluxAvx2(g, g.fB, i, i + w, h, rain, gain, zero);
+        const __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(l, r), t), b);
+        const __m256 scale = _mm256_min_ps(_mm256_div_ps(_mm256_mul_ps(depth, area), _mm256_mul_ps(sum, dt)), one);
+        _mm256_storeu_ps(g.fL + i, _mm256_mul_ps(l, scale));
+        _mm256_storeu_ps(g.fR + i, _mm256_mul_ps(r, scale));
+        _mm256_storeu_ps(g.fT + i, _mm256_mul_ps(t, scale));
+        _mm256_storeu_ps(g.fB + i, _mm256_mul_ps(b, scale));
+    }
+    fluxRowScalar(g, c, row, x, x1);
+}
+
+MG_TARGET_AVX2 void flowRowAvx2(const PipeGrids& g, const PipeConstants& c,
+                                size_t row, uint32_t x0, uint32_t x1) {
+    const size_t w = g.width;
+    const __m256 rain = _mm256_set1_ps(c.rain);
+    const __m256 dtOverArea = _mm256_set1_ps(c.dtOverArea);
+    const __m256 length = _mm256_set1_ps(c.pipeLength);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minDepth = _mm256_set1_ps(kMinFlowDepth);
+    const __m256 maxSpeed = _mm256_set1_ps(c.maxSpeed);
+    const __m256 minSpeed = _mm256_set1_ps(-c.maxSpeed);
+    const __m256 halfInv = _mm256_set1_ps(c.halfInvLength);
+    const __m256 minSlope = _mm256_set1_ps(c.minSlope);
+    const __m256 capacity = _mm256_set1_ps(c.capacity);
+    const __m256 erosionRate = _mm256_set1_ps(c.erosionRate);
+    const __m256 depositionRate = _mm256_set1_ps(c.depositionRate);
+    uint32_t x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        const size_t i = row + x;
+        const __m256 depth = _mm256_add_ps(_mm256_loadu_ps(g.d + i), rain);
+        const __m256 fromL = _mm256_loadu_ps(g.fR + i - 1);
+        const __m256 fromR = _mm256_loadu_ps(g.fL + i + 1);
+        const __m256 fromT = _mm256_loadu_ps(g.fB + i - w);
+        const __m256 fromB = _mm256_loadu_ps(g.fT + i + w);
+        const __m256 l = _mm256_loadu_ps(g.fL + i);
+        const __m256 r = _mm256_loadu_ps(g.fR + i);
+        const __m256 t = _mm256_loadu_ps(g.fT + i);
+        const __m256 b = _mm256_loadu_ps(g.fB + i);
+        const __m256 in = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(fromL, fromR), fromT), fromB);
+        const __m256 out = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(l, r), t), b);
+        const __m256 next = _mm256_max_ps(
+            _mm256_add_ps(depth, _mm256_mul_ps(dtOverArea, _mm256_sub_ps(in, out))), zero);
+        const __m256 avg = _mm256_mul_ps(half, _mm256_add_ps(depth, next));
+        const __m256 wx = _mm256_mul_ps(half, _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(fromL, l), r), fromR));
+        const __m256 wy = _mm256_mul_ps(half, _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(fromT, t), b), fromB));
+        const __m256 denom = _mm256_mul_ps(avg, length);
+        const __m256 wet = _mm256_cmp_ps(avg, minDepth, _CMP_GT_OQ);
+        const __m256 u = _mm256_min_ps(_mm256_max_ps(_mm256_and_ps(wet, _mm256_div_ps(wx, denom)), minSpeed), maxSpeed);
+        const __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_and_ps(wet, _mm256_div_ps(wy, denom)), minSpeed), maxSpeed);
+        _mm256_storeu_ps(g.d + i, next);
+        _mm256_storeu_ps(g.u + i, u);
+        _mm256_storeu_ps(g.v + i, v);
+
+        const __m256 self = _mm256_loadu_ps(g.b + i);
+        const __m256 bl = _mm256_loadu_ps(g.b + i - 1);
+        const __m256 br = _mm256_loadu_ps(g.b + i + 1);
+        const __m256 bt = _mm256_loadu_ps(g.b + i - w);
+        const __m256 bb = _mm256_loadu_ps(g.b + i + w);
+        const __m256 gx = _mm256_mul_ps(_mm256_sub_ps(br, bl), halfInv);
+        const __m256 gy = _mm256_mul_ps(_mm256_sub_ps(bb, bt), halfInv);
+        const __m256 g2 = _mm256_add_ps(_mm256_mul_ps(gx, gx), _mm256_mul_ps(gy, gy));
+        const __m256 tilt = _mm256_max_ps(_mm256_sqrt_ps(_mm256_div_ps(g2, _mm256_add_ps(one, g2))), minSlope);
+        const __m256 speed = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(u, u), _mm256_mul_ps(v, v)));
+        const __m256 cap = _mm256_mul_ps(_mm256_mul_ps(capacity, tilt), speed);
+        const __m256 sediment = _mm256_loadu_ps(g.s + i);
+        const __m256 diff = _mm256_sub_ps(cap, sediment);
+        const __m256 rate = _mm256_blendv_ps(depositionRate, erosionRate, _mm256_cmp_ps(diff, zero, _CMP_GT_OQ));
+        const __m256 floor = _mm256_min_ps(_mm256_min_ps(bl, br), _mm256_min_ps(bt, bb));
+        const __m256 delta = _mm256_min_ps(_mm256_mul_ps(rate, diff), _mm256_max_ps(_mm256_sub_ps(self, floor), zero));
+        _mm256_storeu_ps(g.bNext + i, _mm256_sub_ps(self, delta));
+        _mm256_storeu_ps(g.sNext + i, _mm256_add_ps(sediment, delta));
+    }
+    flowRowScalar(g, c, row, x, x1);
+}
+
+// 回溯位置的四个角点用gather取样
+MG_TARGET_AVX2 void advectRowAvx2(const PipeGrids& g, const PipeConstants& c,
+                                  uint32_t y, uint32_t x0, uint32_t x1) {
+    const size_t row = static_cast<size_t>(y) * g.width;
+    const __m256 advect = _mm256_set1_ps(c.advect);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 maxX = _mm256_set1_ps(static_cast<float>(g.width - 1));
+    const __m256 maxY = _mm256_set1_ps(static_cast<float>(g.height - 1));
+    const __m256 evaporation = _mm256_set1_ps(c.evaporation);
+    const __m256 fy = _mm256_set1_ps(static_cast<float>(y));
+    const __m256i lastX = _mm256_set1_epi32(static_cast<int>(g.width - 1));
+    const __m256i lastY = _mm256_set1_epi32(static_cast<int>(g.height - 1));
+    const __m256i stride = _mm256_set1_epi32(static_cast<int>(g.width));
+    const __m256i oneI = _mm256_set1_epi32(1);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    uint32_t x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        const size_t i = row + x;
+        const __m256 fx = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(x)), lanes));
+        const __m256 px = _mm256_min_ps(_mm256_max_ps(
+            _mm256_sub_ps(fx, _mm256_mul_ps(_mm256_loadu_ps(g.u + i), advect)), zero), maxX);
+        const __m256 py = _mm256_min_ps(_mm256_max_ps(
+            _mm256_sub_ps(fy, _mm256_mul_ps(_mm256_loadu_ps(g.v + i), advect)), zero), maxY);
+        const __m256i ix0 = _mm256_cvttps_epi32(px);
+        const __m256i iy0 = _mm256_cvttps_epi32(py);
+        const __m256i ix1 = _mm256_min_epi32(_mm256_add_epi32(ix0, oneI), lastX);
+        const __m256i iy1 = _mm256_min_epi32(_mm256_add_epi32(iy0, oneI), lastY);
+        const __m256 tx = _mm256_sub_ps(px, _mm256_cvtepi32_ps(ix0));
+        const __m256 ty = _mm256_sub_ps(py, _mm256_cvtepi32_ps(iy0));
+        const __m256i row0 = _mm256_mullo_epi32(iy0, stride);
+        const __m256i row1 = _mm256_mullo_epi32(iy1, stride);
+        const __m256 s00 = _mm256_i32gather_ps(g.sNext, _mm256_add_epi32(row0, ix0), 4);
+        const __m256 s01 = _mm256_i32gather_ps(g.sNext, _mm256_add_epi32(row0, ix1), 4);
+        const __m256 s10 = _mm256_i32gather_ps(g.sNext, _mm256_add_epi32(row1, ix0), 4);
+        const __m256 s11 = _mm256_i32gather_ps(g.sNext, _mm256_add_epi32(row1, ix1), 4);
+        const __m256 top = _mm256_add_ps(s00, _mm256_mul_ps(tx, _mm256_sub_ps(s01, s00)));
+        const __m256 bottom = _mm256_add_ps(s10, _mm256_mul_ps(tx, _mm256_sub_ps(s11, s10)));
+        _mm256_storeu_ps(g.s + i, _mm256_add_ps(top, _mm256_mul_ps(ty, _mm256_sub_ps(bottom, top))));
+        _mm256_storeu_ps(g.d + i, _mm256_mul_ps(_mm256_loadu_ps(g.d + i), evaporation));
+    }
+    advectRowScalar(g, c, y, x, x1);
+}
+
+#endif // MG_SIMD_X86
+
+using CellFn = void (*)(const PipeGrids&, const PipeConstants&, size_t, Sides);
+using RowFn = void (*)(const PipeGrids&, const PipeConstants&, size_t, uint32_t, uint32_t);
+using AdvectFn = void (*)(const PipeGrids&, const PipeConstants&, uint32_t, uint32_t, uint32_t);
+
+// 一遍模板运算：首末行和每行首末格按实际邻居走单格函数，其余走行内核
+void runStencilPass(ParallelProcessor& processor, const PipeGrids& g, const PipeConstants& c,
+                    CellFn cell, RowFn rowKernel) {
+    const uint32_t width = g.width;
+    const uint32_t height = g.height;
+    processor.parallelFor1DChunked(height, kPipeRowsPerTask, [&](uint32_t startY, uint32_t endY) {
+        for (uint32_t y = startY; y < endY; ++y) {
+            const size_t row = static_cast<size_t>(y) * width;
+            if (y == 0 || y == height - 1) {
+                for (uint32_t x = 0; x < width; ++x) {
+                    cell(g, c, row + x, Sides{x > 0, x + 1 < width, y > 0, y + 1 < height});
+                }
+                continue;
+            }
+            cell(g, c, row, Sides{false, true, true, true});
+            rowKernel(g, c, row, 1, width - 1);
+            cell(g, c, row + width - 1, Sides{true, false, true, true});
+        }
+    });
+}
+
+} // namespace
+
+bool applyPipeErosion(HeightMap& heightmap, uint32_t width, uint32_t height,
+                      const ErosionParams& params, ParallelProcessor& processor,
+                      ScratchPool& scratch, SimdLevel level) {
+    const size_t count = static_cast<size_t>(width) * height;
+    if (width < 3 || height < 3 || heightmap.size() < count) {
+        return false;
+    }
+
+    PipeConstants c;
+    c.rain = params.rainAmount;
+    c.dt = params.timeStep;
+    c.pipeLength = params.pipeLength;
+    c.cellArea = params.pipeLength * params.pipeLength;
+    // 管道截面取格子面积，A * g / l 化简为 g * l
+    c.fluxGain = params.timeStep * params.gravity * params.pipeLength;
+    c.dtOverArea = params.timeStep / c.cellArea;
+    c.halfInvLength = 0.5f / params.pipeLength;
+    c.capacity = params.sedimentCapacity;
+    c.erosionRate = params.erosionRate;
+    c.depositionRate = params.depositionRate;
+    c.minSlope = params.minSlope;
+    c.maxSpeed = params.pipeLength / params.timeStep;
+    c.advect = params.timeStep / params.pipeLength;
+    c.evaporation = std::max(0.0f, 1.0f - params.evaporationRate);
+
+    RowFn fluxRow = fluxRowScalar;
+    RowFn flowRow = flowRowScalar;
+    AdvectFn advectRow = advectRowScalar;
+#if MG_SIMD_X86
+    // gather用32位下标
+    if (level == SimdLevel::AVX2 && detectSimdLevel() == SimdLevel::AVX2 && count <= 0x7FFFFFFFu) {
+        fluxRow = fluxRowAvx2;
+        flowRow = flowRowAvx2;
+        advectRow = advectRowAvx2;
+    }
+#else
+    (void)level;
+#endif
+
+    HeightMap terrainNext = scratch.acquireUninitialized<float>(count);
+    std::vector<float> water = scratch.acquire<float>(count, 0.0f);
+    std::vector<float> sediment = scratch.acquire<float>(count, 0.0f);
+    std::vector<float> sedimentNext = scratch.acquireUninitialized<float>(count);
+    std::vector<float> fluxL = scratch.acquire<float>(count, 0.0f);
+    std::vector<float> fluxR = scratch.acquire<float>(count, 0.0f);
+    std::vector<float> fluxT = scratch.acquire<float>(count, 0.0f);
+    std::vector<float> fluxB = scratch.acquire<float>(count, 0.0f);
+    std::vector<float> velocityU = scratch.acquireUninitialized<float>(count);
+    std::vector<float> velocityV = scratch.acquireUninitialized<float>(count);
+
+    for (uint32_t iter = 0; iter < params.pipeIterations; ++iter) {
+        PipeGrids g{width, height, heightmap.data(), terrainNext.data(), water.data(),
+                    sediment.data(), sedimentNext.data(), fluxL.data(), fluxR.data(),
+                    fluxT.data(), fluxB.data(), velocityU.data(), velocityV.data()};
+
+        runStencilPass(processor, g, c, fluxCell, fluxRow);
+        runStencilPass(processor, g, c, flowCell, flowRow);
+
+        // 平流从侵蚀后的沉积物sNext回溯取样写回s，不存在跨行依赖
+        processor.parallelFor1DChunked(height, kPipeRowsPerTask, [&](uint32_t startY, uint32_t endY) {
+            for (uint32_t y = startY; y < endY; ++y) {
+                advectRow(g, c, y, 0, width);
+            }
+        });
+        heightmap.swap(terrainNext);
+    }
+
+    // 剩余的悬移沉积物落回地面
+    processor.parallelFor1DChunked(height, kPipeRowsPerTask, [&](uint32_t startY, uint32_t endY) {
+        const size_t begin = static_cast<size_t>(startY) * width;
+        const size_t end = static_cast<size_t>(endY) * width;
+        for (size_t i = begin; i < end; ++i) {
+            heightmap[i] += sediment[i];
+        }
+    });
+
+    scratch.release(std::move(terrainNext));
+    scratch.release(std::move(water));
+    scratch.release(std::move(sediment));
+    scratch.release(std::move(sedimentNext));
+    scratch.release(std::move(fluxL));
+    scratch.release(std::move(fluxR));
+    scratch.release(std::move(fluxT));
+    scratch.release(std::move(fluxB));
+    scratch.release(std::move(velocityU));
+    scratch.release(std::move(velocityV));
+    return true;
+}
+
+} // namespace internal
+} // namespace MapGenerator
@@ -0,0 +1,30 @@
+// src/internal/PipeErosion.h
+#ifndef MAPGENERATOR_INTERNAL_PIPEEROSION_H
+#define MAPGENERATOR_INTERNAL_PIPEEROSION_H
+
+#include "CommonTypes.h"
+#include "NoiseKernels.h"
+#include "ParallelUtils.h"
+#include "ScratchPool.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace MapGenerator {
+namespace internal {
+
+// 管道模型占用的整图浮点网格数：地形（双缓冲）、水深、沉积物（双缓冲）、四向出流通量、速度
+constexpr size_t kPipeErosionGrids = 10;
+
+// 虚拟管道（出流通量）水力侵蚀，每轮依次为：
+// 通量（降雨后的水面高差驱动四向出流，按水量限幅）、水深与速度（流入减流出）、
+// 侵蚀沉积（搬运能力与坡度和流速成正比）、沉积物半拉格朗日平流与蒸发。
+// 每一遍只读上一遍的网格、只写本格，按行并行，结果与线程数和指令集无关；
+// 地图边界是封闭的，水不会流出图外。运行params.pipeIterations轮，尺寸小于3x3时返回false
+bool applyPipeErosion(HeightMap& heightmap, uint32_t width, uint32_t height,
+                      const ErosionParams& params, ParallelProcessor& processor,
+                      ScratchPool& scratch, SimdLevel level = detectSimdLevel());
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_PIPEEROSION_H
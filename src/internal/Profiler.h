@@ -0,0 +1,108 @@
+// src/internal/Profiler.h
+#ifndef MAPGENERATOR_INTERNAL_PROFILER_H
+#define MAPGENERATOR_INTERNAL_PROFILER_H
+
+#include "CommonTypes.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// 分阶段性能记录的编译期开关，默认开启；关闭后计时和计数全部编译为空操作
+#ifndef MG_ENABLE_PROFILING
+    #define MG_ENABLE_PROFILING 1
+#endif
+
+// 累加阶段计数，profile为空时忽略；关闭时仍对value求值，只为计数保存的局部变量不会被报未使用
+#if MG_ENABLE_PROFILING
+    #define MG_PROFILE_COUNT(profile, field, value) \
+        do { if (profile) (profile)->field += (value); } while (0)
+#else
+    #define MG_PROFILE_COUNT(profile, field, value) \
+        do { (void)(profile); (void)(value); } while (0)
+#endif
+
+namespace MapGenerator {
+namespace internal {
+
+// 进程已用的CPU时间（毫秒）
+double processCpuMs();
+
+// 阶段计时：构造时记录起点，析构时把墙钟和CPU时间累加到profile的对应阶段。
+// 每个阶段只在调用线程上取两次时钟，开销与阶段本身相比可忽略
+class StageTimer {
+public:
+#if MG_ENABLE_PROFILING
+    StageTimer(MapProfile* profile, GenerationStage stage, uint32_t threads)
+        : m_stage(profile ? &profile->stages[static_cast<size_t>(stage)] : nullptr) {
+        if (!m_stage) return;
+        profile->enabled = true;
+        m_stage->threads = threads;
+        m_cpuStart = processCpuMs();
+        m_wallStart = std::chrono::steady_clock::now();
+    }
+
+    ~StageTimer() { stop(); }
+
+    // 提前结束计时，之后的析构不再记录
+    void stop() {
+        if (!m_stage) return;
+        auto wallEnd = std::chrono::steady_clock::now();
+        m_stage->wallMs += std::chrono::duration<double, std::milli>(wallEnd - m_wallStart).count();
+        m_stage->cpuMs += processCpuMs() - m_cpuStart;
+        m_stage = nullptr;
+    }
+#else
+    StageTimer(MapProfile*, GenerationStage, uint32_t) {}
+    void stop() {}
+#endif
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+#if MG_ENABLE_PROFILING
+    MapStageProfile* m_stage;
+    std::chrono::steady_clock::time_point m_wallStart;
+    double m_cpuStart = 0.0;
+#endif
+};
+
+// 标记阶段结果取自缓存
+inline void markStageCached(MapProfile* profile, GenerationStage stage) {
+#if MG_ENABLE_PROFILING
+    if (profile) {
+        profile->enabled = true;
+        profile->stages[static_cast<size_t>(stage)].cached = true;
+    }
+#else
+    (void)profile;
+    (void)stage;
+#endif
+}
+
+// 记录阶段申请的缓冲区字节数
+inline void addStageBytes(MapProfile* profile, GenerationStage stage, size_t bytes) {
+#if MG_ENABLE_PROFILING
+    if (profile) profile->stages[static_cast<size_t>(stage)].bytesAllocated += bytes;
+#else
+    (void)profile;
+    (void)stage;
+    (void)bytes;
+#endif
+}
+
+// 阶段实际使用的线程数少于线程池时（如湖泊数少于线程数）修正记录
+inline void setStageThreads(MapProfile* profile, GenerationStage stage, uint32_t threads) {
+#if MG_ENABLE_PROFILING
+    if (profile) profile->stages[static_cast<size_t>(stage)].threads = threads;
+#else
+    (void)profile;
+    (void)stage;
+    (void)threads;
+#endif
+}
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_PROFILER_H
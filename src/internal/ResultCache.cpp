@@ -0,0 +1,338 @@
+// src/internal/ResultCache.cpp
+#include "ResultCache.h"
+#include <algorithm>
+#include <cstring>
+
+namespace MapGenerator {
+namespace internal {
+
+namespace {
+
+// splitmix64终结函数
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+inline void hashCombine(uint64_t& h, uint64_t value) {
+    h = mix64(h ^ (value + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2)));
+}
+
+// 浮点按位比较和哈希，保证两者一致
+inline uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+} // namespace
+
+uint64_t combineFingerprint(uint64_t upstream, uint64_t value) {
+    hashCombine(upstream, value);
+    return upstream;
+}
+
+uint64_t hashNoiseParams(const NoiseParams& params) {
+    uint64_t h = 0xBB67AE8584CAA73Bull;
+    hashCombine(h, floatBits(params.scale));
+    hashCombine(h, static_cast<uint32_t>(params.octaves));
+    hashCombine(h, floatBits(params.persistence));
+    hashCombine(h, floatBits(params.lacunarity));
+    hashCombine(h, static_cast<uint32_t>(params.type));
+    hashCombine(h, params.islandMode ? 1u : 0u);
+    hashCombine(h, params.erosionIterations);
+    hashCombine(h, floatBits(params.warpStrength));
+    hashCombine(h, floatBits(params.warpFrequency));
+    hashCombine(h, floatBits(params.ridgeWeight));
+    hashCombine(h, floatBits(params.terraceLevels));
+    hashCombine(h, params.tilePeriod);
+    hashCombine(h, params.domainWarp.enabled ? 1u : 0u);
+    hashCombine(h, floatBits(params.domainWarp.strength));
+    hashCombine(h, floatBits(params.domainWarp.frequency));
+    hashCombine(h, params.domainWarp.octaves);
+    hashCombine(h, params.layers.size());
+    for (const auto& layer : params.layers) {
+        hashCombine(h, floatBits(layer.weight));
+        hashCombine(h, floatBits(layer.scale));
+        hashCombine(h, static_cast<uint32_t>(layer.octaves));
+        hashCombine(h, floatBits(layer.persistence));
+        hashCombine(h, floatBits(layer.lacunarity));
+        hashCombine(h, static_cast<uint32_t>(layer.type));
+        hashCombine(h, layer.islandMode ? 1u : 0u);
+    }
+    return h;
+}
+
+uint64_t hashErosionParams(const ErosionParams& params) {
+    uint64_t h = 0x3C6EF372FE94F82Bull;
+    hashCombine(h, params.iterations);
+    hashCombine(h, floatBits(params.rainAmount));
+    hashCombine(h, floatBits(params.evaporationRate));
+    hashCombine(h, floatBits(params.sedimentCapacity));
+    hashCombine(h, floatBits(params.depositionRate));
+    hashCombine(h, floatBits(params.erosionRate));
+    hashCombine(h, floatBits(params.gravity));
+    hashCombine(h, floatBits(params.waterLevel));
+    hashCombine(h, params.thermalErosion ? 1u : 0u);
+    hashCombine(h, floatBits(params.talusAngle));
+    hashCombine(h, floatBits(params.thermalRate));
+    hashCombine(h, floatBits(params.thermalTolerance));
+    hashCombine(h, params.hydraulicErosion ? 1u : 0u);
+    hashCombine(h, params.dropletLifetime);
+    hashCombine(h, floatBits(params.inertia));
+    hashCombine(h, floatBits(params.minSlope));
+    hashCombine(h, floatBits(params.pipeLength));
+    hashCombine(h, params.pipeIterations);
+    hashCombine(h, floatBits(params.timeStep));
+    hashCombine(h, static_cast<uint32_t>(params.hydraulicModel));
+    hashCombine(h, floatBits(params.dropletsPerCell));
+    hashCombine(h, params.dropletRadius);
+    return h;
+}
+
+namespace {
+
+bool sameNoiseParams(const NoiseParams& a, const NoiseParams& b) {
+    if (!(floatBits(a.scale) == floatBits(b.scale) &&
+          a.octaves == b.octaves &&
+          floatBits(a.persistence) == floatBits(b.persistence) &&
+          floatBits(a.lacunarity) == floatBits(b.lacunarity) &&
+          a.type == b.type &&
+          a.islandMode == b.islandMode &&
+          a.erosionIterations == b.erosionIterations &&
+          floatBits(a.warpStrength) == floatBits(b.warpStrength) &&
+          floatBits(a.warpFrequency) == floatBits(b.warpFrequency) &&
+          floatBits(a.ridgeWeight) == floatBits(b.ridgeWeight) &&
+          floatBits(a.terraceLevels) == floatBits(b.terraceLevels) &&
+          a.tilePeriod == b.tilePeriod &&
+          a.domainWarp.enabled == b.domainWarp.enabled &&
+          floatBits(a.domainWarp.strength) == floatBits(b.domainWarp.strength) &&
+          floatBits(a.domainWarp.frequency) == floatBits(b.domainWarp.frequency) &&
+          a.domainWarp.octaves == b.domainWarp.octaves &&
+          a.layers.size() == b.layers.size())) {
+        return false;
+    }
+    for (size_t i = 0; i < a.layers.size(); ++i) {
+        const auto& la = a.layers[i];
+        const auto& lb = b.layers[i];
+        if (!(floatBits(la.weight) == floatBits(lb.weight) &&
+              floatBits(la.scale) == floatBits(lb.scale) &&
+              la.octaves == lb.octaves &&
+              floatBits(la.persistence) == floatBits(lb.persistence) &&
+              floatBits(la.lacunarity) == floatBits(lb.lacunarity) &&
+              la.type == lb.type &&
+              la.islandMode == lb.islandMode)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameErosionParams(const ErosionParams& a, const ErosionParams& b) {
+    return a.iterations == b.iterations &&
+           floatBits(a.rainAmount) == floatBits(b.rainAmount) &&
+           floatBits(a.evaporationRate) == floatBits(b.evaporationRate) &&
+           floatBits(a.sedimentCapacity) == floatBits(b.sedimentCapacity) &&
+           floatBits(a.depositionRate) == floatBits(b.depositionRate) &&
+           floatBits(a.erosionRate) == floatBits(b.erosionRate) &&
+           floatBits(a.gravity) == floatBits(b.gravity) &&
+           floatBits(a.waterLevel) == floatBits(b.waterLevel) &&
+           a.thermalErosion == b.thermalErosion &&
+           floatBits(a.talusAngle) == floatBits(b.talusAngle) &&
+           floatBits(a.thermalRate) == floatBits(b.thermalRate) &&
+           floatBits(a.thermalTolerance) == floatBits(b.thermalTolerance) &&
+           a.hydraulicErosion == b.hydraulicErosion &&
+           a.dropletLifetime == b.dropletLifetime &&
+           floatBits(a.inertia) == floatBits(b.inertia) &&
+           floatBits(a.minSlope) == floatBits(b.minSlope) &&
+           floatBits(a.pipeLength) == floatBits(b.pipeLength) &&
+           a.pipeIterations == b.pipeIterations &&
+           floatBits(a.timeStep) == floatBits(b.timeStep) &&
+           a.hydraulicModel == b.hydraulicModel &&
+           floatBits(a.dropletsPerCell) == floatBits(b.dropletsPerCell) &&
+           a.dropletRadius == b.dropletRadius;
+}
+
+} // namespace
+
+uint64_t hashReliefInputs(const ReliefInputs& inputs) {
+    uint64_t key = combineFingerprint(inputs.seed,
+                                      (static_cast<uint64_t>(inputs.width) << 32) | inputs.height);
+    key = combineFingerprint(key, hashNoiseParams(inputs.noise));
+    key = combineFingerprint(key, hashErosionParams(inputs.erosion));
+    return combineFingerprint(key, inputs.smoothingRadius);
+}
+
+bool sameReliefInputs(const ReliefInputs& a, const ReliefInputs& b) {
+    return a.seed == b.seed &&
+           a.width == b.width &&
+           a.height == b.height &&
+           a.smoothingRadius == b.smoothingRadius &&
+           sameNoiseParams(a.noise, b.noise) &&
+           sameErosionParams(a.erosion, b.erosion);
+}
+
+uint64_t hashMapConfig(const MapConfig& config) {
+    uint64_t h = 0x6A09E667F3BCC909ull;
+    hashCombine(h, config.width);
+    hashCombine(h, config.height);
+    hashCombine(h, config.seed);
+    hashCombine(h, floatBits(config.noiseScale));
+    hashCombine(h, static_cast<uint32_t>(config.noiseOctaves));
+    hashCombine(h, floatBits(config.noisePersistence));
+    hashCombine(h, floatBits(config.noiseLacunarity));
+    hashCombine(h, floatBits(config.seaLevel));
+    hashCombine(h, floatBits(config.beachHeight));
+    hashCombine(h, floatBits(config.plainHeight));
+    hashCombine(h, floatBits(config.hillHeight));
+    hashCombine(h, floatBits(config.mountainHeight));
+    hashCombine(h, static_cast<uint32_t>(config.climate));
+    hashCombine(h, floatBits(config.temperature));
+    hashCombine(h, floatBits(config.humidity));
+    hashCombine(h, static_cast<uint32_t>(config.hydrology));
+    hashCombine(h, static_cast<uint32_t>(config.erosion));
+    hashCombine(h, config.compactTiles ? 1u : 0u);
+    hashCombine(h, static_cast<uint32_t>(config.heightFormat));
+    hashCombine(h, static_cast<uint32_t>(config.preset));
+    return h;
+}
+
+bool sameMapConfig(const MapConfig& a, const MapConfig& b) {
+    return a.width == b.width &&
+           a.height == b.height &&
+           a.seed == b.seed &&
+           floatBits(a.noiseScale) == floatBits(b.noiseScale) &&
+           a.noiseOctaves == b.noiseOctaves &&
+           floatBits(a.noisePersistence) == floatBits(b.noisePersistence) &&
+           floatBits(a.noiseLacunarity) == floatBits(b.noiseLacunarity) &&
+           floatBits(a.seaLevel) == floatBits(b.seaLevel) &&
+           floatBits(a.beachHeight) == floatBits(b.beachHeight) &&
+           floatBits(a.plainHeight) == floatBits(b.plainHeight) &&
+           floatBits(a.hillHeight) == floatBits(b.hillHeight) &&
+           floatBits(a.mountainHeight) == floatBits(b.mountainHeight) &&
+           a.climate == b.climate &&
+           floatBits(a.temperature) == floatBits(b.temperature) &&
+           floatBits(a.humidity) == floatBits(b.humidity) &&
+           a.hydrology == b.hydrology &&
+           a.erosion == b.erosion &&
+           a.compactTiles == b.compactTiles &&
+           a.heightFormat == b.heightFormat &&
+           a.preset == b.preset;
+}
+
+size_t mapDataBytes(const MapData& data) {
+    return sizeof(MapData) +
+           data.heightMap.capacity() * sizeof(float) +
+           data.heightSamples.capacity() * sizeof(uint16_t) +
+           (data.terrainMap.capacity() + data.decorationMap.capacity() +
+            data.resourceMap.capacity()) * sizeof(uint32_t) +
+           data.terrainTiles.capacity() + data.decorationTiles.capacity() +
+           data.resourceTiles.capacity() +
+           (data.temperature.values.capacity() + data.moisture.values.capacity()) * sizeof(float);
+}
+
+ResultCache::ResultCache(size_t byteBudget, size_t shardCount)
+    : m_shards(std::max<size_t>(1, shardCount)),
+      m_byteBudget(byteBudget) {
+}
+
+std::shared_ptr<MapData> ResultCache::find(uint64_t key, const MapConfig& config) {
+    Shard& shard = shardFor(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end() && sameMapConfig(it->second->config, config)) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second->data;
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void ResultCache::insert(uint64_t key, const MapConfig& config, std::shared_ptr<MapData> data) {
+    if (!data) return;
+
+    size_t bytes = mapDataBytes(*data);
+    size_t budget = m_byteBudget.load(std::memory_order_relaxed);
+    if (bytes > budget) return;
+
+    const size_t shardIndex = key % m_shards.size();
+    Shard& shard = m_shards[shardIndex];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // 同键旧条目（含哈希碰撞的不同配置）直接替换
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            shard.bytes -= it->second->bytes;
+            m_totalBytes.fetch_sub(it->second->bytes, std::memory_order_relaxed);
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+
+        shard.lru.push_front(Entry{key, config, std::move(data), bytes});
+        shard.index[key] = shard.lru.begin();
+        shard.bytes += bytes;
+        m_totalBytes.fetch_add(bytes, std::memory_order_relaxed);
+        evictLocked(shard, budget, 1);
+    }
+    evictAcrossShards(shardIndex + 1, budget);
+}
+
+void ResultCache::evictLocked(Shard& shard, size_t budget, size_t keep) {
+    while (m_totalBytes.load(std::memory_order_relaxed) > budget && shard.lru.size() > keep) {
+        const Entry& victim = shard.lru.back();
+        shard.bytes -= victim.bytes;
+        m_totalBytes.fetch_sub(victim.bytes, std::memory_order_relaxed);
+        shard.index.erase(victim.key);
+        shard.lru.pop_back();
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ResultCache::evictAcrossShards(size_t first, size_t budget) {
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+        if (m_totalBytes.load(std::memory_order_relaxed) <= budget) return;
+        Shard& shard = m_shards[(first + i) % m_shards.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        evictLocked(shard, budget, 0);
+    }
+}
+
+void ResultCache::clear() {
+    for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        m_totalBytes.fetch_sub(shard.bytes, std::memory_order_relaxed);
+        shard.lru.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+    }
+}
+
+void ResultCache::setByteBudget(size_t byteBudget) {
+    m_byteBudget.store(byteBudget, std::memory_order_relaxed);
+    evictAcrossShards(0, byteBudget);
+}
+
+MapCacheStats ResultCache::stats() const {
+    MapCacheStats result;
+    result.hits = m_hits.load(std::memory_order_relaxed);
+    result.misses = m_misses.load(std::memory_order_relaxed);
+    result.evictions = m_evictions.load(std::memory_order_relaxed);
+    result.byteBudget = m_byteBudget.load(std::memory_order_relaxed);
+    for (const auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        result.entries += shard.lru.size();
+        result.bytes += shard.bytes;
+    }
+    return result;
+}
+
+} // namespace internal
+} // namespace MapGenerator
@@ -0,0 +1,98 @@
+// src/internal/ResultCache.h
+#ifndef MAPGENERATOR_INTERNAL_RESULTCACHE_H
+#define MAPGENERATOR_INTERNAL_RESULTCACHE_H
+
+#include "CommonTypes.h"
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace MapGenerator {
+namespace internal {
+
+// 配置的64位哈希与逐字段比较，覆盖所有影响生成结果的字段。threadCount不参与：
+// 各阶段的输出都与线程数无关（随机数按位置播种，并行收集的候选先排序再抽选），
+// tests/golden_presets按多个线程数校验这一点。MapConfig新增影响结果的字段时需同时更新两者
+uint64_t hashMapConfig(const MapConfig& config);
+bool sameMapConfig(const MapConfig& a, const MapConfig& b);
+
+// 阶段指纹：上游阶段指纹与本阶段实际使用的参数组合而成
+uint64_t combineFingerprint(uint64_t upstream, uint64_t value);
+uint64_t hashNoiseParams(const NoiseParams& params);
+uint64_t hashErosionParams(const ErosionParams& params);
+
+// 起伏阶段（噪声→侵蚀→平滑）的全部输入：按实际生效的噪声与侵蚀参数记录，
+// 只改变湿度等不影响这些参数的配置时仍相同
+struct ReliefInputs {
+    uint32_t seed = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    NoiseParams noise;
+    ErosionParams erosion;
+    uint32_t smoothingRadius = 0;
+};
+uint64_t hashReliefInputs(const ReliefInputs& inputs);
+bool sameReliefInputs(const ReliefInputs& a, const ReliefInputs& b);
+
+// 地图数据占用的堆内存字节数估算
+size_t mapDataBytes(const MapData& data);
+
+// 分片LRU结果缓存：按键分到各分片，每个分片独立加锁；字节预算是各分片共用的总额，
+// 超出时先淘汰插入分片中最久未用的条目，不够再依次淘汰其他分片的。
+// 命中时再比较完整配置，哈希碰撞按未命中处理
+class ResultCache {
+public:
+    static constexpr size_t kDefaultByteBudget = size_t(512) << 20;
+    static constexpr size_t kDefaultShardCount = 8;
+
+    explicit ResultCache(size_t byteBudget = kDefaultByteBudget,
+                         size_t shardCount = kDefaultShardCount);
+
+    std::shared_ptr<MapData> find(uint64_t key, const MapConfig& config);
+    // 单个结果超过总预算时不缓存
+    void insert(uint64_t key, const MapConfig& config, std::shared_ptr<MapData> data);
+
+    void clear();
+    void setByteBudget(size_t byteBudget);
+    size_t byteBudget() const { return m_byteBudget.load(std::memory_order_relaxed); }
+    size_t bytes() const { return m_totalBytes.load(std::memory_order_relaxed); }
+    MapCacheStats stats() const;
+
+private:
+    struct Entry {
+        uint64_t key;
+        MapConfig config;
+        std::shared_ptr<MapData> data;
+        size_t bytes;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;   // 表头为最近使用
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    Shard& shardFor(uint64_t key) { return m_shards[key % m_shards.size()]; }
+    // 淘汰shard中最久未用的条目，直到总字节数不超过budget；keep为保留不淘汰的条目数
+    // （插入分片保留刚插入的表头），调用方持有分片锁
+    void evictLocked(Shard& shard, size_t budget, size_t keep);
+    // 从first号分片起依次淘汰，直到总字节数不超过budget，同一时刻只持有一个分片的锁
+    void evictAcrossShards(size_t first, size_t budget);
+
+    std::vector<Shard> m_shards;
+    std::atomic<size_t> m_byteBudget;
+    std::atomic<size_t> m_totalBytes{0};
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_evictions{0};
+};
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_RESULTCACHE_H
@@ -0,0 +1,137 @@
+// src/internal/ScratchPool.h
+#ifndef MAPGENERATOR_INTERNAL_SCRATCHPOOL_H
+#define MAPGENERATOR_INTERNAL_SCRATCHPOOL_H
+
+#include "CommonTypes.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace MapGenerator {
+namespace internal {
+
+// 临时缓冲区池：由生成引擎持有，在各阶段之间、多次生成之间复用整图大小的临时缓冲区。
+// 按元素类型和容量档位分组（每两个相邻的2的幂之间分4档，容量浪费不超过25%），
+// 稳态生成时所有临时缓冲区都取自池中，不再有大块堆分配；空闲总字节数超过上限时直接释放归还的缓冲区
+class ScratchPool {
+public:
+    static constexpr size_t kDefaultMaxCachedBytes = size_t(1) << 30;
+    // 小于该元素数的缓冲区统一按这一档分配
+    static constexpr size_t kMinClassElements = 1024;
+
+    explicit ScratchPool(size_t maxCachedBytes = kDefaultMaxCachedBytes)
+        : m_maxCachedBytes(maxCachedBytes) {}
+
+    // 取出一个大小为count、全部元素为value的缓冲区
+    template<typename T>
+    std::vector<T> acquire(size_t count, T value = T()) {
+        std::vector<T> buffer = take<T>(count);
+        buffer.assign(count, value);
+        return buffer;
+    }
+
+    // 取出一个大小为count、内容未指定的缓冲区，调用方会写满全部元素
+    template<typename T>
+    std::vector<T> acquireUninitialized(size_t count) {
+        std::vector<T> buffer = take<T>(count);
+        buffer.resize(count);
+        return buffer;
+    }
+
+    // 归还缓冲区；容量不足最小档位或超出缓存上限时直接释放
+    template<typename T>
+    void release(std::vector<T>&& buffer) {
+        std::vector<T> local = std::move(buffer);
+        buffer = std::vector<T>();
+        if (local.capacity() < kMinClassElements) return;
+
+        // 外来缓冲区的容量不一定正好在档位上，按不超过容量的档位登记
+        size_t capacity = floorClass(local.capacity());
+        size_t bytes = capacity * sizeof(T);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.bytesInUse -= std::min(m_stats.bytesInUse, bytes);
+        if (m_stats.bytesCached + bytes > m_maxCachedBytes) {
+            return;
+        }
+        std::get<FreeList<T>>(m_freeLists)[capacity].push_back(std::move(local));
+        m_stats.bytesCached += bytes;
+    }
+
+    // 释放所有空闲缓冲区，借出中的缓冲区不受影响
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::get<FreeList<float>>(m_freeLists).clear();
+        std::get<FreeList<uint8_t>>(m_freeLists).clear();
+        std::get<FreeList<uint32_t>>(m_freeLists).clear();
+        m_stats.bytesCached = 0;
+    }
+
+    MapScratchStats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    // 容量档位：不小于count的最小档位
+    static size_t classCapacity(size_t count) {
+        if (count <= kMinClassElements) return kMinClassElements;
+        size_t step = highestPowerOfTwo(count) / 4;
+        return (count + step - 1) / step * step;
+    }
+
+private:
+    template<typename T>
+    using FreeList = std::map<size_t, std::vector<std::vector<T>>>;
+
+    static size_t highestPowerOfTwo(size_t value) {
+        size_t power = 1;
+        while (power <= value / 2) power *= 2;
+        return power;
+    }
+
+    // 不超过capacity的最大档位
+    static size_t floorClass(size_t capacity) {
+        size_t step = highestPowerOfTwo(capacity) / 4;
+        return capacity / step * step;
+    }
+
+    template<typename T>
+    std::vector<T> take(size_t count) {
+        size_t capacity = classCapacity(count);
+        size_t bytes = capacity * sizeof(T);
+        std::vector<T> buffer;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& freeList = std::get<FreeList<T>>(m_freeLists);
+            auto it = freeList.find(capacity);
+            if (it != freeList.end() && !it->second.empty()) {
+                buffer = std::move(it->second.back());
+                it->second.pop_back();
+                m_stats.bytesCached -= bytes;
+                m_stats.reuses++;
+            } else {
+                m_stats.allocations++;
+            }
+            m_stats.bytesInUse += bytes;
+            m_stats.peakBytesInUse = std::max(m_stats.peakBytesInUse, m_stats.bytesInUse);
+        }
+        if (buffer.capacity() < capacity) {
+            buffer.reserve(capacity);
+        }
+        return buffer;
+    }
+
+    size_t m_maxCachedBytes;
+    std::tuple<FreeList<float>, FreeList<uint8_t>, FreeList<uint32_t>> m_freeLists;
+    MapScratchStats m_stats;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_SCRATCHPOOL_H
@@ -0,0 +1,39 @@
+// src/internal/SimdTarget.h
+#ifndef MAPGENERATOR_INTERNAL_SIMDTARGET_H
+#define MAPGENERATOR_INTERNAL_SIMDTARGET_H
+
+// 各SIMD内核共用的平台检测和按函数启用指令集的属性，只在内核的.cpp中包含；
+// 指令集级别的选择见NoiseKernels.h中的SimdLevel
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define MG_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #endif
+#else
+    #define MG_SIMD_X86 0
+#endif
+
+// GCC/Clang 按函数启用指令集，MSVC 无需属性即可使用对应内建函数
+#if MG_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+    #define MG_TARGET_SSE41 __attribute__((target("sse4.1")))
+    #define MG_TARGET_AVX2 __attribute__((target("avx2")))
+    #define MG_TARGET_AVX2_F16C __attribute__((target("avx2,f16c")))
+#else
+    #define MG_TARGET_SSE41
+    #define MG_TARGET_AVX2
+    #define MG_TARGET_AVX2_F16C
+#endif
+
+namespace MapGenerator {
+namespace internal {
+
+// 与_mm_min_ps/_mm256_max_ps等语义一致（比较为假时取第二个操作数），标量与向量内核因此逐位一致
+inline float minSel(float a, float b) { return a < b ? a : b; }
+inline float maxSel(float a, float b) { return a > b ? a : b; }
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_SIMDTARGET_H
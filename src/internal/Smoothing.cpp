@@ -0,0 +1,235 @@
+// src/internal/Smoothing.cpp
+#include "Smoothing.h"
+#include "SimdTarget.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace MapGenerator {
+namespace internal {
+
+namespace {
+
+// 每个任务处理的行数
+constexpr uint32_t kSmoothRowsPerTask = 16;
+// 纵向滑动和按列条带并行，每条的列数
+constexpr uint32_t kSmoothColumnsPerStrip = 64;
+
+// 每个位置的窗口[i-r, i+r]与[0, n)相交的格子数的倒数
+std::vector<float> inverseWindowCounts(uint32_t n, uint32_t radius) {
+    std::vector<float> inverse(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        int64_t lo = std::max<int64_t>(static_cast<int64_t>(i) - radius, 0);
+        int64_t hi = std::min<int64_t>(static_cast<int64_t>(i) + radius, static_cast<int64_t>(n) - 1);
+        inverse[i] = 1.0f / static_cast<float>(hi - lo + 1);
+    }
+    return inverse;
+}
+
+// ---- 横向一遍 ----
+// 直接求和：padded为前后各补radius个0的行，out[x] = (padded[x] + ... + padded[x+2r]) * inverse[x]
+void boxRowDirectScalar(const float* padded, const float* inverse, float* out,
+                        uint32_t x0, uint32_t x1, uint32_t radius) {
+    const uint32_t taps = 2 * radius + 1;
+    for (uint32_t x = x0; x < x1; ++x) {
+        float sum = padded[x];
+        for (uint32_t d = 1; d < taps; ++d) {
+            sum += padded[x + d];
+        }
+        out[x] = sum * inverse[x];
+    }
+}
+
+// 滑动和：prefix[k]为行内前(k-radius)个格子之和（下标超出行时截断），
+// 窗口和即prefix[x+2r+1] - prefix[x]；累加用double，长行也不会丢精度
+void boxRowPrefixScalar(const double* prefix, const float* inverse, float* out,
+                        uint32_t x0, uint32_t x1, uint32_t radius) {
+    const uint32_t taps = 2 * radius + 1;
+    for (uint32_t x = x0; x < x1; ++x) {
+        out[x] = static_cast<float>(prefix[x + taps] - prefix[x]) * inverse[x];
+    }
+}
+
+using BoxRowDirectFn = void (*)(const float*, const float*, float*, uint32_t, uint32_t, uint32_t);
+using BoxRowPrefixFn = void (*)(const double*, const float*, float*, uint32_t, uint32_t, uint32_t);
+
+#if MG_SIMD_X86
+
+// ---- AVX2：每次8格，运算顺序与标量单格相同 ----
+
+MG_TARGET_AVX2 void boxRowDirectAvx2(const float* padded, const float* inverse, float* out,
+                                     uint32_t x0, uint32_t x1, uint32_t radius) {
+    const uint32_t taps = 2 * radius + 1;
+    uint32_t x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        __m256 sum = _mm256_loadu_ps(padded + x);
+        for (uint32_t d = 1; d < taps; ++d) {
+            sum = _mm256_add_ps(sum, _mm256_loadu_ps(padded + x + d));
+        }
+        _mm256_storeu_ps(out + x, _mm256_mul_ps(sum, _mm256_loadu_ps(inverse + x)));
+    }
+    boxRowDirectScalar(padded, inverse, out, x, x1, radius);
+}
+
+MG_TARGET_AVX2 void boxRowPrefixAvx2(const double* prefix, const float* inverse, float* out,
+                                     uint32_t x0, uint32_t x1, uint32_t radius) {
+    const uint32_t taps = 2 * radius + 1;
+    uint32_t x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        __m128 lo = _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(prefix + x + taps),
+                                                  _mm256_loadu_pd(prefix + x)));
+        __m128 hi = _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(prefix + x + 4 + taps),
+                                                  _mm256_loadu_pd(prefix + x + 4)));
+        __m256 sum = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+        _mm256_storeu_ps(out + x, _mm256_mul_ps(sum, _mm256_loadu_ps(inverse + x)));
+    }
+    boxRowPrefixScalar(prefix, inverse, out, x, x1, radius);
+}
+
+#endif // MG_SIMD_X86
+
+// 纵向一遍，直接求和：目标行为源中[y-r, y+r]∩[0, height)各行按顺序相加再乘以格子数的倒数
+void boxColumnsDirect(const float* src, float* dst, uint32_t width, uint32_t height,
+                      uint32_t radius, const float* inverse, ParallelProcessor& processor) {
+    processor.parallelFor1DChunked(height, kSmoothRowsPerTask, [&](uint32_t startY, uint32_t endY) {
+        for (uint32_t y = startY; y < endY; ++y) {
+            const uint32_t lo = y >= radius ? y - radius : 0;
+            const uint32_t hi = std::min(y + radius, height - 1);
+            float* out = dst + static_cast<size_t>(y) * width;
+            std::copy(src + static_cast<size_t>(lo) * width, src + static_cast<size_t>(lo + 1) * width, out);
+            for (uint32_t k = lo + 1; k <= hi; ++k) {
+                const float* in = src + static_cast<size_t>(k) * width;
+                for (uint32_t x = 0; x < width; ++x) {
+                    out[x] += in[x];
+                }
+            }
+            const float scale = inverse[y];
+            for (uint32_t x = 0; x < width; ++x) {
+                out[x] *= scale;
+            }
+        }
+    });
+}
+
+// 纵向一遍，滑动和：按列条带自上而下，加入新进窗口的行、减去移出窗口的行
+void boxColumnsSliding(const float* src, float* dst, uint32_t width, uint32_t height,
+                       uint32_t radius, const float* inverse, ParallelProcessor& processor) {
+    const uint32_t strips = (width + kSmoothColumnsPerStrip - 1) / kSmoothColumnsPerStrip;
+    const uint64_t taps = 2 * static_cast<uint64_t>(radius) + 1;
+    processor.parallelFor1DChunked(strips, 1, [&](uint32_t start, uint32_t end) {
+        double sum[kSmoothColumnsPerStrip];
+        for (uint32_t strip = start; strip < end; ++strip) {
+            const uint32_t x0 = strip * kSmoothColumnsPerStrip;
+            const uint32_t span = std::min(kSmoothColumnsPerStrip, width - x0);
+            std::fill(sum, sum + span, 0.0);
+            // 第j步加入第j行，窗口变为[j-2r, j]，对应目标行j-r
+            for (uint64_t j = 0; j < static_cast<uint64_t>(height) + radius; ++j) {
+                if (j < height) {
+                    const float* in = src + j * width + x0;
+                    for (uint32_t x = 0; x < span; ++x) sum[x] += in[x];
+                }
+                if (j >= taps) {
+                    const float* in = src + (j - taps) * width + x0;
+                    for (uint32_t x = 0; x < span; ++x) sum[x] -= in[x];
+                }
+                if (j >= radius) {
+                    const size_t y = static_cast<size_t>(j - radius);
+                    const float scale = inverse[y];
+                    float* out = dst + y * width + x0;
+                    for (uint32_t x = 0; x < span; ++x) out[x] = static_cast<float>(sum[x]) * scale;
+                }
+            }
+        }
+    });
+}
+
+} // namespace
+
+void applyBoxBlur(HeightMap& heightmap, uint32_t width, uint32_t height, uint32_t radius,
+                  ScratchPool& scratch, ParallelProcessor& processor, SimdLevel level) {
+    const size_t count = static_cast<size_t>(width) * height;
+    if (radius == 0 || width == 0 || height == 0 || heightmap.size() < count) {
+        return;
+    }
+
+    BoxRowDirectFn rowDirect = boxRowDirectScalar;
+    BoxRowPrefixFn rowPrefix = boxRowPrefixScalar;
+#if MG_SIMD_X86
+    if (level == SimdLevel::AVX2 && detectSimdLevel() == SimdLevel::AVX2) {
+        rowDirect = boxRowDirectAvx2;
+        rowPrefix = boxRowPrefixAvx2;
+    }
+#else
+    (void)level;
+#endif
+
+    const bool direct = radius <= kDirectSmoothingRadius;
+    const std::vector<float> inverseX = inverseWindowCounts(width, radius);
+    const std::vector<float> inverseY = inverseWindowCounts(height, radius);
+
+    // 纵向：高度图 -> 临时缓冲区
+    HeightMap columns = scratch.acquireUninitialized<float>(count);
+    if (direct) {
+        boxColumnsDirect(heightmap.data(), columns.data(), width, height, radius, inverseY.data(), processor);
+    } else {
+        boxColumnsSliding(heightmap.data(), columns.data(), width, height, radius, inverseY.data(), processor);
+    }
+
+    // 横向：临时缓冲区 -> 高度图，每行先拷入补边的行缓冲区
+    const size_t taps = 2 * static_cast<size_t>(radius) + 1;
+    processor.parallelFor1DChunked(height, kSmoothRowsPerTask, [&](uint32_t startY, uint32_t endY) {
+        std::vector<float> padded;
+        std::vector<double> prefix;
+        if (direct) {
+            padded.assign(width + taps - 1, 0.0f);
+        } else {
+            prefix.assign(width + taps, 0.0);
+        }
+        for (uint32_t y = startY; y < endY; ++y) {
+            const float* in = columns.data() + static_cast<size_t>(y) * width;
+            float* out = heightmap.data() + static_cast<size_t>(y) * width;
+            if (direct) {
+                std::copy(in, in + width, padded.begin() + radius);
+                rowDirect(padded.data(), inverseX.data(), out, 0, width, radius);
+                continue;
+            }
+            // prefix[0..r]为0，prefix[r+1+x]为前x+1格之和，之后保持整行之和
+            double running = 0.0;
+            for (uint32_t x = 0; x < width; ++x) {
+                running += in[x];
+                prefix[radius + 1 + x] = running;
+            }
+            std::fill(prefix.begin() + radius + 1 + width, prefix.end(), running);
+            rowPrefix(prefix.data(), inverseX.data(), out, 0, width, radius);
+        }
+    });
+    scratch.release(std::move(columns));
+}
+
+void applyGaussianBlur(HeightMap& heightmap, uint32_t width, uint32_t height, float sigma,
+                       ScratchPool& scratch, ParallelProcessor& processor, SimdLevel level) {
+    if (!(sigma > 0.0f)) {
+        return;
+    }
+
+    // 三个盒宽取相邻的两个奇数wl、wl+2，前m个用wl，使三次盒式平滑的方差之和最接近sigma²
+    constexpr int kPasses = 3;
+    const double variance = static_cast<double>(sigma) * sigma;
+    int lower = static_cast<int>(std::floor(std::sqrt(12.0 * variance / kPasses + 1.0)));
+    if (lower % 2 == 0) --lower;
+    const int upper = lower + 2;
+    const int lowerPasses = static_cast<int>(std::lround(
+        (12.0 * variance - kPasses * lower * lower - 4.0 * kPasses * lower - 3.0 * kPasses) /
+        (-4.0 * lower - 4.0)));
+
+    for (int pass = 0; pass < kPasses; ++pass) {
+        const int boxWidth = pass < lowerPasses ? lower : upper;
+        applyBoxBlur(heightmap, width, height, static_cast<uint32_t>((boxWidth - 1) / 2),
+                     scratch, processor, level);
+    }
+}
+
+} // namespace internal
+} // namespace MapGenerator
@@ -0,0 +1,33 @@
+// src/internal/Smoothing.h
+#ifndef MAPGENERATOR_INTERNAL_SMOOTHING_H
+#define MAPGENERATOR_INTERNAL_SMOOTHING_H
+
+#include "CommonTypes.h"
+#include "NoiseKernels.h"
+#include "ParallelUtils.h"
+#include "ScratchPool.h"
+#include <cstdint>
+
+namespace MapGenerator {
+namespace internal {
+
+// 不超过该半径时逐格按固定顺序直接求和，结果只取决于窗口内的高度，与格子在图中的位置无关；
+// 分块生成依赖这一点保证接缝一致。更大的半径用滑动和，每格开销与半径无关
+constexpr uint32_t kDirectSmoothingRadius = 2;
+
+// 可分离的盒式平滑：先纵向后横向，各取(2*radius+1)格的平均。
+// 窗口超出地图的部分不计入，边界格子按图内的格子数求平均，因此边缘也会被平滑。
+// 按行并行，横向一遍按指令集选择SIMD内核，结果与线程数和指令集无关
+void applyBoxBlur(HeightMap& heightmap, uint32_t width, uint32_t height, uint32_t radius,
+                  ScratchPool& scratch, ParallelProcessor& processor,
+                  SimdLevel level = detectSimdLevel());
+
+// 近似高斯平滑：连续三次盒式平滑，盒宽按sigma选取使总方差为sigma²
+void applyGaussianBlur(HeightMap& heightmap, uint32_t width, uint32_t height, float sigma,
+                       ScratchPool& scratch, ParallelProcessor& processor,
+                       SimdLevel level = detectSimdLevel());
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_SMOOTHING_H
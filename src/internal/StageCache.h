@@ -0,0 +1,96 @@
+// src/internal/StageCache.h
+#ifndef MAPGENERATOR_INTERNAL_STAGECACHE_H
+#define MAPGENERATOR_INTERNAL_STAGECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace MapGenerator {
+namespace internal {
+
+// 流水线阶段的中间结果缓存：按阶段输入指纹查找只读结果，命中时再用Same比较完整输入，
+// 哈希碰撞按未命中处理；超出条目上限或字节预算时淘汰最久未用的
+template<typename T, typename Inputs, bool (*Same)(const Inputs&, const Inputs&)>
+class StageCache {
+public:
+    explicit StageCache(size_t capacity = 4) : m_capacity(capacity) {}
+
+    std::shared_ptr<const T> find(uint64_t fingerprint, const Inputs& inputs) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->fingerprint == fingerprint && Same(it->inputs, inputs)) {
+                m_entries.splice(m_entries.begin(), m_entries, it);
+                return it->value;
+            }
+        }
+        return nullptr;
+    }
+
+    // bytes为结果占用的字节数，超过budget时不缓存
+    void insert(uint64_t fingerprint, const Inputs& inputs, std::shared_ptr<const T> value,
+                size_t bytes, size_t budget) {
+        if (bytes > budget) return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->fingerprint == fingerprint) {
+                m_bytes -= it->bytes;
+                m_entries.erase(it);
+                break;
+            }
+        }
+        m_entries.push_front(Entry{fingerprint, inputs, std::move(value), bytes});
+        m_bytes += bytes;
+        evictLocked(budget);
+    }
+
+    // 淘汰至不超过budget字节
+    void trim(size_t budget) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        evictLocked(budget);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        m_bytes = 0;
+    }
+
+    size_t entries() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    size_t bytes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_bytes;
+    }
+
+private:
+    struct Entry {
+        uint64_t fingerprint;
+        Inputs inputs;
+        std::shared_ptr<const T> value;
+        size_t bytes;
+    };
+
+    void evictLocked(size_t budget) {
+        while (!m_entries.empty() && (m_bytes > budget || m_entries.size() > m_capacity)) {
+            m_bytes -= m_entries.back().bytes;
+            m_entries.pop_back();
+        }
+    }
+
+    size_t m_capacity;
+    std::list<Entry> m_entries;
+    size_t m_bytes = 0;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_STAGECACHE_H
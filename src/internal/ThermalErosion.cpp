@@ -0,0 +1,318 @@
+// src/internal/ThermalErosion.cpp
+#include "ThermalErosion.h"
+#include "SimdTarget.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace MapGenerator {
+namespace internal {
+
+namespace {
+
+// 每个任务处理的行数
+constexpr uint32_t kThermalRowsPerTask = 16;
+
+struct ThermalConstants {
+    float talus;        // 向某个邻居崩落的高差阈值
+    float steepest;     // 最陡高差须超过该值才崩落
+    float rate;
+};
+
+// 8邻域按行优先顺序（dy、dx从-1到1）
+struct Neighborhood {
+    ptrdiff_t offset[8];
+    int32_t dx[8];
+    int32_t dy[8];
+
+    explicit Neighborhood(uint32_t width) {
+        int n = 0;
+        for (int32_t y = -1; y <= 1; ++y) {
+            for (int32_t x = -1; x <= 1; ++x) {
+                if (x == 0 && y == 0) continue;
+                offset[n] = static_cast<ptrdiff_t>(y) * width + x;
+                dx[n] = x;
+                dy[n] = y;
+                ++n;
+            }
+        }
+    }
+};
+
+
+// 第一遍：内部行[x0, x1)格的崩落系数，返回其中的最大系数
+float coefficientSpanScalar(const float* h, float* k, uint32_t width, uint32_t x0, uint32_t x1,
+                            const ThermalConstants& c) {
+    const float* up = h - width;
+    const float* down = h + width;
+    float spanMax = 0.0f;
+    for (uint32_t x = x0; x < x1; ++x) {
+        const float center = h[x];
+        const float slopes[8] = {
+            center - up[x - 1], center - up[x], center - up[x + 1],
+            center - h[x - 1], center - h[x + 1],
+            center - down[x - 1], center - down[x], center - down[x + 1]};
+        float steepest = 0.0f;
+        float count = 0.0f;
+        for (int n = 0; n < 8; ++n) {
+            steepest = maxSel(slopes[n], steepest);
+            count += slopes[n] > c.talus ? 1.0f : 0.0f;
+        }
+        const float share = c.rate / maxSel(count, 1.0f);
+        const float coefficient = (count > 0.0f && steepest > c.steepest) ? share : 0.0f;
+        k[x] = coefficient;
+        spanMax = maxSel(coefficient, spanMax);
+    }
+    return spanMax;
+}
+
+// 第二遍内部格[x0, x1)：减去流向低处的量，加上高处邻居按其系数流入的量；返回最大变化
+float gatherSpanScalar(const float* h, const float* k, float* next, uint32_t width,
+                       uint32_t x0, uint32_t x1, const ThermalConstants& c) {
+    const float* hu = h - width;
+    const float* hd = h + width;
+    const float* ku = k - width;
+    const float* kd = k + width;
+    float spanMax = 0.0f;
+    for (uint32_t x = x0; x < x1; ++x) {
+        const float center = h[x];
+        // 与gatherCell相同的邻居顺序
+        const float heights[8] = {hu[x - 1], hu[x], hu[x + 1], h[x - 1], h[x + 1],
+                                  hd[x - 1], hd[x], hd[x + 1]};
+        const float shares[8] = {ku[x - 1], ku[x], ku[x + 1], k[x - 1], k[x + 1],
+                                 kd[x - 1], kd[x], kd[x + 1]};
+        float outflow = 0.0f;
+        float inflow = 0.0f;
+        for (int n = 0; n < 8; ++n) {
+            const float drop = center - heights[n];
+            outflow += drop > c.talus ? drop : 0.0f;
+            inflow += -drop > c.talus ? -drop * shares[n] : 0.0f;
+        }
+        const float value = center - k[x] * outflow + inflow;
+        next[x] = value;
+        spanMax = maxSel(std::fabs(value - center), spanMax);
+    }
+    return spanMax;
+}
+
+using CoefficientSpanFn = float (*)(const float*, float*, uint32_t, uint32_t, uint32_t, const ThermalConstants&);
+using GatherSpanFn = float (*)(const float*, const float*, float*, uint32_t, uint32_t, uint32_t,
+                               const ThermalConstants&);
+
+#if MG_SIMD_X86
+
+// ---- AVX2：每次8格，运算顺序与标量单格相同 ----
+
+MG_TARGET_AVX2 inline float horizontalMaxAvx2(__m256 v) {
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, v);
+    float result = 0.0f;
+    for (float lane : lanes) result = maxSel(lane, result);
+    return result;
+}
+
+MG_TARGET_AVX2 float coefficientSpanAvx2(const float* h, float* k, uint32_t width, uint32_t x0,
+                                         uint32_t x1, const ThermalConstants& c) {
+    const float* up = h - width;
+    const float* down = h + width;
+    const __m256 talus = _mm256_set1_ps(c.talus);
+    const __m256 steep = _mm256_set1_ps(c.steepest);
+    const __m256 rate = _mm256_set1_ps(c.rate);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 spanMax = zero;
+    uint32_t x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        const __m256 center = _mm256_loadu_ps(h + x);
+        const float* rows[8] = {up - 1, up, up + 1, h - 1, h + 1, down - 1, down, down + 1};
+        __m256 steepest = zero;
+        __m256 count = zero;
+        for (const float* row : rows) {
+            const __m256 slope = _mm256_sub_ps(center, _mm256_loadu_ps(row + x));
+            steepest = _mm256_max_ps(slope, steepest);
+            count = _mm256_add_ps(count, _mm256_and_ps(_mm256_cmp_ps(slope, talus, _CMP_GT_OQ), one));
+        }
+        const __m256 share = _mm256_div_ps(rate, _mm256_max_ps(count, one));
+        const __m256 active = _mm256_and_ps(_mm256_cmp_ps(count, zero, _CMP_GT_OQ),
+                                            _mm256_cmp_ps(steepest, steep, _CMP_GT_OQ));
+        const __m256 coefficient = _mm256_and_ps(active, share);
+        _mm256_storeu_ps(k + x, coefficient);
+        spanMax = _mm256_max_ps(coefficient, spanMax);
+    }
+    return maxSel(coefficientSpanScalar(h, k, width, x, x1, c), horizontalMaxAvx2(spanMax));
+}
+
+MG_TARGET_AVX2 float gatherSpanAvx2(const float* h, const float* k, float* next, uint32_t width,
+                                    uint32_t x0, uint32_t x1, const ThermalConstants& c) {
+    const float* hu = h - width;
+    const float* hd = h + width;
+    const float* ku = k - width;
+    const float* kd = k + width;
+    const __m256 talus = _mm256_set1_ps(c.talus);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 spanMax = zero;
+    uint32_t x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        const __m256 center = _mm256_loadu_ps(h + x);
+        const float* heights[8] = {hu - 1, hu, hu + 1, h - 1, h + 1, hd - 1, hd, hd + 1};
+        const float* shares[8] = {ku - 1, ku, ku + 1, k - 1, k + 1, kd - 1, kd, kd + 1};
+        __m256 outflow = zero;
+        __m256 inflow = zero;
+        for (int n = 0; n < 8; ++n) {
+            const __m256 drop = _mm256_sub_ps(center, _mm256_loadu_ps(heights[n] + x));
+            const __m256 rise = _mm256_xor_ps(drop, sign);
+            outflow = _mm256_add_ps(outflow, _mm256_and_ps(_mm256_cmp_ps(drop, talus, _CMP_GT_OQ), drop));
+            inflow = _mm256_add_ps(inflow, _mm256_and_ps(_mm256_cmp_ps(rise, talus, _CMP_GT_OQ),
+                                                         _mm256_mul_ps(rise, _mm256_loadu_ps(shares[n] + x))));
+        }
+        const __m256 value = _mm256_add_ps(
+            _mm256_sub_ps(center, _mm256_mul_ps(_mm256_loadu_ps(k + x), outflow)), inflow);
+        _mm256_storeu_ps(next + x, value);
+        spanMax = _mm256_max_ps(_mm256_andnot_ps(sign, _mm256_sub_ps(value, center)), spanMax);
+    }
+    return maxSel(gatherSpanScalar(h, k, next, width, x, x1, c), horizontalMaxAvx2(spanMax));
+}
+
+#endif // MG_SIMD_X86
+
+// 第二遍的单格计算，邻居是否在图内由inside判断；返回变化量的绝对值
+template<typename Inside>
+inline float gatherCell(const float* h, const float* k, float* next, size_t i,
+                        const Neighborhood& nb, const ThermalConstants& c, Inside inside) {
+    const float center = h[i];
+    float outflow = 0.0f;
+    float inflow = 0.0f;
+    for (int n = 0; n < 8; ++n) {
+        if (!inside(n)) continue;
+        const size_t j = static_cast<size_t>(static_cast<ptrdiff_t>(i) + nb.offset[n]);
+        const float drop = center - h[j];
+        outflow += drop > c.talus ? drop : 0.0f;
+        inflow += -drop > c.talus ? -drop * k[j] : 0.0f;
+    }
+    const float value = center - k[i] * outflow + inflow;
+    next[i] = value;
+    return std::fabs(value - center);
+}
+
+// 第二遍：整行，内部格交给gatherSpan，首末行与首末格逐邻居判断边界；返回该行的最大变化
+float gatherRow(const float* h, const float* k, float* next, uint32_t y, uint32_t width,
+                uint32_t height, const Neighborhood& nb, const ThermalConstants& c,
+                GatherSpanFn gatherSpan) {
+    const size_t row = static_cast<size_t>(y) * width;
+    float rowMax = 0.0f;
+    auto clipped = [&](uint32_t x) {
+        size_t i = row + x;
+        rowMax = std::max(rowMax, gatherCell(h, k, next, i, nb, c, [&](int n) {
+            int64_t nx = static_cast<int64_t>(x) + nb.dx[n];
+            int64_t ny = static_cast<int64_t>(y) + nb.dy[n];
+            return nx >= 0 && ny >= 0 && nx < width && ny < height;
+        }));
+    };
+
+    if (y == 0 || y + 1 == height) {
+        for (uint32_t x = 0; x < width; ++x) clipped(x);
+        return rowMax;
+    }
+
+    clipped(0);
+    rowMax = std::max(rowMax, gatherSpan(h + row, k + row, next + row, width, 1, width - 1, c));
+    clipped(width - 1);
+    return rowMax;
+}
+
+// 按行带执行body(startY, endY, band)，processor为空时串行
+template<typename Body>
+void forEachRowBand(ParallelProcessor* processor, uint32_t height, Body&& body) {
+    if (processor) {
+        processor->parallelFor1DChunked(height, kThermalRowsPerTask, [&](uint32_t startY, uint32_t endY) {
+            body(startY, endY, startY / kThermalRowsPerTask);
+        });
+        return;
+    }
+    for (uint32_t startY = 0; startY < height; startY += kThermalRowsPerTask) {
+        body(startY, std::min(startY + kThermalRowsPerTask, height), startY / kThermalRowsPerTask);
+    }
+}
+
+} // namespace
+
+uint32_t applyThermalErosion(HeightMap& heightmap, uint32_t width, uint32_t height,
+                             const ErosionParams& params, ScratchPool& scratch,
+                             ParallelProcessor* processor, bool stopWhenStable,
+                             SimdLevel level) {
+    const size_t count = static_cast<size_t>(width) * height;
+    if (width < 3 || height < 3 || heightmap.size() < count) {
+        return 0;
+    }
+
+    ThermalConstants c;
+    c.steepest = params.talusAngle * static_cast<float>(M_PI / 180.0);
+    c.talus = c.steepest * params.pipeLength;
+    c.rate = params.thermalRate;
+    const Neighborhood nb(width);
+
+    CoefficientSpanFn coefficientSpan = coefficientSpanScalar;
+    GatherSpanFn gatherSpan = gatherSpanScalar;
+#if MG_SIMD_X86
+    if (level == SimdLevel::AVX2 && detectSimdLevel() == SimdLevel::AVX2) {
+        coefficientSpan = coefficientSpanAvx2;
+        gatherSpan = gatherSpanAvx2;
+    }
+#else
+    (void)level;
+#endif
+
+    HeightMap next = scratch.acquireUninitialized<float>(count);
+    std::vector<float> coefficients = scratch.acquireUninitialized<float>(count);
+    const uint32_t bands = (height + kThermalRowsPerTask - 1) / kThermalRowsPerTask;
+    std::vector<float> bandMax(bands);
+
+    uint32_t iterations = 0;
+    for (; iterations < params.iterations; ++iterations) {
+        const float* h = heightmap.data();
+        float* k = coefficients.data();
+
+        // 首末行没有完整的8邻域，系数为0
+        std::fill(k, k + width, 0.0f);
+        std::fill(k + count - width, k + count, 0.0f);
+        forEachRowBand(processor, height, [&](uint32_t startY, uint32_t endY, uint32_t band) {
+            float rowMax = 0.0f;
+            for (uint32_t y = std::max(startY, 1u); y < std::min(endY, height - 1); ++y) {
+                // 首末格没有完整的8邻域，系数为0
+                const size_t row = static_cast<size_t>(y) * width;
+                k[row] = 0.0f;
+                k[row + width - 1] = 0.0f;
+                rowMax = std::max(rowMax, coefficientSpan(h + row, k + row, width, 1, width - 1, c));
+            }
+            bandMax[band] = rowMax;
+        });
+        // 没有超过休止角的格子，地形已稳定
+        if (stopWhenStable && *std::max_element(bandMax.begin(), bandMax.end()) <= 0.0f) {
+            break;
+        }
+
+        forEachRowBand(processor, height, [&](uint32_t startY, uint32_t endY, uint32_t band) {
+            float rowMax = 0.0f;
+            for (uint32_t y = startY; y < endY; ++y) {
+                rowMax = std::max(rowMax, gatherRow(h, k, next.data(), y, width, height, nb, c, gatherSpan));
+            }
+            bandMax[band] = rowMax;
+        });
+        heightmap.swap(next);
+        if (stopWhenStable &&
+            *std::max_element(bandMax.begin(), bandMax.end()) <= params.thermalTolerance) {
+            ++iterations;
+            break;
+        }
+    }
+
+    scratch.release(std::move(next));
+    scratch.release(std::move(coefficients));
+    return iterations;
+}
+
+} // namespace internal
+} // namespace MapGenerator
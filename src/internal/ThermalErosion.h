@@ -0,0 +1,29 @@
+// src/internal/ThermalErosion.h
+#ifndef MAPGENERATOR_INTERNAL_THERMALEROSION_H
+#define MAPGENERATOR_INTERNAL_THERMALEROSION_H
+
+#include "CommonTypes.h"
+#include "NoiseKernels.h"
+#include "ParallelUtils.h"
+#include "ScratchPool.h"
+#include <cstdint>
+
+namespace MapGenerator {
+namespace internal {
+
+// 热侵蚀（按收集方式计算）：高差超过休止角阈值的坡向低处崩落。每轮分两遍：
+// 第一遍按8邻域求每个内部格子的崩落系数（thermalRate / 陡坡邻居数，不陡时为0），
+// 第二遍每个格子只改写自己：减去流向陡坡邻居的量，加上高处邻居按其系数流入的量，写入第二个缓冲区。
+// 每轮的依赖半径为2格，结果与线程数、指令集和格子在世界中的位置无关。
+// processor为空时在调用线程上串行运行。stopWhenStable为真时，没有格子超过休止角
+// 或单轮最大变化不超过params.thermalTolerance就提前结束；分块生成须跑满轮数以保证接缝一致。
+// 返回实际运行的轮数
+uint32_t applyThermalErosion(HeightMap& heightmap, uint32_t width, uint32_t height,
+                             const ErosionParams& params, ScratchPool& scratch,
+                             ParallelProcessor* processor, bool stopWhenStable,
+                             SimdLevel level = detectSimdLevel());
+
+} // namespace internal
+} // namespace MapGenerator
+
+#endif // MAPGENERATOR_INTERNAL_THERMALEROSION_H
@@ -0,0 +1,129 @@
+// tests/golden_presets.cpp
+// 预设的黄金哈希回归测试：每个预设按固定尺寸生成，对高度图和地形图求哈希并与记录值比较；
+// 同时用不同线程数各生成一次，结果必须逐字节一致（结果缓存的键不含线程数，依赖这一点）。
+// 有意修改生成结果时，用 --print 运行并把输出的哈希更新到kGolden中
+#include "MapGenerator.h"
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+using MapGenerator::MapConfig;
+
+constexpr uint32_t kWidth = 200;
+constexpr uint32_t kHeight = 152;
+constexpr uint32_t kThreadCounts[] = {1, 3, 8};
+
+using MapGenerator::ErosionModel;
+using MapGenerator::HydrologyModel;
+
+struct GoldenEntry {
+    MapConfig::Preset preset;
+    const char* name;
+    uint64_t heightHash;
+    uint64_t terrainHash;
+    // 预设都用默认模型，另加两项覆盖其余的水系与侵蚀模型
+    HydrologyModel hydrology = HydrologyModel::TRACED;
+    ErosionModel erosion = ErosionModel::PIPE;
+};
+
+const GoldenEntry kGolden[] = {
+    {MapConfig::Preset::ISLANDS,        "islands",        0xae9e92e1d6e90dbaull, 0x178c9853423e275eull},
+    {MapConfig::Preset::MOUNTAINS,      "mountains",      0xc6b4ff1b42e772d1ull, 0x18e76d8f34f20f81ull},
+    {MapConfig::Preset::PLAINS,         "plains",         0x5512a73f12e3c4b0ull, 0x0521bc5e2e5f7886ull},
+    {MapConfig::Preset::CONTINENT,      "continent",      0x5e15f55067a00603ull, 0x08beda9a083a3085ull},
+    {MapConfig::Preset::ARCHIPELAGO,    "archipelago",    0x90dffec56149d479ull, 0x9d53511dc79c0d57ull},
+    {MapConfig::Preset::SWAMP_LAKES,    "swamp_lakes",    0x694d676465215ab5ull, 0xae6699c732631354ull},
+    {MapConfig::Preset::DESERT_CANYONS, "desert_canyons", 0x1cb506a416d1154dull, 0x48af8ba989974b99ull},
+    {MapConfig::Preset::ALPINE,         "alpine",         0x9654154d61147d60ull, 0xb8ed0e3ed102666cull},
+    {MapConfig::Preset::CONTINENT,      "continent_flow", 0x5e15f55067a00603ull, 0x25855d99813232caull,
+     HydrologyModel::FLOW},
+    {MapConfig::Preset::MOUNTAINS,      "mountains_drop", 0x557e00fa0e4106eeull, 0x109c0d3c594b2d51ull,
+     HydrologyModel::TRACED, ErosionModel::DROPLET},
+};
+
+// FNV-1a 64位
+uint64_t hashBytes(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+struct MapHashes {
+    uint64_t height = 0;
+    uint64_t terrain = 0;
+};
+
+bool generateHashes(const GoldenEntry& entry, uint32_t threadCount, MapHashes& out) {
+    // 每次用新的生成器，避免命中上一次的缓存
+    MapGenerator::MapGenerator generator;
+    MapConfig config = MapGenerator::MapGenerator::createConfigFromPreset(entry.preset);
+    config.width = kWidth;
+    config.height = kHeight;
+    config.threadCount = threadCount;
+    config.hydrology = entry.hydrology;
+    config.erosion = entry.erosion;
+    config.compactTiles = false;
+    config.heightFormat = MapGenerator::HeightFormat::FLOAT32;
+
+    auto map = generator.generateMap(config);
+    const size_t count = static_cast<size_t>(kWidth) * kHeight;
+    if (!map || map->heightMap.size() != count || map->terrainMap.size() != count) {
+        return false;
+    }
+    out.height = hashBytes(map->heightMap.data(), map->heightMap.size() * sizeof(float));
+    out.terrain = hashBytes(map->terrainMap.data(), map->terrainMap.size() * sizeof(uint32_t));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool print = argc > 1 && std::strcmp(argv[1], "--print") == 0;
+    int failures = 0;
+
+    for (const GoldenEntry& entry : kGolden) {
+        MapHashes reference;
+        bool ok = true;
+        for (uint32_t threadCount : kThreadCounts) {
+            MapHashes hashes;
+            if (!generateHashes(entry, threadCount, hashes)) {
+                std::printf("FAIL %s: generation failed with %u threads\n", entry.name, threadCount);
+                ok = false;
+                break;
+            }
+            if (threadCount == kThreadCounts[0]) {
+                reference = hashes;
+            } else if (hashes.height != reference.height || hashes.terrain != reference.terrain) {
+                std::printf("FAIL %s: %u threads differ from %u threads\n",
+                            entry.name, threadCount, kThreadCounts[0]);
+                ok = false;
+            }
+        }
+
+        if (print) {
+            std::printf("%-16s 0x%016" PRIx64 "ull, 0x%016" PRIx64 "ull\n",
+                        entry.name, reference.height, reference.terrain);
+        } else if (ok && (reference.height != entry.heightHash || reference.terrain != entry.terrainHash)) {
+            std::printf("FAIL %s: height 0x%016" PRIx64 " (expected 0x%016" PRIx64 "), "
+                        "terrain 0x%016" PRIx64 " (expected 0x%016" PRIx64 ")\n",
+                        entry.name, reference.height, entry.heightHash,
+                        reference.terrain, entry.terrainHash);
+            ok = false;
+        }
+
+        if (!ok) {
+            ++failures;
+        } else if (!print) {
+            std::printf("ok   %s\n", entry.name);
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+// tests/result_cache.cpp
+// 结果缓存的字节预算回归测试：预算是整个缓存的总额，不超过总预算的地图都能缓存并命中；
+// 超出时按最久未用淘汰，占用不超过预算。中间阶段缓存计入同一预算，批量生成不写入
+#include "MapGenerator.h"
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+using MapGenerator::MapConfig;
+
+int g_failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL %s\n", what);
+        ++g_failures;
+    }
+}
+
+MapConfig testConfig(uint32_t size, uint32_t seed) {
+    MapConfig config = MapGenerator::MapGenerator::createConfigFromPreset(MapConfig::Preset::CONTINENT);
+    config.width = size;
+    config.height = size;
+    config.seed = seed;
+    config.threadCount = 2;
+    config.heightFormat = MapGenerator::HeightFormat::FLOAT32;
+    return config;
+}
+
+// 单张约4.5MB的地图在16MB预算下命中
+void testLargeMapHits() {
+    MapGenerator::MapGenerator generator;
+    generator.setCacheBudget(size_t(16) << 20);
+    MapConfig config = testConfig(768, 7);
+
+    auto first = generator.generateMap(config);
+    auto second = generator.generateMap(config);
+    MapGenerator::MapCacheStats stats = generator.getCacheStats();
+
+    check(first && first == second, "768x768 map under a 16MB budget is returned from the cache");
+    check(stats.entries == 1, "768x768 map under a 16MB budget stays cached");
+    check(stats.hits == 1, "second identical generateMap is a hit");
+    check(stats.bytes <= stats.byteBudget, "cached bytes stay within the budget");
+}
+
+// 预算容纳两张图时生成三张：最早的一张被淘汰，后两张命中
+void testEvictionIsGlobal() {
+    MapGenerator::MapGenerator generator;
+    generator.generateMap(testConfig(256, 1));
+    const size_t mapBytes = generator.getCacheStats().bytes;
+    check(mapBytes > 0, "first map is cached");
+
+    generator.clearCache();
+    generator.setCacheBudget(mapBytes * 5 / 2);
+    for (uint32_t seed = 1; seed <= 3; ++seed) {
+        generator.generateMap(testConfig(256, seed));
+    }
+    MapGenerator::MapCacheStats stats = generator.getCacheStats();
+    check(stats.entries == 2, "budget for two maps keeps two entries");
+    check(stats.evictions >= 1, "third map evicts the least recently used one");
+    check(stats.bytes <= stats.byteBudget, "cached bytes stay within the budget after eviction");
+
+    const uint64_t hits = stats.hits;
+    generator.generateMap(testConfig(256, 2));
+    generator.generateMap(testConfig(256, 3));
+    check(generator.getCacheStats().hits == hits + 2, "two most recent maps are hits");
+
+    // 缩小预算立即生效
+    generator.setCacheBudget(mapBytes * 3 / 2);
+    stats = generator.getCacheStats();
+    check(stats.entries == 1 && stats.bytes <= stats.byteBudget, "shrinking the budget evicts across shards");
+}
+
+// 阶段缓存计入统计，地图与阶段合计不超过预算；缩小预算时阶段缓存一并淘汰
+void testStageCacheBudget() {
+    MapGenerator::MapGenerator generator;
+    generator.generateMap(testConfig(256, 1));
+    MapGenerator::MapCacheStats stats = generator.getCacheStats();
+    check(stats.stageEntries == 2, "relief and terrain stages are cached");
+    check(stats.stageBytes > 0, "stage bytes are reported");
+    check(stats.bytes + stats.stageBytes <= stats.byteBudget, "maps and stages share the budget");
+
+    // 预算只够缓存地图时不保留中间阶段
+    generator.setCacheBudget(stats.bytes);
+    stats = generator.getCacheStats();
+    check(stats.entries == 1, "map stays cached when the budget only fits the map");
+    check(stats.stageEntries == 0 && stats.stageBytes == 0, "stages are trimmed to the remaining budget");
+
+    MapConfig config = testConfig(256, 2);
+    generator.generateMap(config);
+    stats = generator.getCacheStats();
+    check(stats.bytes + stats.stageBytes <= stats.byteBudget, "stages never exceed the remaining budget");
+}
+
+// 批量地图种子各不相同，不写入阶段缓存
+void testBatchSkipsStages() {
+    MapGenerator::MapGenerator generator;
+    auto maps = generator.generateBatch(testConfig(128, 1), 3);
+    MapGenerator::MapCacheStats stats = generator.getCacheStats();
+    check(maps.size() == 3 && maps[2], "batch generates every map");
+    check(stats.entries == 3, "batch maps are cached as results");
+    check(stats.stageEntries == 0 && stats.stageBytes == 0, "batch maps are not staged");
+}
+
+} // namespace
+
+int main() {
+    testLargeMapHits();
+    testEvictionIsGlobal();
+    testStageCacheBudget();
+    testBatchSkipsStages();
+    if (g_failures == 0) {
+        std::printf("ok   result_cache\n");
+    }
+    return g_failures == 0 ? 0 : 1;
+}
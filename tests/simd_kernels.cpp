@@ -0,0 +1,219 @@
+// tests/simd_kernels.cpp
+// SIMD内核回归测试：柏林噪声、高度编解码、管道与热侵蚀、盒式与高斯平滑的SSE4.1/AVX2版本
+// 必须与标量版本逐位一致（结果缓存与黄金哈希都不区分指令集）。
+// 输入覆盖向量宽度的余数、3x3的最小地图以及NaN/Inf等编码边界值；
+// CPU不支持的级别会退回到可用的最高级别，照常比较
+#include "HeightCodec.h"
+#include "NoiseKernels.h"
+#include "ParallelUtils.h"
+#include "PipeErosion.h"
+#include "ScratchPool.h"
+#include "Smoothing.h"
+#include "ThermalErosion.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+using namespace MapGenerator;
+using namespace MapGenerator::internal;
+
+const SimdLevel kVectorLevels[] = {SimdLevel::SSE41, SimdLevel::AVX2};
+
+// 地图尺寸：最小的3x3、不足一个向量宽度、带余数和整数倍的宽度
+struct MapSize {
+    uint32_t width;
+    uint32_t height;
+};
+const MapSize kMapSizes[] = {{3, 3}, {5, 4}, {37, 29}, {64, 48}};
+
+int g_failures = 0;
+
+void check(bool condition, const char* what, SimdLevel level) {
+    if (!condition) {
+        std::printf("FAIL %s (%s)\n", what, simdLevelName(level));
+        ++g_failures;
+    }
+}
+
+template<typename T>
+bool sameBits(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+// 固定种子的线性同余序列，结果与平台无关
+struct Lcg {
+    uint32_t state;
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state;
+    }
+    float unit() { return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f); }
+};
+
+std::vector<int> permutationTable(uint32_t seed) {
+    std::vector<int> perm(512);
+    for (int i = 0; i < 256; ++i) perm[i] = i;
+    Lcg rng{seed};
+    for (int i = 255; i > 0; --i) {
+        int j = static_cast<int>(rng.next() % static_cast<uint32_t>(i + 1));
+        std::swap(perm[i], perm[j]);
+    }
+    for (int i = 0; i < 256; ++i) perm[256 + i] = perm[i];
+    return perm;
+}
+
+HeightMap randomHeights(const MapSize& size, uint32_t seed) {
+    HeightMap heights(static_cast<size_t>(size.width) * size.height);
+    Lcg rng{seed};
+    for (float& h : heights) h = rng.unit();
+    return heights;
+}
+
+void testPerlin() {
+    const std::vector<int> perm = permutationTable(12345);
+    // 含负坐标、整数格点和较大的坐标；长度不是向量宽度的整数倍
+    const size_t n = 1037;
+    std::vector<float> xs(n), ys(n);
+    Lcg rng{99};
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] = (rng.unit() - 0.5f) * 512.0f;
+        ys[i] = (i % 17 == 0) ? std::floor(xs[i]) : (rng.unit() - 0.5f) * 4096.0f;
+    }
+
+    std::vector<float> scalar3D(n), scalar2D(n);
+    perlinNoiseBatch(SimdLevel::SCALAR, perm.data(), xs.data(), ys.data(), 0.37f, scalar3D.data(), n);
+    perlinNoise2DBatch(SimdLevel::SCALAR, perm.data(), xs.data(), ys.data(), 3, scalar2D.data(), n);
+    for (SimdLevel level : kVectorLevels) {
+        std::vector<float> out(n);
+        perlinNoiseBatch(level, perm.data(), xs.data(), ys.data(), 0.37f, out.data(), n);
+        check(sameBits(out, scalar3D), "perlin 3D matches scalar", level);
+        perlinNoise2DBatch(level, perm.data(), xs.data(), ys.data(), 3, out.data(), n);
+        check(sameBits(out, scalar2D), "perlin 2D matches scalar", level);
+    }
+}
+
+void testHeightCodec() {
+    const float inf = std::numeric_limits<float>::infinity();
+    std::vector<float> values = {
+        std::numeric_limits<float>::quiet_NaN(), -std::numeric_limits<float>::quiet_NaN(),
+        inf, -inf, 0.0f, -0.0f, 1.0f, -1.0f, 1.5f, 0.5f,
+        std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::min(),
+        6.1e-5f, 5.96e-8f, 2.98e-8f, 65504.0f, 65519.0f, 65520.0f, 1e10f, -1e10f,
+    };
+    Lcg rng{7};
+    while (values.size() < 1003) {
+        values.push_back(rng.unit() * 1.2f - 0.1f);
+    }
+    const size_t n = values.size();
+
+    // 全部65536个半精度编码，含NaN和Inf
+    std::vector<uint16_t> codes(65536);
+    for (size_t i = 0; i < codes.size(); ++i) codes[i] = static_cast<uint16_t>(i);
+
+    for (HeightFormat format : {HeightFormat::UNORM16, HeightFormat::HALF16}) {
+        std::vector<uint16_t> scalarEncoded(n);
+        std::vector<float> scalarDecoded(codes.size());
+        encodeHeights(SimdLevel::SCALAR, format, values.data(), scalarEncoded.data(), n);
+        decodeHeights(SimdLevel::SCALAR, format, codes.data(), scalarDecoded.data(), codes.size());
+        for (SimdLevel level : kVectorLevels) {
+            std::vector<uint16_t> encoded(n);
+            std::vector<float> decoded(codes.size());
+            encodeHeights(level, format, values.data(), encoded.data(), n);
+            decodeHeights(level, format, codes.data(), decoded.data(), codes.size());
+            check(sameBits(encoded, scalarEncoded),
+                  format == HeightFormat::UNORM16 ? "unorm16 encode matches scalar"
+                                                  : "half16 encode matches scalar", level);
+            check(sameBits(decoded, scalarDecoded),
+                  format == HeightFormat::UNORM16 ? "unorm16 decode matches scalar"
+                                                  : "half16 decode matches scalar", level);
+        }
+    }
+}
+
+void testPipeErosion(ParallelProcessor& processor, ScratchPool& scratch) {
+    ErosionParams params;
+    params.pipeIterations = 12;
+    params.sedimentCapacity = 2.0f;
+    for (const MapSize& size : kMapSizes) {
+        HeightMap scalar = randomHeights(size, size.width * 31 + size.height);
+        const HeightMap input = scalar;
+        bool ran = applyPipeErosion(scalar, size.width, size.height, params, processor, scratch,
+                                    SimdLevel::SCALAR);
+        check(ran && !sameBits(scalar, input), "pipe erosion changes the scalar map", SimdLevel::SCALAR);
+        for (SimdLevel level : kVectorLevels) {
+            HeightMap out = input;
+            applyPipeErosion(out, size.width, size.height, params, processor, scratch, level);
+            check(sameBits(out, scalar), "pipe erosion matches scalar", level);
+        }
+    }
+}
+
+void testThermalErosion(ParallelProcessor& processor, ScratchPool& scratch) {
+    ErosionParams params;
+    params.iterations = 8;
+    params.talusAngle = 5.0f;
+    params.thermalRate = 0.3f;
+    for (const MapSize& size : kMapSizes) {
+        HeightMap scalar = randomHeights(size, size.width * 17 + size.height);
+        const HeightMap input = scalar;
+        applyThermalErosion(scalar, size.width, size.height, params, scratch, &processor, false,
+                            SimdLevel::SCALAR);
+        check(!sameBits(scalar, input), "thermal erosion changes the scalar map", SimdLevel::SCALAR);
+        for (SimdLevel level : kVectorLevels) {
+            HeightMap out = input;
+            applyThermalErosion(out, size.width, size.height, params, scratch, &processor, false, level);
+            check(sameBits(out, scalar), "thermal erosion matches scalar", level);
+        }
+    }
+}
+
+void testBlur(ParallelProcessor& processor, ScratchPool& scratch) {
+    // 半径覆盖逐格求和与滑动和两种路径
+    const uint32_t radii[] = {1, 2, 3, 7};
+    const float sigmas[] = {0.8f, 2.5f};
+    for (const MapSize& size : kMapSizes) {
+        const HeightMap input = randomHeights(size, size.width * 13 + size.height);
+        for (uint32_t radius : radii) {
+            HeightMap scalar = input;
+            applyBoxBlur(scalar, size.width, size.height, radius, scratch, processor, SimdLevel::SCALAR);
+            for (SimdLevel level : kVectorLevels) {
+                HeightMap out = input;
+                applyBoxBlur(out, size.width, size.height, radius, scratch, processor, level);
+                check(sameBits(out, scalar), "box blur matches scalar", level);
+            }
+        }
+        for (float sigma : sigmas) {
+            HeightMap scalar = input;
+            applyGaussianBlur(scalar, size.width, size.height, sigma, scratch, processor, SimdLevel::SCALAR);
+            for (SimdLevel level : kVectorLevels) {
+                HeightMap out = input;
+                applyGaussianBlur(out, size.width, size.height, sigma, scratch, processor, level);
+                check(sameBits(out, scalar), "gaussian blur matches scalar", level);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::printf("cpu  %s\n", simdLevelName(detectSimdLevel()));
+    ParallelProcessor processor(2);
+    ScratchPool scratch;
+
+    testPerlin();
+    testHeightCodec();
+    testPipeErosion(processor, scratch);
+    testThermalErosion(processor, scratch);
+    testBlur(processor, scratch);
+
+    if (g_failures == 0) {
+        std::printf("ok   simd_kernels\n");
+    }
+    return g_failures == 0 ? 0 : 1;
+}